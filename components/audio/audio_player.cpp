@@ -0,0 +1,655 @@
+/**
+ * @file audio_player.cpp
+ * @brief Buffered I2S playback implementation
+ */
+
+#include "audio_player.h"
+#include <cstring>
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "AUDIO";
+
+namespace Audio {
+
+static uint32_t millis() {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+AudioPlayer::AudioPlayer()
+    : m_config{}
+    , m_frame_bytes(0)
+    , m_fade_frames(0)
+    , m_storage(nullptr)
+    , m_storage_in_psram(false)
+    , m_task(nullptr)
+    , m_last_write_ms(0)
+    , m_legacy_seq(0)
+    , m_legacy_timestamp(0)
+    , m_rejected(0)
+    , m_clips_rejected(0)
+    , m_tones_rejected(0)
+    , m_fade_pending(true)
+    , m_below_low_water(false)
+    , m_last_frame{}
+    , m_play(m_packet)
+    , m_play_concealed(false)
+    , m_packet_len(0)
+    , m_packet_pos(0)
+    , m_in_rate(0)
+    , m_in_channels(0)
+    , m_in_frame_bytes(0)
+    , m_in_fade_frames(0)
+    , m_overlap_frames(0)
+    , m_last_pop_us(0)
+    , m_packet{}
+    , m_decoded{}
+    , m_overlap{}
+    , m_chunk{}
+    , m_low_water_dips(0)
+    , m_bytes_played(0)
+    , m_bytes_concealed(0)
+    , m_frames_decoded(0)
+    , m_decode_cycles(0)
+    , m_frames_resampled(0)
+    , m_resample_cycles(0)
+    , m_clip_active(false)
+    , m_clip{}
+    , m_clip_frame(0)
+    , m_clip_block_pos(0)
+    , m_clip_block_frames(0)
+    , m_clip_block{}
+    , m_clips_played(0)
+    , m_tone_ducks(false)
+    , m_volume_heard(0)
+    , m_tone_block{}
+    , m_tones_played(0)
+    , m_frames_mixed(0)
+    , m_mix_cycles(0) {
+}
+
+AudioPlayer::~AudioPlayer() {
+    stop();
+    if (m_storage) {
+        heap_caps_free(m_storage);
+    }
+}
+
+bool AudioPlayer::init(const Config& config) {
+    if (config.channels == 0 || config.channels > MAX_CHANNELS) {
+        ESP_LOGE(TAG, "Unsupported channel count %u", (unsigned)config.channels);
+        return false;
+    }
+    
+    m_config = config;
+    m_frame_bytes = config.channels * sizeof(int16_t);
+    m_fade_frames = (size_t)config.sample_rate * config.fade_ms / 1000;
+    
+    Mixer::Config mixer_config = config.mixer;
+    mixer_config.sample_rate = config.sample_rate;
+    mixer_config.channels = config.channels;
+    if (!m_mixer.configure(mixer_config)) {
+        ESP_LOGE(TAG, "Invalid mixer configuration");
+        return false;
+    }
+    m_volume_heard = m_mixer.getVolume();
+    
+    m_drift.configure(config.drift);
+    setInputFormat(config.sample_rate, config.channels);
+    
+    // Large and not touched by DMA (the I2S driver copies), so prefer PSRAM
+    size_t size = JitterBuffer::storageSize();
+    m_storage = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    m_storage_in_psram = m_storage != nullptr;
+    if (!m_storage) {
+        m_storage = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    
+    JitterBuffer::Config jitter_config = {
+        .min_depth_ms = config.prebuffer_ms,
+        .max_depth_ms = config.max_depth_ms,
+        .jitter_multiplier = config.jitter_multiplier,
+        .trim_margin = 2
+    };
+    if (!m_storage || !m_jitter.attach(m_storage, jitter_config)) {
+        ESP_LOGE(TAG, "Failed to allocate %zu byte jitter buffer", size);
+        return false;
+    }
+    
+    ESP_LOGI(TAG, "Jitter buffer %zu bytes in %s, depth %lu-%lu ms",
+             size, m_storage_in_psram ? "PSRAM" : "internal RAM",
+             (unsigned long)config.prebuffer_ms, (unsigned long)config.max_depth_ms);
+    if (config.drift.max_ppm > 0) {
+        ESP_LOGI(TAG, "Drift trim up to %ld ppm, time constant %lu s",
+                 (long)config.drift.max_ppm, (unsigned long)config.drift.time_constant_s);
+    }
+    return true;
+}
+
+bool AudioPlayer::start() {
+    if (m_task) {
+        return true;
+    }
+    
+    BaseType_t ok = xTaskCreatePinnedToCore(&AudioPlayer::taskEntry, m_config.task_name,
+                                            m_config.task_stack_size, this,
+                                            m_config.task_priority, &m_task,
+                                            m_config.task_core);
+    if (ok != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create playback task");
+        m_task = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void AudioPlayer::stop() {
+    if (m_task) {
+        vTaskDelete(m_task);
+        m_task = nullptr;
+    }
+    
+    // Both ends are idle now: the task is gone and stop() runs on the producer
+    if (m_storage) {
+        JitterBuffer::Config jitter_config = {
+            .min_depth_ms = m_config.prebuffer_ms,
+            .max_depth_ms = m_config.max_depth_ms,
+            .jitter_multiplier = m_config.jitter_multiplier,
+            .trim_margin = 2
+        };
+        m_jitter.attach(m_storage, jitter_config);
+    }
+    m_packet_len = 0;
+    m_packet_pos = 0;
+    m_fade_pending = true;
+    m_overlap_frames = 0;
+    m_resampler.reset();
+    m_drift.restart();
+    m_last_pop_us = 0;
+    
+    EarconClip clip;
+    while (m_clip_requests.pop(clip)) {
+    }
+    m_clip_active = false;
+    
+    ToneRequest tone;
+    while (m_tone_requests.pop(tone)) {
+    }
+    m_tone.stop();
+}
+
+bool AudioPlayer::write(const uint8_t* data, size_t length) {
+    PacketInfo packet;
+    if (parsePacket(data, length, packet)) {
+        if (!supports(packet.codec) ||
+            (packet.channels != 1 && packet.channels != m_config.channels) ||
+            packet.sample_rate < MIN_INPUT_RATE ||
+            packet.sample_rate > m_config.sample_rate * Resampler::MAX_RATIO) {
+            m_rejected++;
+            return false;
+        }
+    } else {
+        // Headerless PCM from an older server: number it in arrival order
+        packet.seq = m_legacy_seq++;
+        packet.timestamp = m_legacy_timestamp;
+        packet.codec = Codec::PCM16;
+        packet.channels = m_config.channels;
+        packet.sample_rate = m_config.sample_rate;
+        packet.payload = data;
+        packet.payload_len = length;
+        m_legacy_timestamp += length / m_frame_bytes;
+    }
+    
+    // Whole frames only, so concealment and fades stay aligned
+    if (packet.codec == Codec::PCM16) {
+        packet.payload_len -= packet.payload_len % (packet.channels * sizeof(int16_t));
+    }
+    
+    if (!m_jitter.push(packet, esp_timer_get_time())) {
+        return false;
+    }
+    m_last_write_ms.store(millis(), std::memory_order_relaxed);
+    
+    if (!m_jitter.isPlaying() && m_task) {
+        xTaskNotifyGive(m_task);
+    }
+    return true;
+}
+
+bool AudioPlayer::playClip(const EarconClip& clip) {
+    if (!supports(clip.codec) || clip.sample_rate != m_config.sample_rate ||
+        clip.channels == 0 || clip.channels > MAX_CHANNELS || clip.frames == 0 ||
+        !m_clip_requests.push(clip)) {
+        m_clips_rejected++;
+        return false;
+    }
+    if (m_task) {
+        xTaskNotifyGive(m_task);
+    }
+    return true;
+}
+
+bool AudioPlayer::playTone(uint16_t frequency_hz, uint16_t duration_ms) {
+    if (frequency_hz == 0 || (uint32_t)frequency_hz * 2 >= m_config.sample_rate || duration_ms == 0 ||
+        !m_tone_requests.push({frequency_hz, duration_ms})) {
+        m_tones_rejected++;
+        return false;
+    }
+    if (m_task) {
+        xTaskNotifyGive(m_task);
+    }
+    return true;
+}
+
+uint8_t AudioPlayer::setVolume(int step) {
+    uint8_t volume = m_mixer.setVolume(step);
+    wakeForVolume();
+    return volume;
+}
+
+uint8_t AudioPlayer::stepVolume(int delta) {
+    uint8_t volume = m_mixer.stepVolume(delta);
+    wakeForVolume();
+    return volume;
+}
+
+void AudioPlayer::wakeForVolume() {
+    if (m_task) {
+        // Wake an idle task so it plays the tick
+        xTaskNotifyGive(m_task);
+    }
+}
+
+AudioPlayer::Stats AudioPlayer::getStats() const {
+    Stats stats;
+    stats.jitter = m_jitter.getStats();
+    stats.rejected = m_rejected;
+    stats.low_water_dips = m_low_water_dips;
+    stats.bytes_played = m_bytes_played;
+    stats.bytes_concealed = m_bytes_concealed;
+    stats.frames_decoded = m_frames_decoded;
+    stats.decode_cycles = m_decode_cycles;
+    stats.input_rate = m_in_rate;
+    stats.drift_ppm = m_drift.getPpm();
+    stats.drift_error_us = m_drift.getFilteredErrorUs();
+    stats.frames_resampled = m_frames_resampled;
+    stats.resample_cycles = m_resample_cycles;
+    stats.clips_played = m_clips_played;
+    stats.clips_rejected = m_clips_rejected;
+    stats.tones_played = m_tones_played;
+    stats.tones_rejected = m_tones_rejected;
+    stats.frames_mixed = m_frames_mixed;
+    stats.mix_cycles = m_mix_cycles;
+    return stats;
+}
+
+void AudioPlayer::taskEntry(void* arg) {
+    static_cast<AudioPlayer*>(arg)->task();
+}
+
+void AudioPlayer::task() {
+    int16_t* chunk = reinterpret_cast<int16_t*>(m_chunk);
+    size_t chunk_frames = CHUNK_BYTES / m_frame_bytes;
+    
+    while (true) {
+        size_t used = 0;
+        bool live = true;
+        while (used < CHUNK_BYTES) {
+            if (m_packet_pos < m_packet_len) {
+                // Converted to the output format on the way in; the input
+                // left over when the chunk fills is offered again next time
+                size_t consumed = 0;
+                uint32_t start = esp_cpu_get_cycle_count();
+                size_t frames = m_resampler.process(reinterpret_cast<const int16_t*>(m_play + m_packet_pos),
+                                                    (m_packet_len - m_packet_pos) / m_in_frame_bytes, consumed,
+                                                    chunk + used / sizeof(int16_t),
+                                                    (CHUNK_BYTES - used) / m_frame_bytes);
+                m_resample_cycles += esp_cpu_get_cycle_count() - start;
+                m_frames_resampled += frames;
+                m_packet_pos += consumed * m_in_frame_bytes;
+                used += frames * m_frame_bytes;
+                if (m_play_concealed) {
+                    m_bytes_concealed += frames * m_frame_bytes;
+                } else {
+                    m_bytes_played += frames * m_frame_bytes;
+                }
+                continue;
+            }
+            
+            if (nextPacket()) {
+                continue;
+            }
+            
+            if (used == 0) {
+                bool clip = clipPlaying();
+                bool tone = tonePlaying();
+                if (clip || tone) {
+                    // Nothing live: clips and tones play over silence
+                    memset(m_chunk, 0, CHUNK_BYTES);
+                    used = CHUNK_BYTES;
+                    live = false;
+                    break;
+                }
+                // Idle: the DMA auto-clears to silence while we wait
+                waitForData();
+                continue;
+            }
+            
+            // Ran dry mid-chunk: ramp the last output frame down to silence and pad
+            int16_t* out = chunk + used / sizeof(int16_t);
+            size_t faded = fadeOut(out - m_config.channels, out, (CHUNK_BYTES - used) / m_frame_bytes,
+                                   m_config.channels, m_fade_frames);
+            size_t filled = used + faded * m_frame_bytes;
+            memset(m_chunk + filled, 0, CHUNK_BYTES - filled);
+            m_bytes_concealed += CHUNK_BYTES - used;
+            used = CHUNK_BYTES;
+        }
+        
+        // Stream gain and ducking, then the overlays on top
+        bool clip = clipPlaying();
+        bool tone = tonePlaying();
+        uint32_t start = esp_cpu_get_cycle_count();
+        m_mixer.beginChunk(chunk_frames, clip || (tone && m_tone_ducks));
+        if (live) {
+            m_mixer.scale(Mixer::Source::STREAM, chunk);
+        }
+        if (clip) {
+            mixClip(chunk, chunk_frames);
+        }
+        if (tone) {
+            mixTone(chunk, chunk_frames);
+        }
+        m_mix_cycles += esp_cpu_get_cycle_count() - start;
+        m_frames_mixed += chunk_frames;
+        
+        // Blocks until the DMA queue has room; this paces the task
+        size_t bytes_written = 0;
+        esp_err_t ret = i2s_write(m_config.port, m_chunk, CHUNK_BYTES, &bytes_written, portMAX_DELAY);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "I2S write failed: %s", esp_err_to_name(ret));
+        }
+    }
+}
+
+bool AudioPlayer::supports(Codec codec) {
+    for (Codec supported : CODECS) {
+        if (codec == supported) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AudioPlayer::nextPacket() {
+    bool flush = millis() - m_last_write_ms.load(std::memory_order_relaxed) >= m_config.flush_timeout_ms;
+    PacketInfo packet;
+    
+    JitterBuffer::PopResult result = m_jitter.pop(m_packet, packet, flush);
+    switch (result) {
+        case JitterBuffer::PopResult::PACKET:
+        case JitterBuffer::PopResult::TRIM: {
+            if (packet.sample_rate != m_in_rate || packet.channels != m_in_channels) {
+                setInputFormat(packet.sample_rate, packet.channels);
+            }
+            bool surplus = result == JitterBuffer::PopResult::TRIM;
+            if (!surplus) {
+                // The packet after a surplus one is popped at the same time
+                trimForDrift();
+            }
+            
+            size_t length = packet.payload_len;
+            m_play = m_packet;
+            if (packet.codec == Codec::IMA_ADPCM) {
+                uint32_t start = esp_cpu_get_cycle_count();
+                size_t frames = ImaAdpcm::decode(m_packet, length, m_in_channels, m_decoded);
+                m_decode_cycles += esp_cpu_get_cycle_count() - start;
+                m_frames_decoded += frames;
+                m_play = reinterpret_cast<uint8_t*>(m_decoded);
+                length = frames * m_in_frame_bytes;
+            }
+            if (length < m_in_frame_bytes) {
+                return true;
+            }
+            
+            int16_t* samples = reinterpret_cast<int16_t*>(m_play);
+            size_t frames = length / m_in_frame_bytes;
+            if (m_fade_pending) {
+                fadeIn(samples, frames, m_in_channels, m_in_fade_frames);
+                m_fade_pending = false;
+            }
+            if (surplus) {
+                // Only its start plays, as the start of a crossfade into
+                // the next packet; that one is already buffered
+                m_overlap_frames = frames < m_in_fade_frames ? frames : m_in_fade_frames;
+                if (m_overlap_frames > MAX_OVERLAP_FRAMES) {
+                    m_overlap_frames = MAX_OVERLAP_FRAMES;
+                }
+                memcpy(m_overlap, samples, m_overlap_frames * m_in_frame_bytes);
+                m_packet_len = 0;
+                m_packet_pos = 0;
+                return true;
+            }
+            if (m_overlap_frames > 0) {
+                crossfade(samples, frames, m_in_channels);
+            }
+            memcpy(m_last_frame, m_play + length - m_in_frame_bytes, m_in_frame_bytes);
+            m_play_concealed = false;
+            m_packet_len = length;
+            m_packet_pos = 0;
+            
+            uint64_t depth_us = (uint64_t)m_jitter.depth() * m_jitter.packetUs();
+            bool below = depth_us < (uint64_t)m_config.low_water_ms * 1000;
+            if (below && !m_below_low_water) {
+                m_low_water_dips++;
+            }
+            m_below_low_water = below;
+            return true;
+        }
+        
+        case JitterBuffer::PopResult::LOST: {
+            // Conceal one packet's worth: ramp the last frame to silence
+            m_overlap_frames = 0;
+            size_t frames = (size_t)((uint64_t)m_jitter.packetUs() * m_in_rate / 1000000);
+            if (frames * m_in_frame_bytes > sizeof(m_packet)) {
+                frames = sizeof(m_packet) / m_in_frame_bytes;
+            }
+            int16_t* samples = reinterpret_cast<int16_t*>(m_packet);
+            size_t faded = fadeOut(m_last_frame, samples, frames, m_in_channels, m_in_fade_frames);
+            memset(m_packet + faded * m_in_frame_bytes, 0, (frames - faded) * m_in_frame_bytes);
+            m_play = m_packet;
+            m_play_concealed = true;
+            m_packet_len = frames * m_in_frame_bytes;
+            m_packet_pos = 0;
+            m_fade_pending = true;
+            return m_packet_len > 0;
+        }
+        
+        case JitterBuffer::PopResult::UNDERRUN:
+            // The resampler's history was faded out with the chunk
+            m_fade_pending = true;
+            m_overlap_frames = 0;
+            m_resampler.reset();
+            m_drift.restart();
+            m_last_pop_us = 0;
+            return false;
+        
+        case JitterBuffer::PopResult::BUFFERING:
+        default:
+            return false;
+    }
+}
+
+void AudioPlayer::setInputFormat(uint32_t sample_rate, uint8_t channels) {
+    // write() only queues formats the resampler takes
+    m_resampler.configure(sample_rate, m_config.sample_rate, channels, m_config.channels);
+    m_resampler.setTrimPpm(m_drift.getPpm());
+    m_in_rate = sample_rate;
+    m_in_channels = channels;
+    m_in_frame_bytes = channels * sizeof(int16_t);
+    m_in_fade_frames = (size_t)sample_rate * m_config.fade_ms / 1000;
+    memset(m_last_frame, 0, sizeof(m_last_frame));
+    m_overlap_frames = 0;
+    ESP_LOGI(TAG, "Stream format %lu Hz, %u ch", (unsigned long)sample_rate, (unsigned)channels);
+}
+
+void AudioPlayer::trimForDrift() {
+    // Measured at each pop, where the depth steps by exactly one packet; the
+    // one just taken still counts as buffered until it has played
+    uint32_t packet_us = m_jitter.packetUs();
+    int64_t now = esp_timer_get_time();
+    uint32_t interval_us = m_last_pop_us != 0 ? (uint32_t)(now - m_last_pop_us) : packet_us;
+    m_last_pop_us = now;
+    
+    int32_t excess = (int32_t)m_jitter.depth() + 1 - (int32_t)m_jitter.target();
+    m_resampler.setTrimPpm(m_drift.update(excess * (int32_t)packet_us, interval_us));
+}
+
+bool AudioPlayer::clipPlaying() {
+    // The newest request wins
+    EarconClip clip;
+    bool started = false;
+    while (m_clip_requests.pop(clip)) {
+        m_clip = clip;
+        started = true;
+    }
+    if (started) {
+        m_clip_active = true;
+        m_clip_frame = 0;
+        m_clip_block_pos = 0;
+        m_clip_block_frames = 0;
+        m_clips_played++;
+    }
+    return m_clip_active;
+}
+
+bool AudioPlayer::tonePlaying() {
+    // The newest request wins; a volume change ticks at the new level
+    bool started = false;
+    ToneRequest request;
+    while (m_tone_requests.pop(request)) {
+        started = m_tone.start(request.frequency_hz, request.duration_ms, m_config.sample_rate);
+        m_tone_ducks = true;
+    }
+    uint8_t volume = m_mixer.getVolume();
+    if (volume != m_volume_heard) {
+        m_volume_heard = volume;
+        if (m_config.volume_tick_hz > 0) {
+            // Heard against the stream as it is, so no ducking
+            started = m_tone.start(m_config.volume_tick_hz, m_config.volume_tick_ms, m_config.sample_rate);
+            m_tone_ducks = false;
+        }
+    }
+    if (started) {
+        m_tones_played++;
+    }
+    return m_tone.isActive();
+}
+
+void AudioPlayer::mixTone(int16_t* chunk, size_t frames) {
+    size_t rendered = m_tone.render(m_tone_block, frames);
+    m_mixer.add(Mixer::Source::TONE, chunk, 0, m_tone_block, rendered, 1);
+}
+
+void AudioPlayer::mixClip(int16_t* chunk, size_t frames) {
+    uint8_t clip_channels = m_clip.channels;
+    size_t offset = 0;
+    
+    while (offset < frames && m_clip_active) {
+        const int16_t* source;
+        size_t available;
+        if (m_clip.codec == Codec::IMA_ADPCM) {
+            if (m_clip_block_pos >= m_clip_block_frames) {
+                // Full blocks are all the same size, so block n starts at n * that
+                uint32_t block = m_clip_frame / m_clip.block_frames;
+                size_t block_offset = (size_t)block * ImaAdpcm::encodedSize(m_clip.block_frames, clip_channels);
+                uint32_t start = esp_cpu_get_cycle_count();
+                size_t decoded = ImaAdpcm::decode(m_clip.data + block_offset, EarconIndex::blockBytes(m_clip, block),
+                                                  clip_channels, m_clip_block);
+                m_decode_cycles += esp_cpu_get_cycle_count() - start;
+                m_frames_decoded += decoded;
+                m_clip_block_frames = decoded;
+                m_clip_block_pos = 0;
+                if (decoded == 0) {
+                    m_clip_active = false;
+                    break;
+                }
+            }
+            source = m_clip_block + m_clip_block_pos * clip_channels;
+            available = m_clip_block_frames - m_clip_block_pos;
+        } else {
+            // PCM16 is mixed straight from the mapped flash
+            source = reinterpret_cast<const int16_t*>(m_clip.data) + (size_t)m_clip_frame * clip_channels;
+            available = m_clip.frames - m_clip_frame;
+        }
+        
+        size_t count = available < frames - offset ? available : frames - offset;
+        if (count > m_clip.frames - m_clip_frame) {
+            count = m_clip.frames - m_clip_frame;
+        }
+        m_mixer.add(Mixer::Source::EARCON, chunk, offset, source, count, clip_channels);
+        
+        offset += count;
+        m_clip_frame += (uint32_t)count;
+        m_clip_block_pos += count;
+        if (m_clip_frame >= m_clip.frames) {
+            m_clip_active = false;
+        }
+    }
+}
+
+void AudioPlayer::waitForData() {
+    if (m_jitter.depth() == 0) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        return;
+    }
+    
+    // Below target: wake on the next packet, or once the stream has been
+    // quiet long enough to play the tail
+    uint32_t idle = millis() - m_last_write_ms.load(std::memory_order_relaxed);
+    uint32_t wait_ms = idle < m_config.flush_timeout_ms ? m_config.flush_timeout_ms - idle : 0;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms) + 1);
+}
+
+void AudioPlayer::fadeIn(int16_t* samples, size_t frames, uint8_t channels, size_t fade_frames) {
+    size_t ramp = frames < fade_frames ? frames : fade_frames;
+    for (size_t i = 0; i < ramp; i++) {
+        for (size_t c = 0; c < channels; c++) {
+            int16_t& sample = samples[i * channels + c];
+            sample = (int16_t)((int32_t)sample * (int32_t)(i + 1) / (int32_t)ramp);
+        }
+    }
+}
+
+void AudioPlayer::crossfade(int16_t* samples, size_t frames, uint8_t channels) {
+    // Linear from the surplus packet's start to this packet, over the same
+    // span, so the output skips one packet without a step
+    size_t ramp = frames < m_overlap_frames ? frames : m_overlap_frames;
+    for (size_t i = 0; i < ramp; i++) {
+        for (size_t c = 0; c < channels; c++) {
+            int16_t& sample = samples[i * channels + c];
+            int32_t from = m_overlap[i * channels + c];
+            sample = (int16_t)((from * (int32_t)(ramp - i) + (int32_t)sample * (int32_t)i) / (int32_t)ramp);
+        }
+    }
+    m_overlap_frames = 0;
+}
+
+size_t AudioPlayer::fadeOut(int16_t* from, int16_t* samples, size_t frames, uint8_t channels, size_t fade_frames) {
+    int16_t last[MAX_CHANNELS];
+    memcpy(last, from, channels * sizeof(int16_t));
+    size_t ramp = frames < fade_frames ? frames : fade_frames;
+    for (size_t i = 0; i < ramp; i++) {
+        for (size_t c = 0; c < channels; c++) {
+            samples[i * channels + c] =
+                (int16_t)((int32_t)last[c] * (int32_t)(ramp - 1 - i) / (int32_t)ramp);
+        }
+    }
+    
+    // The output is silent from here on
+    memset(m_last_frame, 0, sizeof(m_last_frame));
+    return ramp;
+}
+
+} // namespace Audio
@@ -0,0 +1,58 @@
+/**
+ * @file drift_controller.cpp
+ * @brief Clock drift compensation implementation
+ */
+
+#include "drift_controller.h"
+
+namespace Audio {
+
+DriftController::DriftController()
+    : m_config{}
+    , m_primed(false)
+    , m_filtered_q8(0)
+    , m_integral(0)
+    , m_ppm(0) {
+}
+
+void DriftController::configure(const Config& config) {
+    m_config = config;
+    if (m_config.time_constant_s == 0) {
+        m_config.time_constant_s = 1;
+    }
+    m_primed = false;
+    m_filtered_q8 = 0;
+    m_integral = 0;
+    m_ppm = 0;
+}
+
+int32_t DriftController::update(int32_t error_us, uint32_t interval_us) {
+    if (m_config.max_ppm <= 0) {
+        return 0;
+    }
+    
+    // One-pole average, weight interval / filter time per update
+    int64_t sample_q8 = (int64_t)error_us << 8;
+    if (!m_primed) {
+        m_filtered_q8 = sample_q8;
+        m_primed = true;
+    } else {
+        int64_t filter_us = (int64_t)m_config.filter_ms * 1000;
+        int64_t weight = filter_us > interval_us ? interval_us : filter_us;
+        m_filtered_q8 += filter_us > 0 ? (sample_q8 - m_filtered_q8) * weight / filter_us : sample_q8 - m_filtered_q8;
+    }
+    int64_t error = m_filtered_q8 >> 8;
+    
+    // ppm = e / T + (integral of e dt) / 4T^2, e in us and t in s
+    int64_t t = m_config.time_constant_s;
+    int64_t integral_limit = (int64_t)m_config.max_ppm * 4 * t * t * 1000;
+    m_integral += error * (int64_t)interval_us / 1000;
+    m_integral = m_integral > integral_limit ? integral_limit : m_integral < -integral_limit ? -integral_limit : m_integral;
+    
+    int64_t ppm = error / t + m_integral / (4 * t * t * 1000);
+    int64_t limit = m_config.max_ppm;
+    m_ppm = (int32_t)(ppm > limit ? limit : ppm < -limit ? -limit : ppm);
+    return m_ppm;
+}
+
+} // namespace Audio
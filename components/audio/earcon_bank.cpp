@@ -0,0 +1,60 @@
+/**
+ * @file earcon_bank.cpp
+ * @brief Earcon clips mapped from their flash partition
+ */
+
+#include "earcon_bank.h"
+#include "esp_log.h"
+
+static const char* TAG = "EARCON";
+
+namespace Audio {
+
+EarconBank::EarconBank()
+    : m_mapped(false)
+    , m_handle(0) {
+}
+
+EarconBank::~EarconBank() {
+    close();
+}
+
+bool EarconBank::open(const char* label) {
+    close();
+    
+    const esp_partition_t* partition = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, static_cast<esp_partition_subtype_t>(EARCON_PARTITION_SUBTYPE), label);
+    if (!partition) {
+        ESP_LOGW(TAG, "No '%s' partition", label);
+        return false;
+    }
+    
+    const void* image = nullptr;
+    esp_err_t ret = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA,
+                                       &image, &m_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to map '%s': %s", label, esp_err_to_name(ret));
+        return false;
+    }
+    m_mapped = true;
+    
+    if (!m_index.attach(static_cast<const uint8_t*>(image), partition->size)) {
+        ESP_LOGW(TAG, "'%s' holds no valid earcon image", label);
+        close();
+        return false;
+    }
+    
+    ESP_LOGI(TAG, "%zu earcons mapped from '%s' at 0x%lx", m_index.count(), label,
+             (unsigned long)partition->address);
+    return true;
+}
+
+void EarconBank::close() {
+    if (m_mapped) {
+        m_index.attach(nullptr, 0);
+        esp_partition_munmap(m_handle);
+        m_mapped = false;
+    }
+}
+
+} // namespace Audio
@@ -0,0 +1,116 @@
+/**
+ * @file i2s_capture_source.cpp
+ * @brief I2S microphone input
+ */
+
+#include "i2s_capture_source.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "MIC";
+
+namespace Audio {
+
+I2sCaptureSource::I2sCaptureSource()
+    : m_config{}
+    , m_installed(false)
+    , m_events(nullptr)
+    , m_overruns(0) {
+}
+
+I2sCaptureSource::~I2sCaptureSource() {
+    if (m_installed) {
+        i2s_driver_uninstall(m_config.port);
+    }
+}
+
+bool I2sCaptureSource::init(const Config& config) {
+    if (config.channels == 0 || config.channels > 2) {
+        ESP_LOGE(TAG, "Unsupported channel count %u", (unsigned)config.channels);
+        return false;
+    }
+    m_config = config;
+    
+    i2s_config_t i2s_config = {
+        .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
+        .sample_rate = config.sample_rate,
+        .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+        .channel_format = config.channels == 1 ? I2S_CHANNEL_FMT_ONLY_LEFT : I2S_CHANNEL_FMT_RIGHT_LEFT,
+        .communication_format = I2S_COMM_FORMAT_STAND_I2S,
+        .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
+        .dma_buf_count = config.dma_buf_count,
+        .dma_buf_len = config.dma_buf_len,
+        .use_apll = false,
+        .tx_desc_auto_clear = false,
+        .fixed_mclk = 0
+    };
+    
+    i2s_pin_config_t pin_config = {
+        .bck_io_num = config.bck_pin,
+        .ws_io_num = config.ws_pin,
+        .data_out_num = I2S_PIN_NO_CHANGE,
+        .data_in_num = config.data_in_pin
+    };
+    
+    // The event queue is only used to learn about RX overflows
+    esp_err_t ret = i2s_driver_install(config.port, &i2s_config, 4, &m_events);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "I2S driver install failed: %s", esp_err_to_name(ret));
+        return false;
+    }
+    m_installed = true;
+    
+    ret = i2s_set_pin(config.port, &pin_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "I2S set pin failed: %s", esp_err_to_name(ret));
+        return false;
+    }
+    
+    // Installing starts the port; capture only once start() is called
+    i2s_stop(config.port);
+    return true;
+}
+
+bool I2sCaptureSource::start() {
+    if (!m_installed) {
+        return false;
+    }
+    drainEvents();
+    i2s_zero_dma_buffer(m_config.port);
+    return i2s_start(m_config.port) == ESP_OK;
+}
+
+void I2sCaptureSource::stop() {
+    if (m_installed) {
+        i2s_stop(m_config.port);
+    }
+}
+
+void I2sCaptureSource::drainEvents() {
+    i2s_event_t event;
+    while (m_events && xQueueReceive(m_events, &event, 0) == pdTRUE) {
+        if (event.type == I2S_EVENT_RX_Q_OVF) {
+            m_overruns++;
+        }
+    }
+}
+
+bool I2sCaptureSource::read(int16_t* out, size_t frames, int64_t& captured_at_us) {
+    size_t bytes = frames * m_config.channels * sizeof(int16_t);
+    size_t bytes_read = 0;
+    esp_err_t ret = i2s_read(m_config.port, out, bytes, &bytes_read, portMAX_DELAY);
+    int64_t now = esp_timer_get_time();
+    drainEvents();
+    
+    if (ret != ESP_OK || bytes_read != bytes) {
+        ESP_LOGW(TAG, "I2S read failed: %s", esp_err_to_name(ret));
+        return false;
+    }
+    
+    // The last sample just arrived; the first one is a frame older. DMA
+    // buffering adds up to one buffer on top, which is not tracked.
+    captured_at_us = now - (int64_t)(frames * 1000000 / m_config.sample_rate);
+    return true;
+}
+
+} // namespace Audio
@@ -0,0 +1,176 @@
+/**
+ * @file ima_adpcm.cpp
+ * @brief IMA-ADPCM encoder and decoder implementation
+ */
+
+#include "ima_adpcm.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#else
+#define DRAM_ATTR
+#endif
+
+namespace Audio {
+namespace ImaAdpcm {
+
+namespace {
+
+constexpr int16_t STEP_TABLE[MAX_STEP_INDEX + 1] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+constexpr int8_t INDEX_TABLE[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+/**
+ * Every (step index, nibble) pair expanded ahead of time: the signed
+ * predictor delta of the reference shift-and-add rule, and the clamped
+ * next step index. Decoding a sample is then two loads, an add and a clamp.
+ */
+struct Tables {
+    int16_t delta[(MAX_STEP_INDEX + 1) * 16];
+    uint8_t next[(MAX_STEP_INDEX + 1) * 16];
+};
+
+constexpr Tables makeTables() {
+    Tables tables = {};
+    for (int index = 0; index <= MAX_STEP_INDEX; index++) {
+        int step = STEP_TABLE[index];
+        for (int nibble = 0; nibble < 16; nibble++) {
+            int diff = step >> 3;
+            if (nibble & 4) diff += step;
+            if (nibble & 2) diff += step >> 1;
+            if (nibble & 1) diff += step >> 2;
+            tables.delta[index * 16 + nibble] = (int16_t)((nibble & 8) ? -diff : diff);
+            
+            int next = index + INDEX_TABLE[nibble];
+            tables.next[index * 16 + nibble] = (uint8_t)(next < 0 ? 0 : next > MAX_STEP_INDEX ? MAX_STEP_INDEX : next);
+        }
+    }
+    return tables;
+}
+
+// Hot in the playback task: keep it out of flash so a cache miss never stalls a decode
+DRAM_ATTR const Tables TABLES = makeTables();
+
+inline int32_t clamp16(int32_t value) {
+    return value > 32767 ? 32767 : value < -32768 ? -32768 : value;
+}
+
+/**
+ * @brief Decoder state of one channel, kept in registers across a block
+ */
+struct Channel {
+    int32_t predictor;
+    uint32_t row;       // step index * 16
+    
+    inline int16_t expand(uint32_t nibble) {
+        uint32_t at = row + nibble;
+        predictor = clamp16(predictor + TABLES.delta[at]);
+        row = (uint32_t)TABLES.next[at] << 4;
+        return (int16_t)predictor;
+    }
+};
+
+Channel readHeader(const uint8_t* header) {
+    Channel channel;
+    channel.predictor = (int16_t)(header[0] | (header[1] << 8));
+    uint32_t index = header[2] > MAX_STEP_INDEX ? MAX_STEP_INDEX : header[2];
+    channel.row = index << 4;
+    return channel;
+}
+
+uint8_t quantize(int32_t sample, State& state) {
+    int32_t diff = sample - state.predictor;
+    uint8_t nibble = 0;
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+    
+    int32_t step = STEP_TABLE[state.step_index];
+    if (diff >= step) { nibble |= 4; diff -= step; }
+    step >>= 1;
+    if (diff >= step) { nibble |= 2; diff -= step; }
+    step >>= 1;
+    if (diff >= step) { nibble |= 1; }
+    
+    // Track exactly what the decoder will reconstruct
+    uint32_t at = (uint32_t)state.step_index * 16 + nibble;
+    state.predictor = (int16_t)clamp16(state.predictor + TABLES.delta[at]);
+    state.step_index = TABLES.next[at];
+    return nibble;
+}
+
+} // namespace
+
+size_t decode(const uint8_t* in, size_t length, uint8_t channels, int16_t* out) {
+    size_t count = frames(length, channels);
+    if (count == 0 || channels > 2) {
+        return 0;
+    }
+    
+    const uint8_t* data = in + HEADER_BYTES_PER_CHANNEL * channels;
+    size_t data_len = length - HEADER_BYTES_PER_CHANNEL * channels;
+    
+    if (channels == 1) {
+        Channel mono = readHeader(in);
+        for (size_t i = 0; i < data_len; i++) {
+            uint32_t byte = data[i];
+            out[0] = mono.expand(byte & 0x0F);
+            out[1] = mono.expand(byte >> 4);
+            out += 2;
+        }
+    } else {
+        Channel left = readHeader(in);
+        Channel right = readHeader(in + HEADER_BYTES_PER_CHANNEL);
+        for (size_t i = 0; i < data_len; i++) {
+            uint32_t byte = data[i];
+            out[0] = left.expand(byte & 0x0F);
+            out[1] = right.expand(byte >> 4);
+            out += 2;
+        }
+    }
+    return count;
+}
+
+size_t encode(const int16_t* pcm, size_t frames, uint8_t channels, State* state, uint8_t* out) {
+    if (channels == 0 || channels > 2) {
+        return 0;
+    }
+    if (channels == 1) {
+        frames &= ~(size_t)1;
+    }
+    
+    for (uint8_t c = 0; c < channels; c++) {
+        uint8_t* header = out + HEADER_BYTES_PER_CHANNEL * c;
+        header[0] = (uint8_t)(state[c].predictor & 0xFF);
+        header[1] = (uint8_t)((uint16_t)state[c].predictor >> 8);
+        header[2] = state[c].step_index;
+        header[3] = 0;
+    }
+    
+    uint8_t* data = out + HEADER_BYTES_PER_CHANNEL * channels;
+    size_t samples = frames * channels;
+    for (size_t i = 0; i < samples; i += 2) {
+        // Interleaved order, two samples per byte: mono s0 s1, stereo L R
+        uint8_t low = quantize(pcm[i], state[0]);
+        uint8_t high = quantize(pcm[i + 1], state[channels - 1]);
+        *data++ = (uint8_t)(low | (high << 4));
+    }
+    return encodedSize(frames, channels);
+}
+
+} // namespace ImaAdpcm
+} // namespace Audio
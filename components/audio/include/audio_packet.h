@@ -0,0 +1,133 @@
+/**
+ * @file audio_packet.h
+ * @brief Framing of TOPIC_AUDIO_DATA payloads
+ * 
+ * Every audio datagram starts with a fixed 16 byte little-endian header:
+ * 
+ *   offset  size  field
+ *   0       2     magic (0x4156, "VA" on the wire)
+ *   2       1     version
+ *   3       1     codec
+ *   4       2     sequence number, +1 per packet, wraps
+ *   6       1     channels
+ *   7       1     flags (reserved, 0)
+ *   8       4     timestamp of the first frame, in frames, wraps
+ *   12      4     sample rate in Hz
+ * 
+ * Codecs:
+ * 
+ *   0  PCM16      interleaved signed 16-bit little-endian samples
+ *   1  IMA_ADPCM  one block per packet: per channel a 4 byte header
+ *                 (predictor int16, step index, 0) holding the state before
+ *                 the first sample, then 4-bit codes in interleaved sample
+ *                 order, two per byte, low nibble first (mono: s0 s1,
+ *                 stereo: L R). Mono blocks carry an even frame count.
+ * 
+ * Payloads without the magic are treated as headerless PCM in arrival
+ * order, as sent by older servers.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "ima_adpcm.h"
+
+namespace Audio {
+
+static constexpr uint16_t PACKET_MAGIC = 0x4156;
+static constexpr uint8_t PACKET_VERSION = 1;
+static constexpr size_t PACKET_HEADER_SIZE = 16;
+
+enum class Codec : uint8_t {
+    PCM16 = 0,      // Interleaved signed 16-bit little-endian
+    IMA_ADPCM = 1,  // 4:1, see above
+};
+
+/**
+ * @brief Name used when advertising codec support
+ */
+inline const char* codecName(Codec codec) {
+    switch (codec) {
+        case Codec::PCM16:     return "pcm16";
+        case Codec::IMA_ADPCM: return "ima-adpcm";
+        default:               return "unknown";
+    }
+}
+
+/**
+ * @brief Decoded header plus a view of the payload
+ */
+struct PacketInfo {
+    uint16_t seq;
+    uint32_t timestamp;
+    Codec codec;
+    uint8_t channels;
+    uint32_t sample_rate;
+    const uint8_t* payload;
+    size_t payload_len;
+};
+
+/**
+ * @brief Parse a framed audio datagram
+ * 
+ * @return false if the datagram has no valid header
+ */
+inline bool parsePacket(const uint8_t* data, size_t length, PacketInfo& info) {
+    if (length < PACKET_HEADER_SIZE) {
+        return false;
+    }
+    
+    uint16_t magic = (uint16_t)(data[0] | (data[1] << 8));
+    if (magic != PACKET_MAGIC || data[2] != PACKET_VERSION) {
+        return false;
+    }
+    
+    info.codec = static_cast<Codec>(data[3]);
+    info.seq = (uint16_t)(data[4] | (data[5] << 8));
+    info.channels = data[6];
+    info.timestamp = (uint32_t)data[8] | ((uint32_t)data[9] << 8) |
+                     ((uint32_t)data[10] << 16) | ((uint32_t)data[11] << 24);
+    info.sample_rate = (uint32_t)data[12] | ((uint32_t)data[13] << 8) |
+                       ((uint32_t)data[14] << 16) | ((uint32_t)data[15] << 24);
+    info.payload = data + PACKET_HEADER_SIZE;
+    info.payload_len = length - PACKET_HEADER_SIZE;
+    return true;
+}
+
+/**
+ * @brief Audio frames carried by a packet, 0 for an unknown codec
+ */
+inline uint32_t packetFrames(const PacketInfo& info) {
+    if (info.channels == 0) {
+        return 0;
+    }
+    switch (info.codec) {
+        case Codec::PCM16:
+            return (uint32_t)(info.payload_len / (info.channels * sizeof(int16_t)));
+        case Codec::IMA_ADPCM:
+            return (uint32_t)ImaAdpcm::frames(info.payload_len, info.channels);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Write the header for info into out (PACKET_HEADER_SIZE bytes)
+ */
+inline void writePacketHeader(uint8_t* out, const PacketInfo& info) {
+    out[0] = (uint8_t)(PACKET_MAGIC & 0xFF);
+    out[1] = (uint8_t)(PACKET_MAGIC >> 8);
+    out[2] = PACKET_VERSION;
+    out[3] = static_cast<uint8_t>(info.codec);
+    out[4] = (uint8_t)(info.seq & 0xFF);
+    out[5] = (uint8_t)(info.seq >> 8);
+    out[6] = info.channels;
+    out[7] = 0;
+    for (int i = 0; i < 4; i++) {
+        out[8 + i] = (uint8_t)(info.timestamp >> (8 * i));
+        out[12 + i] = (uint8_t)(info.sample_rate >> (8 * i));
+    }
+}
+
+} // namespace Audio
@@ -0,0 +1,274 @@
+/**
+ * @file audio_player.h
+ * @brief Buffered I2S playback
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "driver/i2s.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "drift_controller.h"
+#include "earcon_index.h"
+#include "jitter_buffer.h"
+#include "mixer.h"
+#include "resampler.h"
+#include "spsc_ring.h"
+#include "tone_generator.h"
+
+namespace Audio {
+
+/**
+ * @brief Jitter-absorbing playback pipeline
+ * 
+ * Audio datagrams (see audio_packet.h) are pushed into a JitterBuffer
+ * (PSRAM when available, internal RAM otherwise) by the network task and
+ * played out by a dedicated task that blocks on the I2S DMA queue, so
+ * playback is paced by the I2S clock and never by packet arrival.
+ * 
+ * Compressed packets stay compressed in the jitter buffer (four times the
+ * audio per slot for IMA-ADPCM) and are decoded one packet at a time by
+ * the playback task just before they are written to I2S.
+ * 
+ * The stream may use any rate from MIN_INPUT_RATE up to twice the output
+ * rate, mono or with the output's channel count; a Resampler converts it
+ * to the I2S format on the way into each chunk. The same resampler runs
+ * a few hundred ppm fast or slow as needed to hold the jitter buffer at
+ * its target depth, so the sender's clock drifting against the I2S clock
+ * never builds into an underrun or an ever-growing delay.
+ * 
+ * Playback starts once the jitter buffer reaches its target depth, or
+ * once the stream goes quiet with a shorter tail buffered. A lost packet
+ * is concealed by fading the last frame to silence for one packet; when
+ * the buffer runs dry the output fades out and the player rebuffers.
+ * Playback fades back in after either. When the jitter buffer sheds a
+ * surplus packet to cut latency, the player crossfades from its start
+ * into the next packet over the same fade length.
+ * 
+ * Earcons (short clips from the memory-mapped earcon partition) are mixed
+ * on top of whatever plays, or of silence when nothing does, read straight
+ * from flash: PCM16 clips sample by sample, IMA-ADPCM clips one block at a
+ * time. Locally generated tones are mixed the same way.
+ * 
+ * Every chunk goes through a Mixer on its way to I2S: each source has its
+ * own gain under a master volume, and the stream is ducked while an earcon
+ * or tone plays. A volume change is confirmed with a short tick.
+ */
+class AudioPlayer {
+public:
+    static constexpr size_t CHUNK_BYTES = 1024;    // Per I2S write, a multiple of any frame size
+    static constexpr uint8_t MAX_CHANNELS = 2;
+    static constexpr size_t MAX_DECODED_SAMPLES = ImaAdpcm::frames(JitterBuffer::MAX_PAYLOAD, 1);
+    static constexpr uint32_t MIN_INPUT_RATE = 8000;
+    static constexpr size_t MAX_OVERLAP_FRAMES = 512;   // Trim crossfade limit, 5.8 ms at 88.2 kHz
+    
+    /**
+     * @brief Codecs write() accepts, smallest on the wire first
+     */
+    static constexpr Codec CODECS[] = {Codec::IMA_ADPCM, Codec::PCM16};
+    
+    struct Config {
+        i2s_port_t port;
+        uint32_t sample_rate;
+        uint8_t channels;               // Interleaved 16-bit samples
+        uint32_t prebuffer_ms;          // Minimum jitter buffer depth before playback
+        uint32_t max_depth_ms;          // Largest depth the jitter buffer adapts to
+        uint8_t jitter_multiplier;      // Target depth in multiples of measured jitter
+        uint32_t low_water_ms;          // Depth below which a dip is counted while playing
+        uint32_t fade_ms;               // Fade-out on loss/underrun, fade-in on resume, trim crossfade
+        uint32_t flush_timeout_ms;      // Quiet time after which a short tail is played anyway
+        DriftController::Config drift;  // Rate trim that holds the jitter buffer at its target
+        Mixer::Config mixer;            // sample_rate and channels are taken from above
+        uint16_t volume_tick_hz;        // Tone played on a volume change, 0 = none
+        uint16_t volume_tick_ms;
+        const char* task_name;
+        uint32_t task_stack_size;
+        UBaseType_t task_priority;
+        BaseType_t task_core;
+    };
+    
+    /**
+     * @brief Playback counters
+     */
+    struct Stats {
+        JitterBuffer::Stats jitter;
+        uint32_t rejected;              // Packets in a format the player cannot convert
+        uint32_t low_water_dips;        // Times the depth fell below low water while playing
+        uint64_t bytes_played;          // Stream bytes sent to I2S
+        uint64_t bytes_concealed;       // Faded or silent bytes inserted for loss and underrun
+        uint64_t frames_decoded;        // Frames of compressed packets decoded
+        uint64_t decode_cycles;         // CPU cycles spent decoding them
+        uint32_t input_rate;            // Rate of the stream being played
+        int32_t drift_ppm;              // Current rate trim, positive consumes faster
+        int32_t drift_error_us;         // Averaged jitter buffer excess over the target
+        uint64_t frames_resampled;      // Output frames from the resampler
+        uint64_t resample_cycles;       // CPU cycles spent producing them
+        uint32_t clips_played;          // Earcons started
+        uint32_t clips_rejected;        // Earcons in the wrong format, or the queue was full
+        uint32_t tones_played;          // Tones started, volume ticks included
+        uint32_t tones_rejected;        // Unplayable frequency, or the queue was full
+        uint64_t frames_mixed;          // Frames through the mixer
+        uint64_t mix_cycles;            // CPU cycles spent mixing them
+    };
+    
+    AudioPlayer();
+    ~AudioPlayer();
+    
+    AudioPlayer(const AudioPlayer&) = delete;
+    AudioPlayer& operator=(const AudioPlayer&) = delete;
+    
+    /**
+     * @brief Allocate the jitter buffer; I2S must already be installed
+     */
+    bool init(const Config& config);
+    
+    /**
+     * @brief Start the playback task
+     */
+    bool start();
+    
+    /**
+     * @brief Stop the playback task and drop buffered audio
+     */
+    void stop();
+    
+    /**
+     * @brief Queue one audio datagram (single producer), never blocks
+     * 
+     * Framed packets must use one of CODECS, a rate from MIN_INPUT_RATE to
+     * twice the output rate, and one channel or the output's count.
+     * Headerless payloads are taken as PCM in the output format and
+     * numbered in arrival order.
+     * 
+     * @return false if the datagram was dropped
+     */
+    bool write(const uint8_t* data, size_t length);
+    
+    /**
+     * @brief Mix a clip into the output (same producer as write()), never blocks
+     * 
+     * The clip must match the output rate; mono clips play on every
+     * channel. A new clip replaces the one playing. clip.data must stay
+     * mapped while the player runs.
+     * 
+     * @return false if the clip was rejected
+     */
+    bool playClip(const EarconClip& clip);
+    
+    /**
+     * @brief Mix a sine tone into the output (same producer as write()), never blocks
+     * 
+     * A new tone replaces the one playing.
+     * 
+     * @return false if the frequency is not below Nyquist or the queue is full
+     */
+    bool playTone(uint16_t frequency_hz, uint16_t duration_ms);
+    
+    /**
+     * @brief Change the master volume (any task)
+     * 
+     * @return The volume step now in effect, 0 is muted
+     */
+    uint8_t setVolume(int step);
+    uint8_t stepVolume(int delta);
+    uint8_t getVolume() const { return m_mixer.getVolume(); }
+    uint8_t getVolumeSteps() const { return m_mixer.getVolumeSteps(); }
+    
+    Stats getStats() const;
+    bool isPlaying() const { return m_jitter.isPlaying(); }
+    bool isPsram() const { return m_storage_in_psram; }
+    
+private:
+    static void taskEntry(void* arg);
+    void task();
+    static bool supports(Codec codec);
+    bool nextPacket();
+    void setInputFormat(uint32_t sample_rate, uint8_t channels);
+    void trimForDrift();
+    void waitForData();
+    void wakeForVolume();
+    void fadeIn(int16_t* samples, size_t frames, uint8_t channels, size_t fade_frames);
+    void crossfade(int16_t* samples, size_t frames, uint8_t channels);
+    size_t fadeOut(int16_t* from, int16_t* samples, size_t frames, uint8_t channels, size_t fade_frames);
+    bool clipPlaying();
+    bool tonePlaying();
+    void mixClip(int16_t* chunk, size_t frames);
+    void mixTone(int16_t* chunk, size_t frames);
+    
+    struct ToneRequest {
+        uint16_t frequency_hz;
+        uint16_t duration_ms;
+    };
+    
+    Config m_config;
+    size_t m_frame_bytes;
+    size_t m_fade_frames;
+    
+    void* m_storage;
+    bool m_storage_in_psram;
+    JitterBuffer m_jitter;                          // Producer -> playback task
+    LockFree::SpscRing<EarconClip, 4> m_clip_requests;  // Producer -> playback task
+    LockFree::SpscRing<ToneRequest, 4> m_tone_requests; // Producer -> playback task
+    Mixer m_mixer;                                  // Volume from any task, the rest playback task
+    TaskHandle_t m_task;
+    
+    std::atomic<uint32_t> m_last_write_ms;          // Producer: last accepted write
+    
+    // Producer only
+    uint16_t m_legacy_seq;
+    uint32_t m_legacy_timestamp;
+    uint32_t m_rejected;
+    uint32_t m_clips_rejected;
+    uint32_t m_tones_rejected;
+    
+    // Playback task only
+    bool m_fade_pending;                            // Fade in the next packet
+    bool m_below_low_water;
+    int16_t m_last_frame[MAX_CHANNELS];             // In the input format
+    uint8_t* m_play;                                // m_packet, or m_decoded for compressed packets
+    bool m_play_concealed;                          // m_play is concealment, not stream
+    size_t m_packet_len;
+    size_t m_packet_pos;
+    uint32_t m_in_rate;                             // Format of the stream being played
+    uint8_t m_in_channels;
+    size_t m_in_frame_bytes;
+    size_t m_in_fade_frames;
+    size_t m_overlap_frames;                        // Surplus packet start to crossfade from
+    Resampler m_resampler;                          // Input format -> I2S format
+    DriftController m_drift;
+    int64_t m_last_pop_us;
+    alignas(4) uint8_t m_packet[JitterBuffer::MAX_PAYLOAD];
+    int16_t m_decoded[MAX_DECODED_SAMPLES];
+    int16_t m_overlap[MAX_OVERLAP_FRAMES * MAX_CHANNELS];
+    alignas(4) uint8_t m_chunk[CHUNK_BYTES];
+    uint32_t m_low_water_dips;
+    uint64_t m_bytes_played;
+    uint64_t m_bytes_concealed;
+    uint64_t m_frames_decoded;
+    uint64_t m_decode_cycles;
+    uint64_t m_frames_resampled;
+    uint64_t m_resample_cycles;
+    
+    // Earcon being mixed, playback task only
+    bool m_clip_active;
+    EarconClip m_clip;
+    uint32_t m_clip_frame;                          // Next frame of the clip
+    size_t m_clip_block_pos;                        // Next frame in m_clip_block
+    size_t m_clip_block_frames;                     // Frames decoded into m_clip_block
+    int16_t m_clip_block[EARCON_MAX_BLOCK_FRAMES * MAX_CHANNELS];
+    uint32_t m_clips_played;
+    
+    // Tone being mixed, playback task only
+    ToneGenerator m_tone;
+    bool m_tone_ducks;                              // Requested tones duck the stream, ticks do not
+    uint8_t m_volume_heard;                         // Volume the last tick confirmed
+    int16_t m_tone_block[CHUNK_BYTES / sizeof(int16_t)];
+    uint32_t m_tones_played;
+    uint64_t m_frames_mixed;
+    uint64_t m_mix_cycles;
+};
+
+} // namespace Audio
@@ -0,0 +1,44 @@
+/**
+ * @file capture_source.h
+ * @brief Where captured audio comes from
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Audio {
+
+/**
+ * @brief A blocking source of interleaved 16-bit PCM
+ * 
+ * Implemented by I2sCaptureSource on the device and by WavCaptureSource
+ * on the host, so everything downstream (MicFramer, the stream sender)
+ * runs unchanged against a recording.
+ */
+class CaptureSource {
+public:
+    virtual ~CaptureSource() = default;
+    
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    
+    /**
+     * @brief Fill out with exactly frames frames, blocking until captured
+     * 
+     * @param out Room for frames * channels samples; written in place, so
+     *            it may point straight into an outgoing packet
+     * @param captured_at_us Set to when the first frame was sampled, on
+     *                       the clock the packet sink measures latency with
+     * @return false at end of input or on a read error
+     */
+    virtual bool read(int16_t* out, size_t frames, int64_t& captured_at_us) = 0;
+    
+    /**
+     * @brief Times audio was lost because read() was not called in time
+     */
+    virtual uint32_t getOverruns() const { return 0; }
+};
+
+} // namespace Audio
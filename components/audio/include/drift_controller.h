@@ -0,0 +1,67 @@
+/**
+ * @file drift_controller.h
+ * @brief Clock drift compensation from buffer fill level
+ * 
+ * Platform independent so it can be simulated on the host
+ * (tools/resample_bench.cpp).
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace Audio {
+
+/**
+ * @brief PI controller from buffered audio to a resampler trim in ppm
+ * 
+ * The sender's sample clock and the I2S clock never agree exactly, so a
+ * buffer fed by one and drained by the other slowly fills or drains. The
+ * fill level is low-pass filtered to average out network jitter, and the
+ * trim that holds it at the target is found by the integral term: once
+ * settled, it is the measured clock offset, and it survives rebuffering.
+ * 
+ * With time constant T, the proportional gain corrects one microsecond of
+ * excess per second per ppm over T seconds, and the integral gain is set
+ * for critical damping (1 / 4T^2).
+ */
+class DriftController {
+public:
+    struct Config {
+        int32_t max_ppm;            // Trim limit either way, 0 disables
+        uint32_t time_constant_s;   // Response time; longer rides out more jitter
+        uint32_t filter_ms;         // Fill level averaging
+    };
+    
+    DriftController();
+    
+    void configure(const Config& config);
+    
+    /**
+     * @brief Fold in one fill level measurement
+     * 
+     * @param error_us    Buffered audio minus the target, in microseconds
+     * @param interval_us Time since the previous measurement
+     * @return Trim in ppm: positive means consume faster
+     */
+    int32_t update(int32_t error_us, uint32_t interval_us);
+    
+    /**
+     * @brief Restart the fill level average, e.g. after a rebuffer
+     * 
+     * The integral (the clock offset) is kept.
+     */
+    void restart() { m_primed = false; }
+    
+    int32_t getPpm() const { return m_ppm; }
+    int32_t getFilteredErrorUs() const { return (int32_t)(m_filtered_q8 >> 8); }
+    
+private:
+    Config m_config;
+    bool m_primed;
+    int64_t m_filtered_q8;          // Averaged error, us with 8 fractional bits
+    int64_t m_integral;             // Error integrated over time, us * ms
+    int32_t m_ppm;
+};
+
+} // namespace Audio
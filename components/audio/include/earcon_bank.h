@@ -0,0 +1,50 @@
+/**
+ * @file earcon_bank.h
+ * @brief Earcon clips mapped from their flash partition
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "earcon_index.h"
+#include "esp_partition.h"
+
+namespace Audio {
+
+/**
+ * @brief Maps the earcon partition and looks clips up by id
+ * 
+ * The partition (type data, subtype EARCON_PARTITION_SUBTYPE) is mapped
+ * into the data address space once, so clip pointers stay valid, and are
+ * read through the flash cache, until close(). No clip is copied to RAM.
+ */
+class EarconBank {
+public:
+    static constexpr uint8_t EARCON_PARTITION_SUBTYPE = 0x40;
+    
+    EarconBank();
+    ~EarconBank();
+    
+    EarconBank(const EarconBank&) = delete;
+    EarconBank& operator=(const EarconBank&) = delete;
+    
+    /**
+     * @brief Map the partition called label and validate its index
+     * 
+     * @return false if there is no such partition or it holds no valid image
+     */
+    bool open(const char* label);
+    void close();
+    
+    bool isOpen() const { return m_mapped; }
+    size_t count() const { return m_index.count(); }
+    bool find(uint16_t id, EarconClip& clip) const { return m_index.find(id, clip); }
+    
+private:
+    bool m_mapped;
+    esp_partition_mmap_handle_t m_handle;
+    EarconIndex m_index;
+};
+
+} // namespace Audio
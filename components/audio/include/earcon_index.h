@@ -0,0 +1,198 @@
+/**
+ * @file earcon_index.h
+ * @brief Layout of the earcon asset image (tools/pack_earcons.py)
+ * 
+ * The image sits in its own flash partition and is used in place through
+ * a memory mapping. Everything is little-endian:
+ * 
+ *   offset  size  field
+ *   0       4     magic "ERCN"
+ *   4       2     version
+ *   6       2     clip count
+ *   8       4     image size in bytes
+ *   12      4     reserved, 0
+ *   16      24*n  index, sorted by clip id:
+ *                   0   2  clip id
+ *                   2   1  codec (audio_packet.h)
+ *                   3   1  channels
+ *                   4   4  sample rate in Hz
+ *                   8   4  data offset from the image start, 4-byte aligned
+ *                   12  4  data length in bytes
+ *                   16  4  frames
+ *                   20  2  frames per block (IMA_ADPCM), 0 for PCM16
+ *                   22  2  reserved, 0
+ *   ...           clip data
+ * 
+ * PCM16 clips are plain interleaved samples. IMA_ADPCM clips are a run of
+ * blocks in the audio_packet.h payload layout, each of block_frames frames
+ * (the last one may be shorter), so the player decodes one block at a time
+ * straight from flash.
+ * 
+ * Header only and platform independent so the packer's output can be
+ * checked on the host (tools/earcon_check.cpp).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "audio_packet.h"
+
+namespace Audio {
+
+static constexpr uint32_t EARCON_MAGIC = 0x4E435245;    // "ERCN"
+static constexpr uint16_t EARCON_VERSION = 1;
+static constexpr size_t EARCON_HEADER_SIZE = 16;
+static constexpr size_t EARCON_ENTRY_SIZE = 24;
+static constexpr uint16_t EARCON_MAX_BLOCK_FRAMES = 512;
+
+/**
+ * @brief One clip, pointing into the image
+ */
+struct EarconClip {
+    uint16_t id;
+    Codec codec;
+    uint8_t channels;
+    uint32_t sample_rate;
+    const uint8_t* data;
+    uint32_t length;
+    uint32_t frames;
+    uint16_t block_frames;
+};
+
+/**
+ * @brief Read-only view of an earcon image
+ */
+class EarconIndex {
+public:
+    EarconIndex() : m_image(nullptr), m_count(0) {}
+    
+    /**
+     * @brief Validate the header and every index entry
+     * 
+     * @param size Bytes available at image (the partition size)
+     * @return false if the image is absent, malformed or does not fit
+     */
+    bool attach(const uint8_t* image, size_t size) {
+        m_image = nullptr;
+        m_count = 0;
+        if (!image || size < EARCON_HEADER_SIZE ||
+            readLe32(image) != EARCON_MAGIC || readLe16(image + 4) != EARCON_VERSION) {
+            return false;
+        }
+        
+        uint16_t count = readLe16(image + 6);
+        uint32_t image_size = readLe32(image + 8);
+        if (image_size > size || EARCON_HEADER_SIZE + (size_t)count * EARCON_ENTRY_SIZE > image_size) {
+            return false;
+        }
+        
+        uint32_t previous_id = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            EarconClip clip;
+            if (!readEntry(image, i, clip) || !validEntry(clip, image, image_size) ||
+                (i > 0 && clip.id <= previous_id)) {
+                return false;
+            }
+            previous_id = clip.id;
+        }
+        
+        m_image = image;
+        m_count = count;
+        return true;
+    }
+    
+    size_t count() const { return m_count; }
+    
+    bool at(size_t index, EarconClip& clip) const {
+        return index < m_count && readEntry(m_image, index, clip);
+    }
+    
+    /**
+     * @brief Look a clip up by id (binary search over the sorted index)
+     */
+    bool find(uint16_t id, EarconClip& clip) const {
+        size_t low = 0;
+        size_t high = m_count;
+        while (low < high) {
+            size_t mid = (low + high) / 2;
+            uint16_t mid_id = readLe16(m_image + EARCON_HEADER_SIZE + mid * EARCON_ENTRY_SIZE);
+            if (mid_id == id) {
+                return readEntry(m_image, mid, clip);
+            }
+            if (mid_id < id) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return false;
+    }
+    
+    /**
+     * @brief Encoded size of block number block of clip
+     */
+    static size_t blockBytes(const EarconClip& clip, uint32_t block) {
+        uint32_t first = block * clip.block_frames;
+        uint32_t frames = clip.frames - first < clip.block_frames ? clip.frames - first : clip.block_frames;
+        return ImaAdpcm::encodedSize(frames, clip.channels);
+    }
+    
+private:
+    static uint16_t readLe16(const uint8_t* p) {
+        return (uint16_t)(p[0] | (p[1] << 8));
+    }
+    
+    static uint32_t readLe32(const uint8_t* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+    
+    static bool readEntry(const uint8_t* image, size_t index, EarconClip& clip) {
+        const uint8_t* entry = image + EARCON_HEADER_SIZE + index * EARCON_ENTRY_SIZE;
+        clip.id = readLe16(entry);
+        clip.codec = static_cast<Codec>(entry[2]);
+        clip.channels = entry[3];
+        clip.sample_rate = readLe32(entry + 4);
+        clip.data = image + readLe32(entry + 8);
+        clip.length = readLe32(entry + 12);
+        clip.frames = readLe32(entry + 16);
+        clip.block_frames = readLe16(entry + 20);
+        return true;
+    }
+    
+    static bool validEntry(const EarconClip& clip, const uint8_t* image, uint32_t image_size) {
+        uint32_t offset = (uint32_t)(clip.data - image);
+        if ((offset & 3) != 0 || offset < EARCON_HEADER_SIZE || offset > image_size ||
+            clip.length > image_size - offset ||
+            clip.channels == 0 || clip.channels > 2 || clip.sample_rate == 0) {
+            return false;
+        }
+        
+        switch (clip.codec) {
+            case Codec::PCM16:
+                return clip.block_frames == 0 &&
+                       (uint64_t)clip.frames * clip.channels * sizeof(int16_t) == clip.length;
+            
+            case Codec::IMA_ADPCM: {
+                // Mono blocks carry an even frame count, the last one too
+                if (clip.block_frames == 0 || clip.block_frames > EARCON_MAX_BLOCK_FRAMES ||
+                    (clip.channels == 1 && ((clip.block_frames | clip.frames) & 1))) {
+                    return false;
+                }
+                uint64_t total = 0;
+                for (uint32_t block = 0; (uint64_t)block * clip.block_frames < clip.frames; block++) {
+                    total += blockBytes(clip, block);
+                }
+                return total == clip.length;
+            }
+            
+            default:
+                return false;
+        }
+    }
+    
+    const uint8_t* m_image;
+    size_t m_count;
+};
+
+} // namespace Audio
@@ -0,0 +1,62 @@
+/**
+ * @file i2s_capture_source.h
+ * @brief I2S microphone input
+ */
+
+#pragma once
+
+#include "capture_source.h"
+#include "driver/i2s.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+namespace Audio {
+
+/**
+ * @brief Captures from an I2S RX port through DMA
+ * 
+ * The driver fills a ring of DMA buffers from the I2S interrupt; read()
+ * copies the oldest samples straight into the caller's buffer (the
+ * outgoing packet, with MicFramer), so there is no staging copy in
+ * between. If the reader falls behind the driver overwrites the oldest
+ * DMA buffer and reports an RX queue overflow, counted in getOverruns().
+ */
+class I2sCaptureSource : public CaptureSource {
+public:
+    struct Config {
+        i2s_port_t port;
+        uint32_t sample_rate;
+        uint8_t channels;               // 1 = left slot only, 2 = both
+        int bck_pin;
+        int ws_pin;
+        int data_in_pin;
+        int dma_buf_count;
+        int dma_buf_len;                // In frames
+    };
+    
+    I2sCaptureSource();
+    ~I2sCaptureSource() override;
+    
+    I2sCaptureSource(const I2sCaptureSource&) = delete;
+    I2sCaptureSource& operator=(const I2sCaptureSource&) = delete;
+    
+    /**
+     * @brief Install the driver (stopped) and route the pins
+     */
+    bool init(const Config& config);
+    
+    bool start() override;
+    void stop() override;
+    bool read(int16_t* out, size_t frames, int64_t& captured_at_us) override;
+    uint32_t getOverruns() const override { return m_overruns; }
+    
+private:
+    void drainEvents();
+    
+    Config m_config;
+    bool m_installed;
+    QueueHandle_t m_events;
+    uint32_t m_overruns;
+};
+
+} // namespace Audio
@@ -0,0 +1,62 @@
+/**
+ * @file ima_adpcm.h
+ * @brief IMA-ADPCM (4 bits per sample) encoder and decoder
+ * 
+ * Platform independent so it can be benchmarked on the host
+ * (tools/codec_bench.cpp). Payload layout is described in audio_packet.h.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Audio {
+namespace ImaAdpcm {
+
+static constexpr size_t HEADER_BYTES_PER_CHANNEL = 4;   // Predictor (2), step index (1), reserved (1)
+static constexpr uint8_t MAX_STEP_INDEX = 88;
+
+/**
+ * @brief Per-channel codec state, carried from block to block by the encoder
+ */
+struct State {
+    int16_t predictor;
+    uint8_t step_index;
+};
+
+/**
+ * @brief Frames carried by a payload of length bytes, 0 if malformed
+ */
+constexpr size_t frames(size_t length, uint8_t channels) {
+    return channels == 0 || length < HEADER_BYTES_PER_CHANNEL * channels
+        ? 0
+        : (length - HEADER_BYTES_PER_CHANNEL * channels) * 2 / channels;
+}
+
+/**
+ * @brief Payload bytes needed for frames frames (mono: frames must be even)
+ */
+constexpr size_t encodedSize(size_t frames, uint8_t channels) {
+    return HEADER_BYTES_PER_CHANNEL * channels + (frames * channels + 1) / 2;
+}
+
+/**
+ * @brief Decode one payload to interleaved 16-bit PCM
+ * 
+ * @param out Room for frames(length, channels) * channels samples
+ * @return Frames decoded, 0 for a malformed payload or more than 2 channels
+ */
+size_t decode(const uint8_t* in, size_t length, uint8_t channels, int16_t* out);
+
+/**
+ * @brief Encode interleaved 16-bit PCM to one payload
+ * 
+ * @param state One entry per channel, updated for the next block
+ * @param frames Mono input is truncated to an even frame count
+ * @return Payload bytes written (encodedSize())
+ */
+size_t encode(const int16_t* pcm, size_t frames, uint8_t channels, State* state, uint8_t* out);
+
+} // namespace ImaAdpcm
+} // namespace Audio
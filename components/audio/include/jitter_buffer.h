@@ -0,0 +1,177 @@
+/**
+ * @file jitter_buffer.h
+ * @brief Sequence-numbered audio jitter buffer
+ * 
+ * Platform independent so it can be exercised on the host
+ * (tools/jitter_sim.cpp).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "audio_packet.h"
+
+namespace Audio {
+
+/**
+ * @brief Reorders audio packets by sequence number and paces their release
+ * 
+ * The network side push()es packets as they arrive, in any order; the
+ * playback side pop()s exactly one packet per packet duration. Each packet
+ * lives in slot (seq % SLOTS), so reordering within the window costs no
+ * copies or searches. A packet that is missing when its turn comes is
+ * reported as lost so the caller can conceal it; if it shows up later it
+ * is dropped as late.
+ * 
+ * The target depth follows the measured interarrival jitter (RFC 3550
+ * estimator) and is raised whenever packets arrive late, then relaxes
+ * once they stop. Playback (re)starts once the target depth is buffered, and a
+ * backlog well above the target is trimmed one packet at a time to bound
+ * the added latency: pop() hands out the surplus packet as TRIM, and the
+ * caller plays it only as the start of a crossfade into the next one.
+ * 
+ * One producer task and one consumer task, no locks.
+ */
+class JitterBuffer {
+public:
+    static constexpr size_t SLOTS = 32;                 // Reorder window limit, power of two
+    static constexpr size_t MAX_PAYLOAD = 1456;         // 1472 byte datagram minus header
+    
+    struct Config {
+        uint32_t min_depth_ms;      // Lowest target depth
+        uint32_t max_depth_ms;      // Highest target depth (reorder window)
+        uint8_t jitter_multiplier;  // Target covers this many jitter estimates
+        uint8_t trim_margin;        // Packets above target before trimming
+    };
+    
+    enum class PopResult {
+        PACKET,       // Next packet copied out
+        TRIM,         // Next packet copied out, surplus: crossfade it into the one after, pop that now
+        LOST,         // Next packet is missing but later ones are here: conceal one packet
+        UNDERRUN,     // Ran dry while playing, now buffering again
+        BUFFERING,    // Waiting for the target depth
+    };
+    
+    struct Stats {
+        uint32_t received;          // Packets accepted into a slot
+        uint32_t late;              // Arrived after their playout turn
+        uint32_t duplicates;
+        uint32_t reordered;         // Arrived after a higher sequence number
+        uint32_t overflow;          // No free slot (beyond the window)
+        uint32_t resyncs;           // Sequence jumps treated as a new stream
+        uint32_t played;
+        uint32_t lost;              // Concealed gaps
+        uint32_t underruns;
+        uint32_t trimmed;           // Crossfaded away to shrink an oversized backlog
+        uint32_t rebuffers;         // Playback (re)starts
+        uint32_t jitter_us;         // Current interarrival jitter estimate
+        uint32_t target_packets;    // Current target depth
+        uint32_t depth_packets;     // Sequence span buffered now
+    };
+    
+    /**
+     * @brief Bytes of storage needed by attach()
+     */
+    static constexpr size_t storageSize() { return sizeof(Slot) * SLOTS; }
+    
+    JitterBuffer();
+    
+    JitterBuffer(const JitterBuffer&) = delete;
+    JitterBuffer& operator=(const JitterBuffer&) = delete;
+    
+    /**
+     * @brief Use caller-owned storage of storageSize() bytes (4-byte aligned)
+     */
+    bool attach(void* storage, const Config& config);
+    
+    /**
+     * @brief Producer: insert an arriving packet
+     * 
+     * @param arrival_us Arrival time, any monotonic microsecond clock
+     * @return false if the packet was dropped (late, duplicate, overflow,
+     *         unknown codec)
+     */
+    bool push(const PacketInfo& packet, int64_t arrival_us);
+    
+    /**
+     * @brief Consumer: take the packet due now
+     * 
+     * @param out        Receives the payload (MAX_PAYLOAD bytes)
+     * @param packet     For PACKET: its header fields, payload pointing at out
+     * @param force_start Start playback below the target depth (stream tail)
+     */
+    PopResult pop(uint8_t* out, PacketInfo& packet, bool force_start);
+    
+    /**
+     * @brief Sequence span currently buffered (either side, approximate)
+     */
+    uint32_t depth() const;
+    
+    /**
+     * @brief Current target depth in packets
+     */
+    uint32_t target() const { return m_target.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Duration of one packet as last seen by the producer
+     */
+    uint32_t packetUs() const { return m_packet_us.load(std::memory_order_relaxed); }
+    
+    bool isPlaying() const { return m_playing.load(std::memory_order_relaxed); }
+    Stats getStats() const;
+    
+private:
+    struct Slot {
+        std::atomic<uint32_t> state;    // 0 = empty, else FULL | seq
+        uint16_t length;
+        Codec codec;
+        uint8_t channels;
+        uint32_t sample_rate;
+        uint32_t timestamp;
+        uint8_t data[MAX_PAYLOAD];
+    };
+    
+    static constexpr uint32_t FULL = 0x10000;
+    static constexpr uint32_t RESYNC = 0x10000;
+    
+    void updateJitter(const PacketInfo& packet, int64_t arrival_us);
+    void updateTarget();
+    void applyResync(uint16_t seq);
+    
+    Slot* m_slots;
+    Config m_config;
+    
+    // Shared
+    std::atomic<uint16_t> m_next;           // Consumer: next sequence to play
+    std::atomic<uint16_t> m_highest;        // Producer: highest sequence accepted
+    std::atomic<uint32_t> m_resync;         // Producer -> consumer: RESYNC | new first seq
+    std::atomic<bool> m_synced;             // Consumer: m_next is valid
+    std::atomic<bool> m_playing;
+    std::atomic<uint32_t> m_target;         // Producer: target depth in packets
+    std::atomic<uint32_t> m_packet_us;
+    
+    // Producer only
+    bool m_have_transit;
+    int64_t m_last_transit_us;
+    int64_t m_jitter_q4;                    // Jitter estimate in us, 4 fractional bits
+    uint32_t m_late_boost;                  // Extra packets after late arrivals
+    uint32_t m_on_time;                     // Packets since the last late one
+    uint32_t m_received;
+    uint32_t m_late;
+    uint32_t m_duplicates;
+    uint32_t m_reordered;
+    uint32_t m_overflow;
+    uint32_t m_resyncs;
+    
+    // Consumer only
+    uint32_t m_played;
+    uint32_t m_lost;
+    uint32_t m_underruns;
+    uint32_t m_trimmed;
+    uint32_t m_rebuffers;
+    uint32_t m_over_target;                 // Consecutive pops above target + trim margin
+};
+
+} // namespace Audio
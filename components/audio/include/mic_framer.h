@@ -0,0 +1,165 @@
+/**
+ * @file mic_framer.h
+ * @brief Packetizing captured audio for the uplink
+ * 
+ * Platform independent so the capture path can be run on the host against
+ * a WAV file (tools/mic_sim.cpp).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "audio_packet.h"
+#include "capture_source.h"
+#include "vad.h"
+
+namespace Audio {
+
+/**
+ * @brief Destination for framed packets, written in place
+ * 
+ * acquire() lends the producer a packet buffer and commit() hands it over
+ * for sending, so captured samples are written once, straight into the
+ * buffer that goes out on the wire.
+ */
+class PacketSink {
+public:
+    virtual ~PacketSink() = default;
+    
+    /**
+     * @brief Size of every buffer acquire() returns
+     */
+    virtual size_t getCapacity() const = 0;
+    
+    /**
+     * @brief Producer: borrow a packet buffer, never blocks
+     * 
+     * @return nullptr when every buffer is queued or in flight; the same
+     *         buffer again if the last one was not committed
+     */
+    virtual uint8_t* acquire() = 0;
+    
+    /**
+     * @brief Producer: queue the acquired buffer
+     * 
+     * @param captured_at_us Start of the audio in it, for latency accounting
+     */
+    virtual void commit(size_t length, int64_t captured_at_us) = 0;
+};
+
+/**
+ * @brief Cuts a capture source into fixed-duration audio packets
+ * 
+ * Each captureFrame() reads one frame (frame_ms of audio) directly into a
+ * buffer acquired from the sink, behind room for the audio_packet.h
+ * header, then stamps the header and commits it. When the sink has no
+ * free buffer the frame is still read, to keep up with the source, and
+ * dropped; its sequence number and timestamp are skipped so the receiver
+ * sees the gap.
+ * 
+ * With a Vad attached, only talkspurts reach the sink. Between them frames
+ * go to a pre-roll ring holding the last preroll_ms of audio; at onset the
+ * ring is sent ahead of the speech, oldest first and as fast as the sink
+ * frees buffers, so the first syllable (heard before the detector was
+ * sure) is not lost. Until that backlog is gone new frames queue behind
+ * it; after that they are again written straight into sink buffers. Gated
+ * frames still use up sequence numbers and timestamps, so the receiver can
+ * tell how long the silence was.
+ */
+class MicFramer {
+public:
+    static constexpr uint8_t MAX_CHANNELS = 2;
+    static constexpr size_t MAX_FRAME_SAMPLES = 960;    // 20 ms stereo at 24 kHz
+    
+    struct Config {
+        uint32_t sample_rate;
+        uint8_t channels;               // Interleaved 16-bit samples
+        uint32_t frame_ms;              // Audio per packet
+        uint32_t preroll_ms;            // Audio sent ahead of an onset (VAD only)
+    };
+    
+    /**
+     * @brief Capture counters
+     */
+    struct Stats {
+        uint32_t frames;                // Frames handed to the sink
+        uint32_t dropped;               // Frames captured with no buffer to put them in
+        uint32_t gated;                 // Silent frames not sent (VAD)
+        uint32_t read_errors;           // Failed source reads
+        uint32_t overruns;              // Audio lost in the source (see CaptureSource)
+    };
+    
+    MicFramer();
+    
+    /**
+     * @brief Check the format and attach source, sink and optional gate
+     * 
+     * @param vad Configured detector, or nullptr to send every frame
+     * @return false if a frame would not fit MAX_FRAME_SAMPLES or a packet
+     *         the sink's buffers, or the pre-roll ring cannot be allocated
+     */
+    bool init(const Config& config, CaptureSource* source, PacketSink* sink, Vad* vad = nullptr);
+    
+    /**
+     * @brief Capture task: read, frame and commit one frame
+     * 
+     * Blocks in the source for up to frame_ms.
+     * 
+     * @param event Set to the detector's verdict on this frame, if given
+     * @return false if the source failed or ran out
+     */
+    bool captureFrame(Vad::Event* event = nullptr);
+    
+    /**
+     * @brief Inside a talkspurt (always true without a Vad)
+     */
+    bool isOpen() const { return !m_vad || m_open; }
+    
+    size_t getFrameFrames() const { return m_frame_frames; }
+    size_t getPacketSize() const { return PACKET_HEADER_SIZE + m_frame_frames * m_config.channels * sizeof(int16_t); }
+    Stats getStats() const;
+    
+private:
+    /**
+     * @brief A frame waiting in the pre-roll ring
+     */
+    struct Held {
+        uint16_t seq;
+        uint32_t timestamp;
+        int64_t captured_at_us;
+    };
+    
+    size_t frameSamples() const { return m_frame_frames * m_config.channels; }
+    int16_t* heldSamples(size_t index) const { return m_held_pcm.get() + index * frameSamples(); }
+    int16_t* holdFrame();
+    void dropOldestHeld();
+    void flushHeld();
+    void commitPacket(uint8_t* packet, uint16_t seq, uint32_t timestamp, int64_t captured_at_us);
+    
+    Config m_config;
+    CaptureSource* m_source;
+    PacketSink* m_sink;
+    size_t m_frame_frames;
+    Vad* m_vad;
+    bool m_open;                        // In a talkspurt
+    
+    // Pre-roll ring, capture task only. The oldest m_owed frames belong to
+    // a talkspurt and are still to be sent; the rest are pre-roll.
+    std::unique_ptr<int16_t[]> m_held_pcm;
+    std::unique_ptr<Held[]> m_held;
+    size_t m_held_capacity;
+    size_t m_preroll_frames;
+    size_t m_held_head;
+    size_t m_held_count;
+    size_t m_owed;
+    
+    uint16_t m_seq;
+    uint32_t m_timestamp;               // In frames
+    
+    Stats m_stats;
+    int16_t m_scratch[MAX_FRAME_SAMPLES];   // Target for frames that are dropped
+};
+
+} // namespace Audio
@@ -0,0 +1,129 @@
+/**
+ * @file mixer.h
+ * @brief Fixed-point mixing of the playback sources
+ * 
+ * Platform independent so the kernels can be benchmarked on the host
+ * (tools/mix_bench.cpp).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Audio {
+namespace Mix {
+
+static constexpr int32_t UNITY = 1 << 15;     // Gains are Q15, 0..UNITY
+
+/**
+ * @brief Multiply samples in place by a gain ramping linearly from..to
+ * 
+ * Saturates; a flat unity gain leaves the samples untouched.
+ */
+void scale(int16_t* samples, size_t frames, uint8_t channels, int32_t from, int32_t to);
+
+/**
+ * @brief Add src times a gain ramping from..to into dst, saturating
+ * 
+ * A mono source plays on every channel of dst.
+ */
+void mixInto(int16_t* dst, uint8_t dst_channels, const int16_t* src, uint8_t src_channels,
+             size_t frames, int32_t from, int32_t to);
+
+/**
+ * @brief Q15 gain for an attenuation in dB (0 or below)
+ */
+int32_t dbToGain(int32_t db);
+
+} // namespace Mix
+
+/**
+ * @brief Per-source gain, ducking and master volume for the output
+ * 
+ * The player calls beginChunk() once per output chunk, then scale() the
+ * stream in place and add() every other source that plays into it. Each
+ * source's gain is its trim times the master volume, times the duck level
+ * for the stream; it ramps linearly across the chunk from the previous
+ * chunk's value, so volume steps and ducking never click.
+ * 
+ * The volume may be changed from any task; everything else belongs to the
+ * playback task.
+ */
+class Mixer {
+public:
+    enum class Source : uint8_t {
+        STREAM,         // Network audio, ducked under the others
+        EARCON,         // Clips from flash
+        TONE,           // Locally generated beeps
+        COUNT
+    };
+    
+    static constexpr size_t SOURCE_COUNT = static_cast<size_t>(Source::COUNT);
+    static constexpr uint8_t MAX_VOLUME_STEPS = 32;
+    
+    struct Config {
+        uint32_t sample_rate;
+        uint8_t channels;
+        int8_t gain_db[SOURCE_COUNT];   // Trim per source, 0 or below
+        int8_t duck_db;                 // Stream level while a prompt or tone plays
+        uint16_t duck_attack_ms;        // Time to reach duck_db
+        uint16_t duck_release_ms;       // Time back to full level
+        uint8_t volume_steps;           // Top step is 0 dB, step 0 mutes
+        uint8_t volume_step_db;         // Attenuation per step below the top
+        uint8_t volume;                 // Initial step
+    };
+    
+    Mixer();
+    
+    bool configure(const Config& config);
+    
+    /**
+     * @brief Set the master volume step (any task), clamped to the range
+     * 
+     * @return The step now in effect
+     */
+    uint8_t setVolume(int step);
+    
+    /**
+     * @brief Move the master volume up or down by delta steps (any task)
+     */
+    uint8_t stepVolume(int delta);
+    
+    uint8_t getVolume() const { return m_volume.load(std::memory_order_relaxed); }
+    uint8_t getVolumeSteps() const { return m_config.volume_steps; }
+    
+    /**
+     * @brief Start a chunk: advance ducking and the gain ramps
+     * 
+     * @param duck Whether a prompt or tone plays in this chunk
+     */
+    void beginChunk(size_t frames, bool duck);
+    
+    /**
+     * @brief Apply a source's gain to the whole chunk in place
+     */
+    void scale(Source source, int16_t* chunk);
+    
+    /**
+     * @brief Mix frames of a source into the chunk, starting offset frames in
+     */
+    void add(Source source, int16_t* chunk, size_t offset,
+             const int16_t* samples, size_t frames, uint8_t channels);
+    
+private:
+    int32_t gainAt(size_t source, size_t offset) const;
+    
+    Config m_config;
+    std::atomic<uint8_t> m_volume;
+    int32_t m_volume_gain[MAX_VOLUME_STEPS + 1];
+    int32_t m_trim[SOURCE_COUNT];
+    int32_t m_duck_floor;
+    int32_t m_duck;
+    size_t m_chunk_frames;
+    int32_t m_from[SOURCE_COUNT];
+    int32_t m_to[SOURCE_COUNT];
+};
+
+} // namespace Audio
@@ -0,0 +1,97 @@
+/**
+ * @file resampler.h
+ * @brief Streaming sample-rate conversion with fine rate trimming
+ * 
+ * Platform independent so it can be measured on the host
+ * (tools/resample_bench.cpp).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Audio {
+
+/**
+ * @brief Polyphase windowed-sinc resampler, 16-bit interleaved in and out
+ * 
+ * Converts any input rate up to MAX_RATIO times the output rate to the
+ * output rate, and mono to stereo on the way. The read position advances
+ * in 32.32 fixed point, so the ratio can be trimmed by a few ppm at a time
+ * (setTrimPpm()) to follow a drifting source clock without a glitch.
+ * 
+ * Each output sample is the dot product of TAPS input samples with the
+ * two filter phases around the read position, interpolated between them.
+ * The filter is a Kaiser-windowed sinc cut off below the lower of the two
+ * Nyquist rates; at equal rates it is a pure fractional delay, and with no
+ * trim and the read position on a sample, samples are copied through.
+ * 
+ * The output lags the input by TAPS / 2 input frames.
+ */
+class Resampler {
+public:
+    static constexpr size_t TAPS = 24;
+    static constexpr size_t PHASES = 64;
+    static constexpr uint8_t MAX_CHANNELS = 2;
+    static constexpr uint32_t MAX_RATIO = 2;        // Input rate at most this times the output rate
+    static constexpr int32_t MAX_TRIM_PPM = 10000;
+    
+    Resampler();
+    
+    /**
+     * @brief Design the filter for a rate pair and clear the history
+     * 
+     * @return false for a zero rate, an unsupported ratio or channel
+     *         count, or out_channels below in_channels
+     */
+    bool configure(uint32_t in_rate, uint32_t out_rate, uint8_t in_channels, uint8_t out_channels);
+    
+    /**
+     * @brief Forget buffered input, e.g. after the source ran dry
+     */
+    void reset();
+    
+    /**
+     * @brief Consume input faster (positive) or slower than nominal, in ppm
+     */
+    void setTrimPpm(int32_t ppm);
+    int32_t getTrimPpm() const { return m_trim_ppm; }
+    
+    /**
+     * @brief Convert as much as fits
+     * 
+     * Stops when out_frames are written or the input is used up, whichever
+     * comes first; input that is not consumed must be offered again.
+     * 
+     * @param consumed Input frames taken
+     * @return Output frames written
+     */
+    size_t process(const int16_t* in, size_t in_frames, size_t& consumed,
+                   int16_t* out, size_t out_frames);
+    
+    uint32_t getInputRate() const { return m_in_rate; }
+    uint8_t getInputChannels() const { return m_in_channels; }
+    
+private:
+    static constexpr size_t BLOCK_FRAMES = 64;      // Input staged per refill
+    static constexpr size_t BUFFER_FRAMES = TAPS + BLOCK_FRAMES;
+    static constexpr uint64_t ONE = 1ULL << 32;
+    
+    void design(double cutoff);
+    void updateStep();
+    size_t refill(const int16_t* in, size_t in_frames);
+    
+    uint32_t m_in_rate;
+    uint32_t m_out_rate;
+    uint8_t m_in_channels;
+    uint8_t m_out_channels;
+    int32_t m_trim_ppm;
+    uint64_t m_step;                                // Input frames per output frame, 32.32
+    uint64_t m_pos;                                 // Read position in m_buffer, 32.32
+    size_t m_fill;                                  // Frames in m_buffer
+    int16_t m_coef[(PHASES + 1) * TAPS];            // Q14, one row per phase
+    int16_t m_buffer[BUFFER_FRAMES * MAX_CHANNELS];
+};
+
+} // namespace Audio
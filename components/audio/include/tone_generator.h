@@ -0,0 +1,54 @@
+/**
+ * @file tone_generator.h
+ * @brief Locally synthesized beeps
+ * 
+ * Platform independent so it can run in the host mixer benchmark
+ * (tools/mix_bench.cpp).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Audio {
+
+/**
+ * @brief Mono sine tone with a short linear attack and release
+ * 
+ * A table-driven phase accumulator: no floating point per sample. The
+ * edges keep tones from clicking when they start and stop over silence.
+ */
+class ToneGenerator {
+public:
+    static constexpr int16_t AMPLITUDE = 16384;     // -6 dBFS, trimmed further by the mixer
+    static constexpr uint32_t EDGE_MS = 5;
+    
+    ToneGenerator();
+    
+    /**
+     * @brief Start a tone, replacing any that plays
+     * 
+     * @return false if the frequency is not below Nyquist
+     */
+    bool start(uint16_t frequency_hz, uint16_t duration_ms, uint32_t sample_rate);
+    
+    void stop() { m_remaining = 0; }
+    bool isActive() const { return m_remaining > 0; }
+    
+    /**
+     * @brief Render up to frames mono samples
+     * 
+     * @return Frames rendered, fewer than asked once the tone ends
+     */
+    size_t render(int16_t* out, size_t frames);
+    
+private:
+    uint32_t m_phase;
+    uint32_t m_increment;
+    uint32_t m_total;           // Frames in the tone
+    uint32_t m_remaining;
+    uint32_t m_edge;            // Frames of attack and of release
+};
+
+} // namespace Audio
@@ -0,0 +1,104 @@
+/**
+ * @file vad.h
+ * @brief Fixed-point voice activity detection
+ * 
+ * Platform independent so it can be benchmarked on the host
+ * (tools/vad_bench.cpp).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Audio {
+
+/**
+ * @brief Energy and zero-crossing voice activity detector
+ * 
+ * Each frame is reduced to its mean-square level (log2, Q8, so one unit is
+ * 3.01/256 dB) and its zero-crossing rate. The level is compared with a
+ * tracked noise floor that drops at once to quieter frames, rises over
+ * about half a second in silence and only creeps up during speech, so a
+ * steady fan or hum is absorbed while speech is not.
+ * 
+ * A frame counts as speech when it is above min_level_dbfs and either
+ * threshold_db over the floor with a voiced zero-crossing rate (at most
+ * max_zcr_permille), or twice threshold_db over it whatever its rate
+ * (loud fricatives and plosives). onset_frames speech frames in a row
+ * start a talkspurt; hangover_frames non-speech frames in a row end it.
+ * 
+ * Integer only: one multiply-accumulate per sample plus a handful of
+ * operations per frame.
+ */
+class Vad {
+public:
+    struct Config {
+        uint8_t threshold_db;           // Level over the noise floor for speech
+        int8_t min_level_dbfs;          // Quieter frames are never speech
+        uint16_t max_zcr_permille;      // Crossings per 1000 samples for voiced speech
+        uint8_t onset_frames;           // Speech frames in a row to start
+        uint16_t hangover_frames;       // Non-speech frames in a row to stop
+    };
+    
+    enum class Event : uint8_t {
+        NONE,
+        ONSET,      // This frame starts a talkspurt
+        OFFSET,     // This frame ends one (it is still part of it)
+    };
+    
+    /**
+     * @brief Detector counters and the last frame's analysis
+     */
+    struct Stats {
+        uint32_t frames;
+        uint32_t speech_frames;         // Frames inside talkspurts
+        uint32_t onsets;
+        uint64_t cycles;                // CPU cycles in process(), device only
+        int16_t level_dbfs;             // Last frame
+        int16_t floor_dbfs;
+        uint16_t zcr_permille;
+    };
+    
+    Vad();
+    
+    void configure(const Config& config);
+    
+    /**
+     * @brief Forget the noise floor and any talkspurt in progress
+     */
+    void reset();
+    
+    /**
+     * @brief Classify one frame of interleaved 16-bit PCM
+     * 
+     * Only the first channel is analysed.
+     */
+    Event process(const int16_t* pcm, size_t frames, uint8_t channels);
+    
+    bool isActive() const { return m_active; }
+    const Stats& getStats() const { return m_stats; }
+    
+    /**
+     * @brief log2 of x in Q8, 0 for x == 0
+     * 
+     * Linear interpolation between powers of two, at most 0.09 (0.26 dB)
+     * below the exact value.
+     */
+    static int32_t log2Q8(uint32_t x);
+    
+private:
+    Config m_config;
+    int32_t m_threshold_q8;
+    int32_t m_min_level_q8;
+    
+    bool m_active;
+    bool m_has_floor;
+    int32_t m_floor_q8;
+    uint8_t m_speech_run;
+    uint16_t m_silence_run;
+    
+    Stats m_stats;
+};
+
+} // namespace Audio
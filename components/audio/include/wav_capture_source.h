@@ -0,0 +1,56 @@
+/**
+ * @file wav_capture_source.h
+ * @brief WAV file as a capture source, for host runs
+ */
+
+#pragma once
+
+#include <cstdio>
+#include "capture_source.h"
+
+namespace Audio {
+
+/**
+ * @brief Plays a 16-bit PCM WAV file into the capture path
+ * 
+ * With realtime set, read() blocks for as long as the audio it returns
+ * lasts and timestamps are on the monotonic clock (CLOCK_MONOTONIC, the
+ * clock esp_timer_get_time() uses on the linux target), like a microphone.
+ * Without it, read() returns immediately and timestamps are the file
+ * position in microseconds, for simulations that keep their own clock.
+ */
+class WavCaptureSource : public CaptureSource {
+public:
+    WavCaptureSource();
+    ~WavCaptureSource() override;
+    
+    WavCaptureSource(const WavCaptureSource&) = delete;
+    WavCaptureSource& operator=(const WavCaptureSource&) = delete;
+    
+    /**
+     * @brief Open path and locate its sample data
+     * 
+     * @return false if the file is missing or not 16-bit PCM
+     */
+    bool open(const char* path, bool realtime);
+    
+    uint32_t getSampleRate() const { return m_sample_rate; }
+    uint8_t getChannels() const { return m_channels; }
+    
+    bool start() override;
+    void stop() override;
+    bool read(int16_t* out, size_t frames, int64_t& captured_at_us) override;
+    
+private:
+    static int64_t monotonicUs();
+    
+    FILE* m_file;
+    bool m_realtime;
+    uint32_t m_sample_rate;
+    uint8_t m_channels;
+    uint32_t m_frames_left;
+    uint64_t m_position;            // Frames read since start()
+    int64_t m_started_us;
+};
+
+} // namespace Audio
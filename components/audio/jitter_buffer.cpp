@@ -0,0 +1,323 @@
+/**
+ * @file jitter_buffer.cpp
+ * @brief Sequence-numbered audio jitter buffer implementation
+ */
+
+#include "jitter_buffer.h"
+#include <cstring>
+#include <new>
+
+namespace Audio {
+
+// Packets without a late arrival before one step of late boost is released.
+// Kept short: spikes on a busy link come every second or two, and a boost
+// that outlived them would ratchet the target up to cover every spike.
+static constexpr uint32_t LATE_BOOST_DECAY_PACKETS = 50;
+
+// Late arrivals closer together than this are one delay spike and raise
+// the target by a single step
+static constexpr uint32_t LATE_BOOST_SPACING_PACKETS = 100;
+
+// Consecutive packets played above target + trim margin before one is
+// crossfaded away; keeps short bursts from being trimmed
+static constexpr uint32_t TRIM_HOLD_PACKETS = 25;
+
+JitterBuffer::JitterBuffer()
+    : m_slots(nullptr)
+    , m_config{}
+    , m_next(0)
+    , m_highest(0)
+    , m_resync(0)
+    , m_synced(false)
+    , m_playing(false)
+    , m_target(1)
+    , m_packet_us(0)
+    , m_have_transit(false)
+    , m_last_transit_us(0)
+    , m_jitter_q4(0)
+    , m_late_boost(0)
+    , m_on_time(0)
+    , m_received(0)
+    , m_late(0)
+    , m_duplicates(0)
+    , m_reordered(0)
+    , m_overflow(0)
+    , m_resyncs(0)
+    , m_played(0)
+    , m_lost(0)
+    , m_underruns(0)
+    , m_trimmed(0)
+    , m_rebuffers(0)
+    , m_over_target(0) {
+}
+
+bool JitterBuffer::attach(void* storage, const Config& config) {
+    if (!storage || (reinterpret_cast<uintptr_t>(storage) & 3) != 0) {
+        return false;
+    }
+    
+    m_slots = static_cast<Slot*>(storage);
+    for (size_t i = 0; i < SLOTS; i++) {
+        new (&m_slots[i]) Slot();
+        m_slots[i].state.store(0, std::memory_order_relaxed);
+        m_slots[i].length = 0;
+        m_slots[i].codec = Codec::PCM16;
+        m_slots[i].channels = 0;
+        m_slots[i].sample_rate = 0;
+        m_slots[i].timestamp = 0;
+    }
+    
+    m_config = config;
+    if (m_config.jitter_multiplier == 0) {
+        m_config.jitter_multiplier = 1;
+    }
+    m_synced.store(false, std::memory_order_relaxed);
+    m_playing.store(false, std::memory_order_relaxed);
+    m_resync.store(0, std::memory_order_relaxed);
+    m_have_transit = false;
+    return true;
+}
+
+bool JitterBuffer::push(const PacketInfo& packet, int64_t arrival_us) {
+    uint32_t frames = packetFrames(packet);
+    if (frames == 0 || packet.payload_len > MAX_PAYLOAD || packet.sample_rate == 0) {
+        m_overflow++;
+        return false;
+    }
+    
+    m_packet_us.store((uint32_t)((uint64_t)frames * 1000000 / packet.sample_rate),
+                      std::memory_order_relaxed);
+    
+    // Where is the consumer? A pending resync counts as already applied
+    uint32_t pending = m_resync.load(std::memory_order_acquire);
+    bool synced = pending != 0 || m_synced.load(std::memory_order_acquire);
+    uint16_t next = pending != 0 ? (uint16_t)pending : m_next.load(std::memory_order_acquire);
+    int16_t ahead = (int16_t)(packet.seq - next);
+    
+    if (!synced || ahead >= (int16_t)SLOTS || ahead < -(int16_t)SLOTS) {
+        // First packet, or a jump no reordering explains: a new stream
+        m_highest.store(packet.seq, std::memory_order_relaxed);
+        m_resync.store(RESYNC | packet.seq, std::memory_order_release);
+        m_have_transit = false;
+        if (synced) {
+            m_resyncs++;
+        }
+    } else if (ahead < 0) {
+        // Its turn has passed and it was concealed; more depth would have saved it
+        m_late++;
+        bool new_spike = m_late_boost == 0 || m_on_time >= LATE_BOOST_SPACING_PACKETS;
+        m_on_time = 0;
+        if (new_spike && m_late_boost < SLOTS) {
+            m_late_boost++;
+        }
+        updateTarget();
+        return false;
+    }
+    
+    Slot& slot = m_slots[packet.seq & (SLOTS - 1)];
+    uint32_t state = slot.state.load(std::memory_order_acquire);
+    if (state == (FULL | packet.seq)) {
+        m_duplicates++;
+        return false;
+    }
+    if (state != 0) {
+        m_overflow++;
+        return false;
+    }
+    
+    memcpy(slot.data, packet.payload, packet.payload_len);
+    slot.length = (uint16_t)packet.payload_len;
+    slot.codec = packet.codec;
+    slot.channels = packet.channels;
+    slot.sample_rate = packet.sample_rate;
+    slot.timestamp = packet.timestamp;
+    slot.state.store(FULL | packet.seq, std::memory_order_release);
+    
+    uint16_t highest = m_highest.load(std::memory_order_relaxed);
+    if ((int16_t)(packet.seq - highest) > 0) {
+        m_highest.store(packet.seq, std::memory_order_release);
+    } else if (packet.seq != highest) {
+        m_reordered++;
+    }
+    
+    m_received++;
+    if (++m_on_time >= LATE_BOOST_DECAY_PACKETS && m_late_boost > 0) {
+        m_late_boost--;
+        m_on_time = 0;
+    }
+    
+    updateJitter(packet, arrival_us);
+    updateTarget();
+    return true;
+}
+
+void JitterBuffer::updateJitter(const PacketInfo& packet, int64_t arrival_us) {
+    // RFC 3550 interarrival jitter: J += (|D| - J) / 16, where D is the
+    // change in transit time between consecutive arrivals
+    int64_t media_us = (int64_t)packet.timestamp * 1000000 / packet.sample_rate;
+    int64_t transit = arrival_us - media_us;
+    
+    if (m_have_transit) {
+        int64_t d = transit - m_last_transit_us;
+        if (d < 0) {
+            d = -d;
+        }
+        // Timestamp wrap shows up as a jump of hours; ignore that sample
+        if (d < 1000000) {
+            m_jitter_q4 += d - ((m_jitter_q4 + 8) >> 4);
+        }
+    }
+    m_last_transit_us = transit;
+    m_have_transit = true;
+}
+
+void JitterBuffer::updateTarget() {
+    uint32_t packet_us = m_packet_us.load(std::memory_order_relaxed);
+    if (packet_us == 0) {
+        return;
+    }
+    
+    uint32_t min_packets = (m_config.min_depth_ms * 1000 + packet_us - 1) / packet_us;
+    uint32_t max_packets = m_config.max_depth_ms * 1000 / packet_us;
+    uint32_t limit = SLOTS - m_config.trim_margin - 1;
+    if (max_packets > limit) {
+        max_packets = limit;
+    }
+    if (min_packets < 1) {
+        min_packets = 1;
+    }
+    if (min_packets > max_packets) {
+        min_packets = max_packets;
+    }
+    
+    uint64_t jitter_us = (uint64_t)(m_jitter_q4 >> 4) * m_config.jitter_multiplier;
+    uint32_t target = (uint32_t)((jitter_us + packet_us - 1) / packet_us);
+    if (target < min_packets) {
+        target = min_packets;
+    }
+    target += m_late_boost;
+    if (target > max_packets) {
+        target = max_packets;
+    }
+    m_target.store(target, std::memory_order_relaxed);
+}
+
+void JitterBuffer::applyResync(uint16_t seq) {
+    // Drop whatever is left of the old stream, keep what already arrived
+    // of the new one
+    for (size_t i = 0; i < SLOTS; i++) {
+        uint32_t state = m_slots[i].state.load(std::memory_order_acquire);
+        if (state == 0) {
+            continue;
+        }
+        int16_t offset = (int16_t)((uint16_t)state - seq);
+        if (offset < 0 || offset >= (int16_t)SLOTS) {
+            m_slots[i].state.store(0, std::memory_order_release);
+        }
+    }
+    
+    m_next.store(seq, std::memory_order_release);
+    m_synced.store(true, std::memory_order_release);
+    m_playing.store(false, std::memory_order_relaxed);
+}
+
+uint32_t JitterBuffer::depth() const {
+    if (!m_synced.load(std::memory_order_acquire)) {
+        return 0;
+    }
+    int16_t span = (int16_t)(m_highest.load(std::memory_order_acquire) -
+                             m_next.load(std::memory_order_acquire)) + 1;
+    return span > 0 ? (uint32_t)span : 0;
+}
+
+JitterBuffer::PopResult JitterBuffer::pop(uint8_t* out, PacketInfo& packet, bool force_start) {
+    uint32_t pending = m_resync.exchange(0, std::memory_order_acq_rel);
+    if (pending != 0) {
+        applyResync((uint16_t)pending);
+    }
+    if (!m_synced.load(std::memory_order_relaxed)) {
+        return PopResult::BUFFERING;
+    }
+    
+    uint32_t span = depth();
+    if (!m_playing.load(std::memory_order_relaxed)) {
+        uint32_t target = m_target.load(std::memory_order_relaxed);
+        if (span == 0 || (span < target && !force_start)) {
+            return PopResult::BUFFERING;
+        }
+        m_playing.store(true, std::memory_order_relaxed);
+        m_rebuffers++;
+    }
+    
+    uint16_t next = m_next.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[next & (SLOTS - 1)];
+    uint32_t state = slot.state.load(std::memory_order_acquire);
+    
+    if (state == (FULL | next)) {
+        packet.seq = next;
+        packet.timestamp = slot.timestamp;
+        packet.codec = slot.codec;
+        packet.channels = slot.channels;
+        packet.sample_rate = slot.sample_rate;
+        packet.payload = out;
+        packet.payload_len = slot.length;
+        memcpy(out, slot.data, slot.length);
+        slot.state.store(0, std::memory_order_release);
+        m_next.store(next + 1, std::memory_order_release);
+        m_played++;
+        
+        // Jitter has calmed down since the backlog built up: give the
+        // latency back one packet at a time. The caller crossfades this
+        // packet into the next one, so that one must already be here.
+        uint32_t target = m_target.load(std::memory_order_relaxed);
+        if (depth() <= target + m_config.trim_margin) {
+            m_over_target = 0;
+        } else if (++m_over_target >= TRIM_HOLD_PACKETS) {
+            uint16_t following = next + 1;
+            Slot& after = m_slots[following & (SLOTS - 1)];
+            if (after.state.load(std::memory_order_acquire) == (FULL | following)) {
+                m_trimmed++;
+                m_over_target = 0;
+                return PopResult::TRIM;
+            }
+        }
+        return PopResult::PACKET;
+    }
+    
+    if (state != 0) {
+        // Stale packet from a wrapped window, stored after its turn
+        slot.state.store(0, std::memory_order_release);
+    }
+    
+    if (span > 0) {
+        m_next.store(next + 1, std::memory_order_release);
+        m_lost++;
+        return PopResult::LOST;
+    }
+    
+    m_playing.store(false, std::memory_order_relaxed);
+    m_over_target = 0;
+    m_underruns++;
+    return PopResult::UNDERRUN;
+}
+
+JitterBuffer::Stats JitterBuffer::getStats() const {
+    Stats stats;
+    stats.received = m_received;
+    stats.late = m_late;
+    stats.duplicates = m_duplicates;
+    stats.reordered = m_reordered;
+    stats.overflow = m_overflow;
+    stats.resyncs = m_resyncs;
+    stats.played = m_played;
+    stats.lost = m_lost;
+    stats.underruns = m_underruns;
+    stats.trimmed = m_trimmed;
+    stats.rebuffers = m_rebuffers;
+    stats.jitter_us = (uint32_t)(m_jitter_q4 >> 4);
+    stats.target_packets = m_target.load(std::memory_order_relaxed);
+    stats.depth_packets = depth();
+    return stats;
+}
+
+} // namespace Audio
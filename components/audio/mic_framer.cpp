@@ -0,0 +1,187 @@
+/**
+ * @file mic_framer.cpp
+ * @brief Packetizing captured audio for the uplink
+ */
+
+#include "mic_framer.h"
+#include <cstring>
+#include <new>
+
+namespace Audio {
+
+MicFramer::MicFramer()
+    : m_config{}
+    , m_source(nullptr)
+    , m_sink(nullptr)
+    , m_frame_frames(0)
+    , m_vad(nullptr)
+    , m_open(false)
+    , m_held_capacity(0)
+    , m_preroll_frames(0)
+    , m_held_head(0)
+    , m_held_count(0)
+    , m_owed(0)
+    , m_seq(0)
+    , m_timestamp(0)
+    , m_stats{}
+    , m_scratch{} {
+}
+
+bool MicFramer::init(const Config& config, CaptureSource* source, PacketSink* sink, Vad* vad) {
+    if (!source || !sink || config.channels == 0 || config.channels > MAX_CHANNELS) {
+        return false;
+    }
+
+    size_t frames = (size_t)config.sample_rate * config.frame_ms / 1000;
+    if (frames == 0 || frames * config.channels > MAX_FRAME_SAMPLES ||
+        PACKET_HEADER_SIZE + frames * config.channels * sizeof(int16_t) > sink->getCapacity()) {
+        return false;
+    }
+
+    m_config = config;
+    m_source = source;
+    m_sink = sink;
+    m_frame_frames = frames;
+    m_vad = vad;
+    m_open = false;
+    m_held_head = 0;
+    m_held_count = 0;
+    m_owed = 0;
+
+    if (vad) {
+        // The pre-roll, plus as many frames again to queue behind it while
+        // it drains after an onset
+        m_preroll_frames = (config.preroll_ms + config.frame_ms - 1) / config.frame_ms;
+        m_held_capacity = 2 * (m_preroll_frames + 1);
+        m_held_pcm.reset(new (std::nothrow) int16_t[m_held_capacity * frameSamples()]);
+        m_held.reset(new (std::nothrow) Held[m_held_capacity]);
+        if (!m_held_pcm || !m_held) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MicFramer::commitPacket(uint8_t* packet, uint16_t seq, uint32_t timestamp, int64_t captured_at_us) {
+    PacketInfo info = {
+        .seq = seq,
+        .timestamp = timestamp,
+        .codec = Codec::PCM16,
+        .channels = m_config.channels,
+        .sample_rate = m_config.sample_rate,
+        .payload = nullptr,
+        .payload_len = 0
+    };
+    writePacketHeader(packet, info);
+    m_sink->commit(getPacketSize(), captured_at_us);
+    m_stats.frames++;
+}
+
+void MicFramer::dropOldestHeld() {
+    if (m_owed > 0) {
+        m_owed--;
+        m_stats.dropped++;
+    } else {
+        m_stats.gated++;
+    }
+    m_held_head = (m_held_head + 1) % m_held_capacity;
+    m_held_count--;
+}
+
+int16_t* MicFramer::holdFrame() {
+    // Between talkspurts keep only the pre-roll; during one, only a full
+    // ring costs frames
+    while (m_held_count == m_held_capacity ||
+           (m_owed == 0 && !m_open && m_held_count > m_preroll_frames)) {
+        dropOldestHeld();
+    }
+    size_t index = (m_held_head + m_held_count) % m_held_capacity;
+    m_held_count++;
+    return heldSamples(index);
+}
+
+void MicFramer::flushHeld() {
+    size_t bytes = frameSamples() * sizeof(int16_t);
+    while (m_owed > 0) {
+        uint8_t* packet = m_sink->acquire();
+        if (!packet) {
+            break;
+        }
+        const Held& held = m_held[m_held_head];
+        memcpy(packet + PACKET_HEADER_SIZE, heldSamples(m_held_head), bytes);
+        commitPacket(packet, held.seq, held.timestamp, held.captured_at_us);
+        m_held_head = (m_held_head + 1) % m_held_capacity;
+        m_held_count--;
+        m_owed--;
+    }
+}
+
+bool MicFramer::captureFrame(Vad::Event* event) {
+    if (event) {
+        *event = Vad::Event::NONE;
+    }
+
+    // In a talkspurt with nothing queued: straight into a sink buffer.
+    // PACKET_HEADER_SIZE keeps the samples 16-bit aligned in it.
+    bool direct = !m_vad || (m_open && m_owed == 0);
+    uint8_t* packet = direct ? m_sink->acquire() : nullptr;
+    int16_t* samples = !direct
+        ? holdFrame()
+        : packet ? reinterpret_cast<int16_t*>(packet + PACKET_HEADER_SIZE) : m_scratch;
+
+    int64_t captured_at_us = 0;
+    if (!m_source->read(samples, m_frame_frames, captured_at_us)) {
+        if (!direct) {
+            m_held_count--;
+        }
+        m_stats.read_errors++;
+        return false;
+    }
+
+    uint16_t seq = m_seq++;
+    uint32_t timestamp = m_timestamp;
+    m_timestamp += (uint32_t)m_frame_frames;
+
+    Vad::Event vad_event = m_vad
+        ? m_vad->process(samples, m_frame_frames, m_config.channels)
+        : Vad::Event::NONE;
+    if (event) {
+        *event = vad_event;
+    }
+
+    if (direct) {
+        if (packet) {
+            commitPacket(packet, seq, timestamp, captured_at_us);
+        } else {
+            m_stats.dropped++;
+        }
+    } else {
+        size_t index = (m_held_head + m_held_count - 1) % m_held_capacity;
+        m_held[index] = {seq, timestamp, captured_at_us};
+        if (vad_event == Vad::Event::ONSET) {
+            // Everything held is pre-roll or audio since the last talkspurt
+            m_owed = m_held_count;
+        } else if (m_open) {
+            m_owed++;
+        }
+    }
+
+    if (vad_event == Vad::Event::ONSET) {
+        m_open = true;
+    } else if (vad_event == Vad::Event::OFFSET) {
+        m_open = false;
+    }
+
+    if (m_owed > 0) {
+        flushHeld();
+    }
+    return true;
+}
+
+MicFramer::Stats MicFramer::getStats() const {
+    Stats stats = m_stats;
+    stats.overruns = m_source ? m_source->getOverruns() : 0;
+    return stats;
+}
+
+} // namespace Audio
@@ -0,0 +1,215 @@
+/**
+ * @file mixer.cpp
+ * @brief Fixed-point mixing implementation
+ */
+
+#include "mixer.h"
+#include <cmath>
+
+namespace Audio {
+namespace Mix {
+
+namespace {
+
+// Written as a compare pair so GCC emits a single CLAMPS on the ESP32
+inline int32_t saturate16(int32_t value) {
+    return value > 32767 ? 32767 : value < -32768 ? -32768 : value;
+}
+
+inline int32_t applyGain(int32_t sample, int32_t gain) {
+    return (sample * gain + (1 << 14)) >> 15;
+}
+
+/**
+ * Linear gain ramp in Q23 so the per-frame step keeps its precision over
+ * a few hundred frames
+ */
+struct Ramp {
+    int32_t gain;
+    int32_t step;
+    
+    Ramp(int32_t from, int32_t to, size_t frames)
+        : gain(from * 256)
+        , step(frames > 0 ? (to - from) * 256 / (int32_t)frames : 0) {
+    }
+    
+    inline int32_t next() {
+        int32_t current = gain >> 8;
+        gain += step;
+        return current;
+    }
+};
+
+} // namespace
+
+void scale(int16_t* samples, size_t frames, uint8_t channels, int32_t from, int32_t to) {
+    size_t count = frames * channels;
+    if (from == to) {
+        if (from == UNITY) {
+            return;
+        }
+        for (size_t i = 0; i < count; i++) {
+            samples[i] = (int16_t)saturate16(applyGain(samples[i], from));
+        }
+        return;
+    }
+    
+    Ramp ramp(from, to, frames);
+    if (channels == 2) {
+        for (size_t i = 0; i < count; i += 2) {
+            int32_t gain = ramp.next();
+            samples[i] = (int16_t)saturate16(applyGain(samples[i], gain));
+            samples[i + 1] = (int16_t)saturate16(applyGain(samples[i + 1], gain));
+        }
+    } else {
+        for (size_t i = 0; i < frames; i++) {
+            int32_t gain = ramp.next();
+            for (uint8_t c = 0; c < channels; c++) {
+                samples[i * channels + c] = (int16_t)saturate16(applyGain(samples[i * channels + c], gain));
+            }
+        }
+    }
+}
+
+void mixInto(int16_t* dst, uint8_t dst_channels, const int16_t* src, uint8_t src_channels,
+             size_t frames, int32_t from, int32_t to) {
+    if (from == 0 && to == 0) {
+        return;
+    }
+    
+    // The common cases get their own loops: no gain, and mono into stereo
+    if (from == UNITY && to == UNITY && src_channels == dst_channels) {
+        size_t count = frames * dst_channels;
+        for (size_t i = 0; i < count; i++) {
+            dst[i] = (int16_t)saturate16((int32_t)dst[i] + src[i]);
+        }
+        return;
+    }
+    
+    Ramp ramp(from, to, frames);
+    if (src_channels == 1 && dst_channels == 2) {
+        for (size_t i = 0; i < frames; i++) {
+            int32_t sample = applyGain(src[i], ramp.next());
+            dst[2 * i] = (int16_t)saturate16(dst[2 * i] + sample);
+            dst[2 * i + 1] = (int16_t)saturate16(dst[2 * i + 1] + sample);
+        }
+        return;
+    }
+    
+    for (size_t i = 0; i < frames; i++) {
+        int32_t gain = ramp.next();
+        for (uint8_t c = 0; c < dst_channels; c++) {
+            int32_t sample = src[i * src_channels + (c < src_channels ? c : 0)];
+            int16_t& out = dst[i * dst_channels + c];
+            out = (int16_t)saturate16(out + applyGain(sample, gain));
+        }
+    }
+}
+
+int32_t dbToGain(int32_t db) {
+    if (db >= 0) {
+        return UNITY;
+    }
+    return (int32_t)lroundf(UNITY * powf(10.0f, (float)db / 20.0f));
+}
+
+} // namespace Mix
+
+Mixer::Mixer()
+    : m_config{}
+    , m_volume(0)
+    , m_volume_gain{}
+    , m_trim{}
+    , m_duck_floor(Mix::UNITY)
+    , m_duck(Mix::UNITY)
+    , m_chunk_frames(0)
+    , m_from{}
+    , m_to{} {
+}
+
+bool Mixer::configure(const Config& config) {
+    if (config.channels == 0 || config.sample_rate == 0 ||
+        config.volume_steps == 0 || config.volume_steps > MAX_VOLUME_STEPS) {
+        return false;
+    }
+    m_config = config;
+    
+    // Step 0 mutes, the top step is unity
+    m_volume_gain[0] = 0;
+    for (uint8_t step = 1; step <= config.volume_steps; step++) {
+        m_volume_gain[step] = Mix::dbToGain(-(int32_t)(config.volume_steps - step) * config.volume_step_db);
+    }
+    for (size_t s = 0; s < SOURCE_COUNT; s++) {
+        m_trim[s] = Mix::dbToGain(config.gain_db[s]);
+    }
+    m_duck_floor = Mix::dbToGain(config.duck_db);
+    m_duck = Mix::UNITY;
+    setVolume(config.volume);
+    
+    // Start flat at the configured levels
+    beginChunk(0, false);
+    for (size_t s = 0; s < SOURCE_COUNT; s++) {
+        m_from[s] = m_to[s];
+    }
+    return true;
+}
+
+uint8_t Mixer::setVolume(int step) {
+    uint8_t clamped = (uint8_t)(step < 0 ? 0 : step > m_config.volume_steps ? m_config.volume_steps : step);
+    m_volume.store(clamped, std::memory_order_relaxed);
+    return clamped;
+}
+
+uint8_t Mixer::stepVolume(int delta) {
+    // Single writer in practice (the input task); a lost race only loses a step
+    return setVolume(getVolume() + delta);
+}
+
+void Mixer::beginChunk(size_t frames, bool duck) {
+    m_chunk_frames = frames;
+    
+    // Duck linearly: the full swing takes attack_ms down, release_ms up
+    uint16_t ms = duck ? m_config.duck_attack_ms : m_config.duck_release_ms;
+    int32_t swing = Mix::UNITY - m_duck_floor;
+    int32_t ramp_frames = (int32_t)((uint64_t)m_config.sample_rate * ms / 1000);
+    int32_t step = ramp_frames > 0 ? (int32_t)((int64_t)swing * (int64_t)frames / ramp_frames) : swing;
+    if (duck) {
+        m_duck = m_duck - step > m_duck_floor ? m_duck - step : m_duck_floor;
+    } else {
+        m_duck = m_duck + step < Mix::UNITY ? m_duck + step : Mix::UNITY;
+    }
+    
+    int32_t master = m_volume_gain[getVolume()];
+    for (size_t s = 0; s < SOURCE_COUNT; s++) {
+        m_from[s] = m_to[s];
+        int32_t gain = (m_trim[s] * master + (1 << 14)) >> 15;
+        if (static_cast<Source>(s) == Source::STREAM) {
+            gain = (gain * m_duck + (1 << 14)) >> 15;
+        }
+        m_to[s] = gain;
+    }
+}
+
+int32_t Mixer::gainAt(size_t source, size_t offset) const {
+    if (m_chunk_frames == 0) {
+        return m_to[source];
+    }
+    return m_from[source] + (int32_t)((int64_t)(m_to[source] - m_from[source]) * (int64_t)offset / (int64_t)m_chunk_frames);
+}
+
+void Mixer::scale(Source source, int16_t* chunk) {
+    size_t s = static_cast<size_t>(source);
+    Mix::scale(chunk, m_chunk_frames, m_config.channels, m_from[s], m_to[s]);
+}
+
+void Mixer::add(Source source, int16_t* chunk, size_t offset,
+                const int16_t* samples, size_t frames, uint8_t channels) {
+    size_t s = static_cast<size_t>(source);
+    if (offset + frames > m_chunk_frames) {
+        return;
+    }
+    Mix::mixInto(chunk + offset * m_config.channels, m_config.channels, samples, channels, frames,
+                 gainAt(s, offset), gainAt(s, offset + frames));
+}
+
+} // namespace Audio
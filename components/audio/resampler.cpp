@@ -0,0 +1,206 @@
+/**
+ * @file resampler.cpp
+ * @brief Streaming sample-rate conversion implementation
+ */
+
+#include "resampler.h"
+#include <cmath>
+#include <cstring>
+
+namespace Audio {
+
+namespace {
+
+constexpr size_t PHASE_BITS = 6;
+static_assert((1u << PHASE_BITS) == Resampler::PHASES, "PHASES must be 1 << PHASE_BITS");
+
+constexpr double KAISER_BETA = 7.0;             // About 70 dB of stopband
+constexpr double PASSBAND = 0.9;                // Cutoff as a fraction of the lower Nyquist rate
+constexpr int32_t COEF_ONE = 1 << 14;           // Q14 leaves headroom for the TAPS-long sums
+
+inline int32_t saturate16(int32_t value) {
+    return value > 32767 ? 32767 : value < -32768 ? -32768 : value;
+}
+
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * Both phases around the read position against the same input, blended
+ * by the position between them
+ */
+inline int32_t filter(const int16_t* x, size_t stride, const int16_t* c0, const int16_t* c1, int32_t blend) {
+    int32_t a = 0;
+    int32_t b = 0;
+    for (size_t k = 0; k < Resampler::TAPS; k++) {
+        int32_t sample = x[k * stride];
+        a += sample * c0[k];
+        b += sample * c1[k];
+    }
+    int32_t y = a + (int32_t)(((int64_t)(b - a) * blend) >> 15);
+    return saturate16((y + (COEF_ONE >> 1)) >> 14);
+}
+
+} // namespace
+
+Resampler::Resampler()
+    : m_in_rate(0)
+    , m_out_rate(0)
+    , m_in_channels(0)
+    , m_out_channels(0)
+    , m_trim_ppm(0)
+    , m_step(ONE)
+    , m_pos(0)
+    , m_fill(0)
+    , m_coef{}
+    , m_buffer{} {
+}
+
+bool Resampler::configure(uint32_t in_rate, uint32_t out_rate, uint8_t in_channels, uint8_t out_channels) {
+    if (in_rate == 0 || out_rate == 0 || in_rate > out_rate * MAX_RATIO ||
+        in_channels == 0 || out_channels > MAX_CHANNELS ||
+        (in_channels != out_channels && in_channels != 1)) {
+        return false;
+    }
+    
+    if (in_rate != m_in_rate || out_rate != m_out_rate) {
+        // Equal rates only ever need a fractional delay: a full-band sinc
+        // is then exactly a unit impulse on every whole-sample position
+        double cutoff = in_rate == out_rate
+            ? 0.5
+            : 0.5 * PASSBAND * (in_rate < out_rate ? 1.0 : (double)out_rate / in_rate);
+        m_in_rate = in_rate;
+        m_out_rate = out_rate;
+        design(cutoff);
+    }
+    m_in_channels = in_channels;
+    m_out_channels = out_channels;
+    updateStep();
+    reset();
+    return true;
+}
+
+void Resampler::design(double cutoff) {
+    const double center = TAPS / 2 - 1;
+    const double half_width = TAPS / 2;
+    const double norm = besselI0(KAISER_BETA);
+    
+    for (size_t phase = 0; phase <= PHASES; phase++) {
+        double frac = (double)phase / PHASES;
+        double row[TAPS];
+        double sum = 0.0;
+        for (size_t k = 0; k < TAPS; k++) {
+            double d = (double)k - center - frac;
+            double x = 2.0 * cutoff * d;
+            double sinc = fabs(x) < 1e-9 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+            double r = d / half_width;
+            double window = fabs(r) >= 1.0 ? 0.0 : besselI0(KAISER_BETA * sqrt(1.0 - r * r)) / norm;
+            row[k] = sinc * window;
+            sum += row[k];
+        }
+        
+        // Unity gain at DC, exactly: the rounding error goes on the largest tap
+        int16_t* coef = m_coef + phase * TAPS;
+        int32_t total = 0;
+        size_t largest = 0;
+        for (size_t k = 0; k < TAPS; k++) {
+            coef[k] = (int16_t)lround(row[k] / sum * COEF_ONE);
+            total += coef[k];
+            largest = row[k] > row[largest] ? k : largest;
+        }
+        coef[largest] = (int16_t)(coef[largest] + COEF_ONE - total);
+    }
+}
+
+void Resampler::reset() {
+    // History of silence, so the first input frame is centred on the first output
+    memset(m_buffer, 0, sizeof(m_buffer));
+    m_fill = TAPS / 2 - 1;
+    m_pos = 0;
+}
+
+void Resampler::setTrimPpm(int32_t ppm) {
+    ppm = ppm > MAX_TRIM_PPM ? MAX_TRIM_PPM : ppm < -MAX_TRIM_PPM ? -MAX_TRIM_PPM : ppm;
+    if (ppm != m_trim_ppm) {
+        m_trim_ppm = ppm;
+        updateStep();
+    }
+}
+
+void Resampler::updateStep() {
+    if (m_out_rate == 0) {
+        return;
+    }
+    uint64_t nominal = ((uint64_t)m_in_rate << 32) / m_out_rate;
+    m_step = (uint64_t)((int64_t)nominal + (int64_t)nominal * m_trim_ppm / 1000000);
+}
+
+size_t Resampler::refill(const int16_t* in, size_t in_frames) {
+    // Drop what the read position has passed, then top up
+    size_t ip = (size_t)(m_pos >> 32);
+    if (ip > 0) {
+        memmove(m_buffer, m_buffer + ip * m_in_channels, (m_fill - ip) * m_in_channels * sizeof(int16_t));
+        m_fill -= ip;
+        m_pos -= (uint64_t)ip << 32;
+    }
+    size_t count = BUFFER_FRAMES - m_fill;
+    count = count < in_frames ? count : in_frames;
+    memcpy(m_buffer + m_fill * m_in_channels, in, count * m_in_channels * sizeof(int16_t));
+    m_fill += count;
+    return count;
+}
+
+size_t Resampler::process(const int16_t* in, size_t in_frames, size_t& consumed,
+                          int16_t* out, size_t out_frames) {
+    consumed = 0;
+    size_t produced = 0;
+    while (produced < out_frames) {
+        size_t ip = (size_t)(m_pos >> 32);
+        if (ip + TAPS > m_fill) {
+            if (consumed == in_frames) {
+                break;
+            }
+            consumed += refill(in + consumed * m_in_channels, in_frames - consumed);
+            continue;
+        }
+        
+        const int16_t* x = m_buffer + ip * m_in_channels;
+        uint32_t frac = (uint32_t)m_pos;
+        int16_t* y = out + produced * m_out_channels;
+        if (frac == 0 && m_step == ONE) {
+            // Untrimmed, same rate: the filter would return the centre tap
+            const int16_t* centre = x + (TAPS / 2 - 1) * m_in_channels;
+            for (uint8_t c = 0; c < m_out_channels; c++) {
+                y[c] = centre[m_in_channels == 1 ? 0 : c];
+            }
+        } else {
+            size_t phase = frac >> (32 - PHASE_BITS);
+            int32_t blend = (int32_t)((frac >> (32 - PHASE_BITS - 15)) & 0x7FFF);
+            const int16_t* c0 = m_coef + phase * TAPS;
+            const int16_t* c1 = c0 + TAPS;
+            if (m_in_channels == 1) {
+                int16_t sample = (int16_t)filter(x, 1, c0, c1, blend);
+                for (uint8_t c = 0; c < m_out_channels; c++) {
+                    y[c] = sample;
+                }
+            } else {
+                for (uint8_t c = 0; c < m_in_channels; c++) {
+                    y[c] = (int16_t)filter(x + c, m_in_channels, c0, c1, blend);
+                }
+            }
+        }
+        
+        m_pos += m_step;
+        produced++;
+    }
+    return produced;
+}
+
+} // namespace Audio
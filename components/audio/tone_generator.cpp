@@ -0,0 +1,98 @@
+/**
+ * @file tone_generator.cpp
+ * @brief Tone synthesis implementation
+ */
+
+#include "tone_generator.h"
+
+namespace Audio {
+
+namespace {
+
+constexpr size_t SINE_BITS = 8;
+constexpr size_t SINE_SIZE = 1 << SINE_BITS;
+
+/**
+ * One sine period in Q15, one extra entry so interpolation never wraps.
+ * Taylor series after folding into [-pi/2, pi/2], exact to the LSB.
+ */
+struct SineTable {
+    int16_t value[SINE_SIZE + 1];
+};
+
+constexpr double constexprSin(double x) {
+    constexpr double PI = 3.14159265358979323846;
+    if (x > PI / 2) {
+        x = PI - x;
+    } else if (x < -PI / 2) {
+        x = -PI - x;
+    }
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 12; n++) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr SineTable makeSineTable() {
+    constexpr double PI = 3.14159265358979323846;
+    SineTable table = {};
+    for (size_t i = 0; i <= SINE_SIZE; i++) {
+        double x = 2 * PI * (double)(i % SINE_SIZE) / SINE_SIZE;
+        double s = constexprSin(x > PI ? x - 2 * PI : x) * 32767.0;
+        table.value[i] = (int16_t)(s < 0 ? s - 0.5 : s + 0.5);
+    }
+    return table;
+}
+
+constexpr SineTable SINE = makeSineTable();
+
+} // namespace
+
+ToneGenerator::ToneGenerator()
+    : m_phase(0)
+    , m_increment(0)
+    , m_total(0)
+    , m_remaining(0)
+    , m_edge(0) {
+}
+
+bool ToneGenerator::start(uint16_t frequency_hz, uint16_t duration_ms, uint32_t sample_rate) {
+    if (sample_rate == 0 || frequency_hz == 0 || (uint32_t)frequency_hz * 2 >= sample_rate) {
+        return false;
+    }
+    m_phase = 0;
+    m_increment = (uint32_t)(((uint64_t)frequency_hz << 32) / sample_rate);
+    m_total = (uint32_t)((uint64_t)sample_rate * duration_ms / 1000);
+    m_remaining = m_total;
+    m_edge = sample_rate * EDGE_MS / 1000;
+    if (m_edge * 2 > m_total) {
+        m_edge = m_total / 2;
+    }
+    return true;
+}
+
+size_t ToneGenerator::render(int16_t* out, size_t frames) {
+    size_t count = frames < m_remaining ? frames : m_remaining;
+    for (size_t i = 0; i < count; i++) {
+        // Top bits index the table, the next 15 interpolate
+        uint32_t index = m_phase >> (32 - SINE_BITS);
+        int32_t frac = (int32_t)((m_phase >> (32 - SINE_BITS - 15)) & 0x7FFF);
+        int32_t a = SINE.value[index];
+        int32_t b = SINE.value[index + 1];
+        int32_t sample = a + (((b - a) * frac) >> 15);
+        m_phase += m_increment;
+        
+        uint32_t position = m_total - m_remaining;
+        uint32_t left = m_remaining;
+        uint32_t edge = position < m_edge ? position : left <= m_edge ? left - 1 : m_edge;
+        int32_t level = m_edge > 0 ? (int32_t)(AMPLITUDE * edge / m_edge) : AMPLITUDE;
+        out[i] = (int16_t)((sample * level) >> 15);
+        m_remaining--;
+    }
+    return count;
+}
+
+} // namespace Audio
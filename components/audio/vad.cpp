@@ -0,0 +1,139 @@
+/**
+ * @file vad.cpp
+ * @brief Fixed-point voice activity detection
+ */
+
+#include "vad.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#endif
+
+namespace Audio {
+
+namespace {
+
+// Power ratios in log2 Q8 units: 256 / (10 * log10(2)) = 85.04 per dB
+constexpr int32_t Q8_PER_DB = 85;
+
+// Mean square of a full-scale square wave, 0 dBFS
+constexpr int32_t FULL_SCALE_Q8 = 30 * 256;
+
+// Noise floor tracking, per frame: rise in silence as a shift of the gap,
+// creep during speech in Q8 units
+constexpr int FLOOR_RISE_SHIFT = 5;
+constexpr int32_t FLOOR_CREEP_Q8 = 2;
+
+} // namespace
+
+Vad::Vad()
+    : m_config{}
+    , m_threshold_q8(0)
+    , m_min_level_q8(0)
+    , m_active(false)
+    , m_has_floor(false)
+    , m_floor_q8(0)
+    , m_speech_run(0)
+    , m_silence_run(0)
+    , m_stats{} {
+}
+
+void Vad::configure(const Config& config) {
+    m_config = config;
+    m_threshold_q8 = (int32_t)config.threshold_db * Q8_PER_DB;
+    m_min_level_q8 = FULL_SCALE_Q8 + (int32_t)config.min_level_dbfs * Q8_PER_DB;
+    reset();
+}
+
+void Vad::reset() {
+    m_active = false;
+    m_has_floor = false;
+    m_floor_q8 = 0;
+    m_speech_run = 0;
+    m_silence_run = 0;
+}
+
+int32_t Vad::log2Q8(uint32_t x) {
+    if (x == 0) {
+        return 0;
+    }
+    int msb = 31 - __builtin_clz(x);
+    // The 8 bits below the leading one approximate log2 of the mantissa
+    uint32_t fraction = msb >= 8 ? (x >> (msb - 8)) & 0xFF : (x << (8 - msb)) & 0xFF;
+    return msb * 256 + (int32_t)fraction;
+}
+
+Vad::Event Vad::process(const int16_t* pcm, size_t frames, uint8_t channels) {
+#ifdef ESP_PLATFORM
+    uint32_t start = esp_cpu_get_cycle_count();
+#endif
+    
+    if (frames == 0 || channels == 0) {
+        return Event::NONE;
+    }
+    
+    // Squares are scaled down by 2^6 so a frame of up to 2^16 full-scale
+    // samples fits 64 bits with room to spare and the mean fits 32
+    uint64_t energy = 0;
+    uint32_t crossings = 0;
+    int16_t previous = pcm[0];
+    for (size_t i = 0; i < frames; i++) {
+        int32_t sample = pcm[i * channels];
+        energy += (uint32_t)(sample * sample) >> 6;
+        crossings += (uint32_t)((sample ^ previous) < 0);
+        previous = (int16_t)sample;
+    }
+    int32_t level_q8 = log2Q8((uint32_t)(energy / frames)) + 6 * 256;
+    uint16_t zcr = (uint16_t)(crossings * 1000 / frames);
+    
+    if (!m_has_floor) {
+        m_floor_q8 = level_q8;
+        m_has_floor = true;
+    }
+    
+    int32_t margin = level_q8 - m_floor_q8;
+    bool speech = level_q8 >= m_min_level_q8 &&
+                  ((margin >= m_threshold_q8 && zcr <= m_config.max_zcr_permille) ||
+                   margin >= 2 * m_threshold_q8);
+    
+    if (margin < 0) {
+        m_floor_q8 = level_q8;
+    } else if (!speech) {
+        m_floor_q8 += (margin + (1 << FLOOR_RISE_SHIFT) - 1) >> FLOOR_RISE_SHIFT;
+    } else {
+        m_floor_q8 += FLOOR_CREEP_Q8;
+    }
+    
+    Event event = Event::NONE;
+    if (!m_active) {
+        m_speech_run = speech ? m_speech_run + 1 : 0;
+        if (m_speech_run >= m_config.onset_frames) {
+            m_active = true;
+            m_silence_run = 0;
+            m_stats.onsets++;
+            event = Event::ONSET;
+        }
+    } else {
+        m_silence_run = speech ? 0 : m_silence_run + 1;
+        if (m_silence_run >= m_config.hangover_frames) {
+            m_active = false;
+            m_speech_run = 0;
+            event = Event::OFFSET;
+        }
+    }
+    
+    m_stats.frames++;
+    if (m_active || event == Event::OFFSET) {
+        m_stats.speech_frames++;
+    }
+    m_stats.level_dbfs = (int16_t)((level_q8 - FULL_SCALE_Q8) / Q8_PER_DB);
+    m_stats.floor_dbfs = (int16_t)((m_floor_q8 - FULL_SCALE_Q8) / Q8_PER_DB);
+    m_stats.zcr_permille = zcr;
+    
+#ifdef ESP_PLATFORM
+    m_stats.cycles += esp_cpu_get_cycle_count() - start;
+#endif
+    return event;
+}
+
+} // namespace Audio
@@ -0,0 +1,128 @@
+/**
+ * @file wav_capture_source.cpp
+ * @brief WAV file as a capture source, for host runs
+ */
+
+#include "wav_capture_source.h"
+#include <cstring>
+#include <ctime>
+
+namespace Audio {
+
+namespace {
+
+uint32_t readLe32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+uint16_t readLe16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+} // namespace
+
+WavCaptureSource::WavCaptureSource()
+    : m_file(nullptr)
+    , m_realtime(false)
+    , m_sample_rate(0)
+    , m_channels(0)
+    , m_frames_left(0)
+    , m_position(0)
+    , m_started_us(0) {
+}
+
+WavCaptureSource::~WavCaptureSource() {
+    if (m_file) {
+        fclose(m_file);
+    }
+}
+
+int64_t WavCaptureSource::monotonicUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+bool WavCaptureSource::open(const char* path, bool realtime) {
+    m_file = fopen(path, "rb");
+    if (!m_file) {
+        return false;
+    }
+    m_realtime = realtime;
+    
+    uint8_t riff[12];
+    if (fread(riff, 1, sizeof(riff), m_file) != sizeof(riff) ||
+        memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    
+    // Walk the chunks: "fmt " must come before "data", anything else is skipped
+    uint8_t chunk[8];
+    while (fread(chunk, 1, sizeof(chunk), m_file) == sizeof(chunk)) {
+        uint32_t size = readLe32(chunk + 4);
+        
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (size < sizeof(fmt) || fread(fmt, 1, sizeof(fmt), m_file) != sizeof(fmt)) {
+                return false;
+            }
+            uint16_t format = readLe16(fmt);
+            uint16_t bits = readLe16(fmt + 14);
+            m_channels = (uint8_t)readLe16(fmt + 2);
+            m_sample_rate = readLe32(fmt + 4);
+            if (format != 1 || bits != 16 || m_channels == 0 || m_sample_rate == 0) {
+                return false;
+            }
+            size -= sizeof(fmt);
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (m_channels == 0) {
+                return false;
+            }
+            m_frames_left = size / (m_channels * sizeof(int16_t));
+            return true;
+        }
+        
+        // Chunks are padded to an even size
+        if (fseek(m_file, (long)(size + (size & 1)), SEEK_CUR) != 0) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool WavCaptureSource::start() {
+    m_position = 0;
+    m_started_us = m_realtime ? monotonicUs() : 0;
+    return m_file != nullptr;
+}
+
+void WavCaptureSource::stop() {
+}
+
+bool WavCaptureSource::read(int16_t* out, size_t frames, int64_t& captured_at_us) {
+    if (!m_file || frames > m_frames_left) {
+        return false;
+    }
+    
+    // Samples are little-endian on disk and in memory on every target we build for
+    if (fread(out, m_channels * sizeof(int16_t), frames, m_file) != frames) {
+        return false;
+    }
+    m_frames_left -= (uint32_t)frames;
+    
+    captured_at_us = m_started_us + (int64_t)(m_position * 1000000 / m_sample_rate);
+    m_position += frames;
+    
+    if (m_realtime) {
+        // Hand the frame over when its last sample would have been captured
+        int64_t ready_at_us = m_started_us + (int64_t)(m_position * 1000000 / m_sample_rate);
+        int64_t wait_us = ready_at_us - monotonicUs();
+        if (wait_us > 0) {
+            struct timespec ts = {(time_t)(wait_us / 1000000), (long)(wait_us % 1000000) * 1000};
+            nanosleep(&ts, nullptr);
+        }
+    }
+    return true;
+}
+
+} // namespace Audio
@@ -6,9 +6,18 @@
 #include "avi_transport.h"
 #include "esp_log.h"
 #include "esp_netif.h"
+#include "esp_vfs_eventfd.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 static const char* TAG = "AVI_TRANSPORT";
 
+static const char* WIFI_CACHE_NAMESPACE = "wifi_cache";
+static const char* WIFI_CACHE_KEY = "ap";
+static constexpr uint8_t WIFI_CACHE_VERSION = 1;
+
 namespace AVI {
 
 // ============================================================================
@@ -21,7 +30,17 @@ WiFiManager::WiFiManager(const char* ssid, const char* password)
     , m_connected(false)
     , m_callback(nullptr)
     , m_wifi_handler(nullptr)
-    , m_ip_handler(nullptr) {
+    , m_ip_handler(nullptr)
+    , m_netif(nullptr)
+    , m_fast_config{true, false, 2}
+    , m_cache{}
+    , m_cache_valid(false)
+    , m_fast_active(false)
+    , m_static_ip_active(false)
+    , m_fast_failures(0)
+    , m_ever_connected(false)
+    , m_attempt_start_us(0)
+    , m_metrics{} {
 }
 
 WiFiManager::~WiFiManager() {
@@ -34,7 +53,7 @@ WiFiManager::~WiFiManager() {
 }
 
 bool WiFiManager::init() {
-    esp_netif_create_default_wifi_sta();
+    m_netif = esp_netif_create_default_wifi_sta();
     
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     esp_err_t ret = esp_wifi_init(&cfg);
@@ -43,6 +62,9 @@ bool WiFiManager::init() {
         return false;
     }
     
+    // Configs change on every fallback; keep them out of flash
+    esp_wifi_set_storage(WIFI_STORAGE_RAM);
+    
     ret = esp_event_handler_instance_register(
         WIFI_EVENT, ESP_EVENT_ANY_ID, &eventHandler, this, &m_wifi_handler);
     if (ret != ESP_OK) {
@@ -57,25 +79,18 @@ bool WiFiManager::init() {
         return false;
     }
     
-    wifi_config_t wifi_config = {};
-    std::strncpy(reinterpret_cast<char*>(wifi_config.sta.ssid), 
-                 m_ssid, sizeof(wifi_config.sta.ssid) - 1);
-    std::strncpy(reinterpret_cast<char*>(wifi_config.sta.password), 
-                 m_password, sizeof(wifi_config.sta.password) - 1);
-    wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
-    
     ret = esp_wifi_set_mode(WIFI_MODE_STA);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Set mode failed: %s", esp_err_to_name(ret));
         return false;
     }
     
-    ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Set config failed: %s", esp_err_to_name(ret));
+    m_cache_valid = loadCache();
+    if (!applyStaConfig(m_fast_config.use_cached_ap && m_cache_valid)) {
         return false;
     }
     
+    m_attempt_start_us = esp_timer_get_time();
     ret = esp_wifi_start();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "WiFi start failed: %s", esp_err_to_name(ret));
@@ -100,7 +115,7 @@ void WiFiManager::eventHandler(void* arg, esp_event_base_t event_base,
             esp_wifi_connect();
         } else if (event_id == WIFI_EVENT_STA_DISCONNECTED) {
             ESP_LOGW(TAG, "WiFi disconnected, reconnecting...");
-            manager->m_connected = false;
+            manager->handleDisconnected();
             if (manager->m_callback) {
                 manager->m_callback(false);
             }
@@ -109,13 +124,199 @@ void WiFiManager::eventHandler(void* arg, esp_event_base_t event_base,
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         auto* event = static_cast<ip_event_got_ip_t*>(event_data);
         ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
-        manager->m_connected = true;
+        manager->handleGotIp(event);
         if (manager->m_callback) {
             manager->m_callback(true);
         }
     }
 }
 
+void WiFiManager::handleDisconnected() {
+    m_metrics.disconnects++;
+    
+    if (m_connected) {
+        // Link just dropped: time the reconnect, and go straight for the
+        // AP we were on
+        m_connected = false;
+        m_attempt_start_us = esp_timer_get_time();
+        m_fast_failures = 0;
+        if (m_fast_config.use_cached_ap && m_cache_valid && !m_fast_active) {
+            applyStaConfig(true);
+        }
+        return;
+    }
+    
+    if (m_fast_active && ++m_fast_failures >= m_fast_config.max_fast_attempts) {
+        ESP_LOGW(TAG, "Cached AP unreachable after %d attempts, falling back to full scan",
+                 m_fast_failures);
+        m_metrics.fallbacks++;
+        clearCache();
+        applyStaConfig(false);
+    }
+}
+
+void WiFiManager::handleGotIp(const ip_event_got_ip_t* event) {
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed_ms = (now - m_attempt_start_us) / 1000;
+    const char* path = m_fast_active ? "cached AP" : "full scan";
+    
+    if (m_fast_active) {
+        m_metrics.fast_connects++;
+    } else {
+        m_metrics.full_scans++;
+    }
+    
+    if (!m_ever_connected) {
+        m_metrics.boot_to_ip_ms = now / 1000;
+        m_metrics.init_to_ip_ms = elapsed_ms;
+        ESP_LOGI(TAG, "Time to IP (cold boot): %lld ms since WiFi start, %lld ms since boot (%s)",
+                 (long long)elapsed_ms, (long long)m_metrics.boot_to_ip_ms, path);
+    } else {
+        m_metrics.last_reconnect_ms = elapsed_ms;
+        if (elapsed_ms > m_metrics.max_reconnect_ms) {
+            m_metrics.max_reconnect_ms = elapsed_ms;
+        }
+        ESP_LOGI(TAG, "Time to IP (reconnect): %lld ms (%s)", (long long)elapsed_ms, path);
+    }
+    
+    m_connected = true;
+    m_ever_connected = true;
+    m_fast_failures = 0;
+    storeCache(event);
+}
+
+bool WiFiManager::applyStaConfig(bool fast) {
+    wifi_config_t wifi_config = {};
+    std::strncpy(reinterpret_cast<char*>(wifi_config.sta.ssid), 
+                 m_ssid, sizeof(wifi_config.sta.ssid) - 1);
+    std::strncpy(reinterpret_cast<char*>(wifi_config.sta.password), 
+                 m_password, sizeof(wifi_config.sta.password) - 1);
+    wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
+    
+    if (fast) {
+        // Directed connect: no scan beyond the cached channel
+        wifi_config.sta.bssid_set = true;
+        std::memcpy(wifi_config.sta.bssid, m_cache.bssid, sizeof(wifi_config.sta.bssid));
+        wifi_config.sta.channel = m_cache.channel;
+        wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+    } else {
+        wifi_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        wifi_config.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+    }
+    
+    esp_err_t ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Set config failed: %s", esp_err_to_name(ret));
+        return false;
+    }
+    m_fast_active = fast;
+    
+    bool use_static_ip = fast && m_fast_config.use_cached_ip && m_cache.ip != 0;
+    if (use_static_ip && !m_static_ip_active) {
+        esp_netif_ip_info_t ip_info = {};
+        ip_info.ip.addr = m_cache.ip;
+        ip_info.netmask.addr = m_cache.netmask;
+        ip_info.gw.addr = m_cache.gw;
+        
+        esp_netif_dhcpc_stop(m_netif);
+        if (esp_netif_set_ip_info(m_netif, &ip_info) == ESP_OK) {
+            m_static_ip_active = true;
+        } else {
+            ESP_LOGW(TAG, "Cached static IP rejected, using DHCP");
+            esp_netif_dhcpc_start(m_netif);
+        }
+    } else if (!use_static_ip && m_static_ip_active) {
+        esp_netif_dhcpc_start(m_netif);
+        m_static_ip_active = false;
+    }
+    
+    if (fast) {
+        ESP_LOGI(TAG, "Fast connect: channel %d, %s",
+                 m_cache.channel, m_static_ip_active ? "static IP" : "DHCP");
+    }
+    return true;
+}
+
+uint32_t WiFiManager::ssidHash() const {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (const char* c = m_ssid; *c; c++) {
+        hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+    }
+    return hash;
+}
+
+bool WiFiManager::loadCache() {
+    nvs_handle_t handle;
+    if (nvs_open(WIFI_CACHE_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+    
+    size_t size = sizeof(m_cache);
+    esp_err_t ret = nvs_get_blob(handle, WIFI_CACHE_KEY, &m_cache, &size);
+    nvs_close(handle);
+    
+    if (ret != ESP_OK || size != sizeof(m_cache) ||
+        m_cache.version != WIFI_CACHE_VERSION || m_cache.ssid_hash != ssidHash()) {
+        m_cache = {};
+        return false;
+    }
+    
+    ESP_LOGI(TAG, "Cached AP: %02x:%02x:%02x:%02x:%02x:%02x on channel %d",
+             m_cache.bssid[0], m_cache.bssid[1], m_cache.bssid[2],
+             m_cache.bssid[3], m_cache.bssid[4], m_cache.bssid[5], m_cache.channel);
+    return true;
+}
+
+void WiFiManager::storeCache(const ip_event_got_ip_t* event) {
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
+        return;
+    }
+    
+    ApCache cache = {};
+    cache.version = WIFI_CACHE_VERSION;
+    cache.channel = ap_info.primary;
+    std::memcpy(cache.bssid, ap_info.bssid, sizeof(cache.bssid));
+    cache.ssid_hash = ssidHash();
+    cache.ip = event->ip_info.ip.addr;
+    cache.netmask = event->ip_info.netmask.addr;
+    cache.gw = event->ip_info.gw.addr;
+    
+    // Only touch flash when something changed
+    if (m_cache_valid && std::memcmp(&cache, &m_cache, sizeof(cache)) == 0) {
+        return;
+    }
+    
+    nvs_handle_t handle;
+    if (nvs_open(WIFI_CACHE_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to open WiFi cache");
+        return;
+    }
+    
+    if (nvs_set_blob(handle, WIFI_CACHE_KEY, &cache, sizeof(cache)) == ESP_OK &&
+        nvs_commit(handle) == ESP_OK) {
+        m_cache = cache;
+        m_cache_valid = true;
+        ESP_LOGI(TAG, "WiFi cache updated (channel %d)", cache.channel);
+    } else {
+        ESP_LOGW(TAG, "Failed to store WiFi cache");
+    }
+    nvs_close(handle);
+}
+
+void WiFiManager::clearCache() {
+    m_cache = {};
+    m_cache_valid = false;
+    
+    nvs_handle_t handle;
+    if (nvs_open(WIFI_CACHE_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+        nvs_erase_key(handle, WIFI_CACHE_KEY);
+        nvs_commit(handle);
+        nvs_close(handle);
+    }
+}
+
 // ============================================================================
 // UDP Transport
 // ============================================================================
@@ -124,46 +325,114 @@ UdpTransport::UdpTransport(const char* server_ip, uint16_t port)
     : m_server_ip(server_ip)
     , m_port(port)
     , m_socket(-1)
-    , m_connected(false) {
+    , m_wakeup_fd(-1)
+    , m_connected(false)
+    , m_rx_packets(0)
+    , m_rx_bytes(0)
+    , m_task_core(tskNO_AFFINITY)
+    , m_rx_task(nullptr)
+    , m_rx_stats{}
+    , m_rx_starved(false)
+    , m_rx_too_large(0)
+    , m_tx_task(nullptr)
+    , m_tx_busy(false)
+    , m_socket_generation(0)
+    , m_tx_tos_generation(0)
+    , m_tx_tos(-1)
+    , m_tx_stats{}
+    , m_tx_free(nullptr)
+    , m_tx_free_control(nullptr)
+    , m_tx_queues{} {
     std::memset(&m_server_addr, 0, sizeof(m_server_addr));
+    
+    for (size_t i = 0; i < RX_POOL_SLOTS; i++) {
+        m_rx_free.push(static_cast<uint8_t>(i));
+    }
+    
+    m_tx_free = xQueueCreate(TX_POOL_SLOTS - TX_CONTROL_SLOTS, sizeof(uint8_t));
+    m_tx_free_control = xQueueCreate(TX_CONTROL_SLOTS, sizeof(uint8_t));
+    for (auto& queue : m_tx_queues) {
+        queue = xQueueCreate(TX_POOL_SLOTS, sizeof(uint8_t));
+    }
+    for (size_t i = 0; i < TX_POOL_SLOTS; i++) {
+        releaseTxSlot(static_cast<uint8_t>(i));
+    }
+    
+    // Requires esp_vfs_eventfd_register() to have been called
+    m_wakeup_fd = eventfd(0, 0);
+    if (m_wakeup_fd < 0) {
+        ESP_LOGW(TAG, "Wakeup eventfd unavailable: errno %d", errno);
+    }
 }
 
 UdpTransport::~UdpTransport() {
     disconnect();
+    if (m_wakeup_fd >= 0) {
+        close(m_wakeup_fd);
+    }
 }
 
 bool UdpTransport::connect() {
-    if (m_connected) {
+    if (m_connected && m_socket >= 0) {
         return true;
     }
     
-    m_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-    if (m_socket < 0) {
-        ESP_LOGE(TAG, "Failed to create socket: errno %d", errno);
-        return false;
-    }
-    
     m_server_addr.sin_family = AF_INET;
     m_server_addr.sin_port = htons(m_port);
     
     if (inet_pton(AF_INET, m_server_ip, &m_server_addr.sin_addr) != 1) {
         ESP_LOGE(TAG, "Invalid server IP: %s", m_server_ip);
-        close(m_socket);
-        m_socket = -1;
         return false;
     }
     
+    if (!m_rx_task) {
+        BaseType_t ok = xTaskCreatePinnedToCore(&UdpTransport::rxTaskEntry, "avi_rx",
+                                                RX_TASK_STACK_SIZE, this,
+                                                RX_TASK_PRIORITY, &m_rx_task,
+                                                m_task_core);
+        if (ok != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create receive task");
+            m_rx_task = nullptr;
+            return false;
+        }
+    }
+    
+    if (!m_tx_task) {
+        BaseType_t ok = xTaskCreatePinnedToCore(&UdpTransport::txTaskEntry, "avi_tx",
+                                                TX_TASK_STACK_SIZE, this,
+                                                TX_TASK_PRIORITY, &m_tx_task,
+                                                m_task_core);
+        if (ok != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create send task");
+            m_tx_task = nullptr;
+            return false;
+        }
+    }
+    
+    // The receive task idles while disconnected, so it opens the socket
+    // right away; if the old one is still open it simply keeps it
     m_connected = true;
+    xTaskNotifyGive(m_rx_task);
+    
+    int64_t deadline = esp_timer_get_time() + CONNECT_TIMEOUT_MS * 1000;
+    while (m_socket < 0) {
+        if (!m_connected || esp_timer_get_time() >= deadline) {
+            ESP_LOGE(TAG, "UDP socket not opened");
+            m_connected = false;
+            return false;
+        }
+        vTaskDelay(1);
+    }
+    
     ESP_LOGI(TAG, "UDP connected to %s:%d", m_server_ip, m_port);
     return true;
 }
 
 void UdpTransport::disconnect() {
-    if (m_socket >= 0) {
-        close(m_socket);
-        m_socket = -1;
-    }
     m_connected = false;
+    if (m_rx_task) {
+        xTaskNotifyGive(m_rx_task);
+    }
 }
 
 int32_t UdpTransport::send(const uint8_t* data, size_t length) {
@@ -172,45 +441,385 @@ int32_t UdpTransport::send(const uint8_t* data, size_t length) {
         return -1;
     }
     
-    int sent = sendto(m_socket, data, length, 0,
-                     reinterpret_cast<struct sockaddr*>(&m_server_addr),
-                     sizeof(m_server_addr));
+    TrafficClass tc = m_tx_class;
+    TxStats& stats = m_tx_stats[static_cast<size_t>(tc)];
     
-    if (sent < 0) {
-        ESP_LOGE(TAG, "UDP send failed: errno %d", errno);
+    if (length > TX_SLOT_SIZE) {
+        ESP_LOGE(TAG, "UDP datagram too large: %u bytes", (unsigned)length);
+        stats.dropped++;
         return -1;
     }
     
-    ESP_LOGV(TAG, "Sent %d bytes", sent);
-    return 0;
+    // Control takes its own slots first and the shared ones after; bulk
+    // only ever gets the shared ones
+    uint8_t index;
+    bool control = tc == TrafficClass::CONTROL;
+    if (!(control && xQueueReceive(m_tx_free_control, &index, 0) == pdTRUE) &&
+        xQueueReceive(m_tx_free, &index, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "TX pool exhausted, dropping %u bytes", (unsigned)length);
+        stats.dropped++;
+        return -1;
+    }
+    
+    TxSlot& slot = m_tx_pool[index];
+    std::memcpy(slot.data, data, length);
+    slot.length = static_cast<uint16_t>(length);
+    slot.tc = tc;
+    slot.contended = uxQueueMessagesWaiting(
+        m_tx_queues[static_cast<size_t>(control ? TrafficClass::BULK : TrafficClass::CONTROL)]) > 0;
+    slot.queued_at_us = esp_timer_get_time();
+    
+    QueueHandle_t queue = m_tx_queues[static_cast<size_t>(tc)];
+    xQueueSend(queue, &index, 0);  // Cannot fail, queues hold every slot
+    stats.queued++;
+    stats.queued_bytes += length;
+    
+    uint32_t depth = uxQueueMessagesWaiting(queue);
+    if (depth > stats.depth_high_water) {
+        stats.depth_high_water = depth;
+    }
+    
+    xTaskNotifyGive(m_tx_task);
+    return static_cast<int32_t>(length);
+}
+
+TransportMetrics UdpTransport::getMetrics() const {
+    TransportMetrics metrics = {};
+    metrics.rx_packets = m_rx_packets;
+    metrics.rx_dropped = m_rx_stats.dropped + m_rx_too_large;
+    metrics.rx_bytes = m_rx_bytes;
+    for (const auto& stats : m_tx_stats) {
+        metrics.tx_packets += stats.sent;
+        metrics.tx_dropped += stats.dropped + stats.send_errors;
+        metrics.tx_bytes += stats.bytes;
+    }
+    return metrics;
+}
+
+TrafficClassMetrics UdpTransport::getClassMetrics(TrafficClass tc) const {
+    const TxStats& stats = m_tx_stats[static_cast<size_t>(tc)];
+    TrafficClassMetrics metrics = {};
+    metrics.accepted = stats.queued;
+    metrics.accepted_bytes = stats.queued_bytes;
+    metrics.sent = stats.sent;
+    metrics.latency_max_us = stats.latency_max_us;
+    metrics.latency_total_us = stats.latency_total_us;
+    return metrics;
+}
+
+UdpTransport::TxStats UdpTransport::getTxStats(TrafficClass tc) const {
+    size_t i = static_cast<size_t>(tc);
+    TxStats stats = m_tx_stats[i];
+    stats.depth = m_tx_queues[i] ? uxQueueMessagesWaiting(m_tx_queues[i]) : 0;
+    return stats;
+}
+
+UdpTransport::RxStats UdpTransport::getRxStats() const {
+    RxStats stats = m_rx_stats;
+    stats.dropped += m_rx_too_large;
+    stats.too_large = m_rx_too_large;
+    return stats;
 }
 
 int32_t UdpTransport::receive(uint8_t* buffer, size_t buffer_size) {
-    if (!m_connected) {
-        return 0;
+    uint8_t index;
+    while (true) {
+        if (!m_rx_ready.pop(index)) {
+            return 0;
+        }
+        if (m_rx_pool[index].length <= buffer_size) {
+            break;
+        }
+        // Dropped whole like an oversize datagram: a cut frame would
+        // only confuse the AVI core
+        ESP_LOGD(TAG, "Dropping %u byte datagram, buffer holds %u",
+                 (unsigned)m_rx_pool[index].length, (unsigned)buffer_size);
+        m_rx_too_large++;
+        releaseRxSlot(index);
     }
     
+    // The AVI core owns the destination buffer, so this is the one copy
+    // left on the receive path (previously done by recvfrom itself)
+    const RxSlot& slot = m_rx_pool[index];
+    size_t len = slot.length;
+    std::memcpy(buffer, slot.data, len);
+    releaseRxSlot(index);
+    
+    m_rx_packets++;
+    m_rx_bytes += len;
+    ESP_LOGV(TAG, "Received %u bytes", (unsigned)len);
+    return static_cast<int32_t>(len);
+}
+
+bool UdpTransport::waitForActivity(uint32_t timeout_ms) {
+    if (!m_rx_ready.empty()) {
+        return true;
+    }
+    
+    if (m_wakeup_fd < 0) {
+        vTaskDelay(pdMS_TO_TICKS(timeout_ms));
+        return !m_rx_ready.empty();
+    }
+    
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    FD_SET(m_wakeup_fd, &read_fds);
+    
     struct timeval timeout;
-    timeout.tv_sec = 0;
-    timeout.tv_usec = 1000; // 1ms
-    setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
     
-    struct sockaddr_in source_addr;
-    socklen_t socklen = sizeof(source_addr);
+    int ready = select(m_wakeup_fd + 1, &read_fds, nullptr, nullptr, &timeout);
+    if (ready < 0 && errno != EINTR) {
+        ESP_LOGE(TAG, "select failed: errno %d", errno);
+    } else if (ready > 0) {
+        uint64_t count;
+        read(m_wakeup_fd, &count, sizeof(count));
+    }
     
-    int len = recvfrom(m_socket, buffer, buffer_size, 0,
-                      reinterpret_cast<struct sockaddr*>(&source_addr), &socklen);
+    return !m_rx_ready.empty();
+}
+
+void UdpTransport::wakeup() {
+    if (m_wakeup_fd >= 0) {
+        uint64_t one = 1;
+        write(m_wakeup_fd, &one, sizeof(one));
+    }
+}
+
+void UdpTransport::txTaskEntry(void* arg) {
+    static_cast<UdpTransport*>(arg)->txTask();
+}
+
+void UdpTransport::txTask() {
+    QueueHandle_t control = m_tx_queues[static_cast<size_t>(TrafficClass::CONTROL)];
+    QueueHandle_t bulk = m_tx_queues[static_cast<size_t>(TrafficClass::BULK)];
     
-    if (len < 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            return 0;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        // Send everything queued in one burst. Control is re-checked before
+        // each bulk datagram so an event never waits behind a stream.
+        // Draining one class at a time keeps IP_TOS switches to a minimum.
+        while (true) {
+            uint8_t index;
+            if (xQueueReceive(control, &index, 0) != pdTRUE &&
+                xQueueReceive(bulk, &index, 0) != pdTRUE) {
+                break;
+            }
+            transmit(m_tx_pool[index]);
+            releaseTxSlot(index);
+        }
+    }
+}
+
+void UdpTransport::transmit(TxSlot& slot) {
+    TxStats& stats = m_tx_stats[static_cast<size_t>(slot.tc)];
+    
+    // closeSocket() waits for m_tx_busy to clear before closing, so the
+    // socket stays valid until sendto() returns
+    m_tx_busy = true;
+    int sock = m_socket;
+    if (sock < 0) {
+        m_tx_busy = false;
+        stats.send_errors++;
+        return;
+    }
+    
+    uint32_t generation = m_socket_generation;
+    if (generation != m_tx_tos_generation) {
+        m_tx_tos_generation = generation;
+        m_tx_tos = -1;  // New socket, TOS not applied yet
+    }
+    
+    int tos = slot.tc == TrafficClass::CONTROL ? TX_TOS_CONTROL : TX_TOS_BULK;
+    if (tos != m_tx_tos) {
+        if (setsockopt(sock, IPPROTO_IP, IP_TOS, &tos, sizeof(tos)) == 0) {
+            m_tx_tos = tos;
+        } else {
+            ESP_LOGW(TAG, "Failed to set IP_TOS 0x%02x: errno %d", tos, errno);
+        }
+    }
+    
+    int sent = sendto(sock, slot.data, slot.length, 0,
+                      reinterpret_cast<struct sockaddr*>(&m_server_addr),
+                      sizeof(m_server_addr));
+    m_tx_busy = false;
+    
+    if (sent < 0) {
+        ESP_LOGE(TAG, "UDP send failed: errno %d", errno);
+        stats.send_errors++;
+        return;
+    }
+    
+    uint32_t latency = static_cast<uint32_t>(esp_timer_get_time() - slot.queued_at_us);
+    stats.sent++;
+    stats.bytes += static_cast<uint64_t>(sent);
+    stats.latency_last_us = latency;
+    stats.latency_total_us += latency;
+    if (latency > stats.latency_max_us) {
+        stats.latency_max_us = latency;
+    }
+    if (slot.contended) {
+        stats.contended++;
+        stats.contended_latency_total_us += latency;
+        if (latency > stats.contended_latency_max_us) {
+            stats.contended_latency_max_us = latency;
+        }
+    }
+    
+    ESP_LOGV(TAG, "Sent %d bytes", sent);
+}
+
+void UdpTransport::releaseTxSlot(uint8_t index) {
+    // Cannot fail, each free queue holds all of its slots
+    xQueueSend(index < TX_CONTROL_SLOTS ? m_tx_free_control : m_tx_free, &index, 0);
+}
+
+void UdpTransport::releaseRxSlot(uint8_t index) {
+    // Cannot fail, the ring holds every slot
+    m_rx_free.push(index);
+    if (m_rx_starved.exchange(false)) {
+        xTaskNotifyGive(m_rx_task);
+    }
+}
+
+void UdpTransport::rxTaskEntry(void* arg) {
+    static_cast<UdpTransport*>(arg)->rxTask();
+}
+
+void UdpTransport::rxTask() {
+    constexpr uint32_t IDLE_DELAY_MS = 100;
+    constexpr uint32_t SELECT_TIMEOUT_MS = 100;
+    
+    int held_slot = -1;     // Free slot popped but not yet filled
+    bool exhausted = false;
+    
+    ESP_LOGI(TAG, "Receive task started (%u slots x %u bytes)",
+             (unsigned)RX_POOL_SLOTS, (unsigned)RX_SLOT_SIZE);
+    
+    while (true) {
+        int sock = m_socket;
+        if (!m_connected) {
+            if (sock >= 0) {
+                closeSocket();
+            }
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IDLE_DELAY_MS));
+            continue;
+        }
+        if (sock < 0) {
+            sock = openSocket();
+            if (sock < 0) {
+                m_connected = false;  // connect() gives up
+                continue;
+            }
+        }
+        
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(sock, &read_fds);
+        
+        struct timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = SELECT_TIMEOUT_MS * 1000;
+        
+        int ready = select(sock + 1, &read_fds, nullptr, nullptr, &timeout);
+        if (ready <= 0) {
+            continue;  // Timeout, or a disconnect() to act on
         }
-        ESP_LOGE(TAG, "UDP receive failed: errno %d", errno);
+        
+        // Drain everything the socket has queued
+        while (true) {
+            if (held_slot < 0) {
+                uint8_t index;
+                if (m_rx_free.pop(index)) {
+                    held_slot = index;
+                    exhausted = false;
+                }
+            }
+            
+            if (held_slot < 0) {
+                if (!exhausted) {
+                    exhausted = true;
+                    m_rx_stats.pool_exhausted++;
+                }
+                // Stop reading until receive() frees a slot, so the rest of
+                // a burst waits in the socket's receive buffer. The flag is
+                // raised before the ring is checked again, so a slot freed
+                // in between still sends the notification.
+                m_rx_starved = true;
+                if (!m_rx_free.empty()) {
+                    m_rx_starved = false;
+                    continue;
+                }
+                ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SELECT_TIMEOUT_MS));
+                break;  // Back through select(), for a disconnect() meanwhile
+            }
+            
+            RxSlot& slot = m_rx_pool[held_slot];
+            int len = recv(sock, slot.data, sizeof(slot.data), MSG_DONTWAIT);
+            if (len < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    ESP_LOGE(TAG, "UDP receive failed: errno %d", errno);
+                    vTaskDelay(pdMS_TO_TICKS(IDLE_DELAY_MS));
+                }
+                break;
+            }
+            if (len > static_cast<int>(RX_SLOT_SIZE)) {
+                // Dropped whole, and the slot stays held for the next one
+                ESP_LOGD(TAG, "Dropping oversize datagram (more than %u bytes)", (unsigned)RX_SLOT_SIZE);
+                m_rx_stats.dropped++;
+                m_rx_stats.oversize++;
+                continue;
+            }
+            
+            slot.length = static_cast<uint16_t>(len);
+            bool was_empty = m_rx_ready.empty();
+            m_rx_ready.push(static_cast<uint8_t>(held_slot));
+            held_slot = -1;
+            m_rx_stats.received++;
+            
+            uint32_t depth = m_rx_ready.size();
+            if (depth > m_rx_stats.ring_high_water) {
+                m_rx_stats.ring_high_water = depth;
+            }
+            if (was_empty) {
+                wakeup();
+            }
+        }
+    }
+}
+
+int UdpTransport::openSocket() {
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Failed to create socket: errno %d", errno);
+        return -1;
+    }
+    
+    // Non-blocking once, instead of a receive timeout on every call
+    int flags = fcntl(sock, F_GETFL, 0);
+    if (flags < 0 || fcntl(sock, F_SETFL, flags | O_NONBLOCK) < 0) {
+        ESP_LOGE(TAG, "Failed to set non-blocking: errno %d", errno);
+        close(sock);
         return -1;
     }
     
-    ESP_LOGV(TAG, "Received %d bytes", len);
-    return len;
+    m_socket_generation++;
+    m_socket = sock;
+    return sock;
+}
+
+void UdpTransport::closeSocket() {
+    int sock = m_socket.exchange(-1);
+    
+    // The sender task may have read the old socket just before: let it
+    // leave sendto() first
+    while (m_tx_busy) {
+        vTaskDelay(1);
+    }
+    close(sock);
+    ESP_LOGI(TAG, "UDP socket closed");
 }
 
 } // namespace AVI
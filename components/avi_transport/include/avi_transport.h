@@ -2,38 +2,93 @@
  * @file avi_transport.h
  * @brief AVI Protocol Transport Layer
  * 
- * Provides WiFi connectivity and UDP transport for AVI protocol
+ * Provides WiFi connectivity and the ESP32 (lwIP) UDP transport for
+ * AVI protocol
  */
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <functional>
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "lwip/sockets.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "spsc_ring.h"
+#include "transport.h"
 
 namespace AVI {
 
 /**
  * @brief WiFi Manager - handles WiFi connection lifecycle
+ * 
+ * The last-good BSSID, channel and IP lease are cached in NVS. Boot and
+ * reconnects first try a directed connect to the cached AP (optionally
+ * with the cached lease as a static IP) and fall back to a full scan with
+ * DHCP after a few failed attempts.
  */
 class WiFiManager {
 public:
     using ConnectionCallback = std::function<void(bool connected)>;
     
+    /**
+     * @brief Fast-connect options, applied by init()
+     */
+    struct FastConnectConfig {
+        bool use_cached_ap;          // Directed connect to the last-good BSSID/channel
+        bool use_cached_ip;          // Reuse the last DHCP lease as a static IP
+        uint8_t max_fast_attempts;   // Failed directed attempts before a full scan
+    };
+    
+    /**
+     * @brief Association timing and path counters
+     */
+    struct ConnectMetrics {
+        int64_t boot_to_ip_ms;       // Power-on to first IP
+        int64_t init_to_ip_ms;       // init() to first IP
+        int64_t last_reconnect_ms;   // Link loss to IP, last reconnect
+        int64_t max_reconnect_ms;
+        uint32_t fast_connects;      // IPs obtained through the cached AP
+        uint32_t full_scans;         // IPs obtained after a full scan
+        uint32_t fallbacks;          // Times the cached AP was given up on
+        uint32_t disconnects;
+    };
+    
     WiFiManager(const char* ssid, const char* password);
     ~WiFiManager();
     
+    void setFastConnect(const FastConnectConfig& config) { m_fast_config = config; }
     bool init();
     void onConnectionChange(ConnectionCallback callback);
     bool isConnected() const { return m_connected; }
+    const ConnectMetrics& getMetrics() const { return m_metrics; }
     
 private:
+    struct ApCache {
+        uint8_t version;
+        uint8_t channel;
+        uint8_t bssid[6];
+        uint32_t ssid_hash;          // Invalidates the cache when the SSID changes
+        uint32_t ip;
+        uint32_t netmask;
+        uint32_t gw;
+    };
+    
     static void eventHandler(void* arg, esp_event_base_t event_base,
                             int32_t event_id, void* event_data);
     
+    void handleDisconnected();
+    void handleGotIp(const ip_event_got_ip_t* event);
+    bool applyStaConfig(bool fast);
+    bool loadCache();
+    void storeCache(const ip_event_got_ip_t* event);
+    void clearCache();
+    uint32_t ssidHash() const;
+    
     const char* m_ssid;
     const char* m_password;
     bool m_connected;
@@ -41,30 +96,214 @@ private:
     
     esp_event_handler_instance_t m_wifi_handler;
     esp_event_handler_instance_t m_ip_handler;
+    esp_netif_t* m_netif;
+    
+    FastConnectConfig m_fast_config;
+    ApCache m_cache;
+    bool m_cache_valid;
+    bool m_fast_active;              // Current attempt targets the cached AP
+    bool m_static_ip_active;         // DHCP stopped, cached lease applied
+    uint8_t m_fast_failures;
+    bool m_ever_connected;
+    int64_t m_attempt_start_us;      // Start of the current time-to-IP measurement
+    ConnectMetrics m_metrics;
 };
 
 /**
  * @brief UDP Transport - handles UDP socket communication
+ * 
+ * Inbound datagrams are read by a dedicated receive task into a fixed pool
+ * of preallocated slots. Filled slots are handed to the consumer (the AVI
+ * poll loop) through a lock-free SPSC ring and returned through a second
+ * one, so the socket is drained while the AVI core is busy and no heap is
+ * touched on the receive path. When every slot is taken the receive task
+ * stops reading until the consumer hands one back, and the rest of a burst
+ * waits in the socket's receive buffer. Datagrams larger than a slot, or
+ * than the consumer's buffer, are dropped, never truncated.
+ * 
+ * The receive task also owns the socket: connect() and disconnect() only
+ * ask for it to be opened or closed, so it is never closed under the
+ * receive task's select() or the sender task's sendto().
+ * 
+ * Outbound datagrams are copied into a preallocated TX slot and queued per
+ * TrafficClass; a sender task drains control before bulk and marks each
+ * class with its own IP_TOS/DSCP value. TX_CONTROL_SLOTS of the pool only
+ * ever carry control datagrams, so a stream that fills the rest cannot
+ * lock events and acks out.
  */
-class UdpTransport {
+class UdpTransport : public Transport {
 public:
+    static constexpr size_t RX_SLOT_SIZE = 1472;        // Max UDP payload for a 1500 byte MTU
+    static constexpr size_t RX_POOL_SLOTS = 16;         // Power of two; 8 lost bursts on a small socket buffer
+    static constexpr uint32_t RX_TASK_STACK_SIZE = 3072;
+    static constexpr uint32_t CONNECT_TIMEOUT_MS = 500; // For the receive task to open the socket
+    static constexpr UBaseType_t RX_TASK_PRIORITY = 6;
+    
+    static constexpr size_t TX_SLOT_SIZE = 1472;
+    static constexpr size_t TX_POOL_SLOTS = 16;
+    static constexpr size_t TX_CONTROL_SLOTS = 4;       // Of the pool, held back for CONTROL
+    static constexpr uint32_t TX_TASK_STACK_SIZE = 3072;
+    static constexpr UBaseType_t TX_TASK_PRIORITY = 6;
+    static constexpr uint8_t TX_TOS_CONTROL = 0xB8;     // DSCP EF (46)
+    static constexpr uint8_t TX_TOS_BULK = 0x28;        // DSCP AF11 (10)
+    
+    /**
+     * @brief Receive path counters
+     */
+    struct RxStats {
+        uint32_t received;         // Datagrams queued by the receive task
+        uint32_t dropped;          // Datagrams discarded whole
+        uint32_t oversize;         // Of those, datagrams larger than RX_SLOT_SIZE
+        uint32_t too_large;        // Of those, datagrams larger than receive()'s buffer
+        uint32_t pool_exhausted;   // Times the receive task waited for a free slot
+        uint32_t ring_high_water;  // Most slots waiting for the consumer at once
+    };
+    
+    /**
+     * @brief Per-class transmit counters
+     */
+    struct TxStats {
+        uint32_t queued;            // Datagrams accepted by send()
+        uint64_t queued_bytes;      // Their length
+        uint32_t sent;              // Datagrams handed to the socket
+        uint64_t bytes;             // Payload bytes handed to the socket
+        uint32_t dropped;           // Datagrams rejected by send() (pool full, oversized)
+        uint32_t send_errors;       // Datagrams the socket refused
+        uint32_t depth;             // Datagrams currently waiting
+        uint32_t depth_high_water;  // Most datagrams waiting at once
+        uint32_t latency_last_us;   // Queue-to-wire time of the last datagram
+        uint32_t latency_max_us;    // Worst queue-to-wire time
+        uint64_t latency_total_us;  // Sum over all sent datagrams, for averaging
+        uint32_t contended;         // Sent datagrams queued while the other class had some waiting
+        uint32_t contended_latency_max_us;   // Their worst queue-to-wire time
+        uint64_t contended_latency_total_us; // Sum over them, for averaging
+    };
+    
     UdpTransport(const char* server_ip, uint16_t port);
-    ~UdpTransport();
+    ~UdpTransport() override;
     
-    bool connect();
-    void disconnect();
+    /**
+     * @brief Pin the receive and send tasks to a core (before connect())
+     * 
+     * @param core Core id, or tskNO_AFFINITY (the default)
+     */
+    void setTaskAffinity(BaseType_t core) { m_task_core = core; }
     
-    int32_t send(const uint8_t* data, size_t length);
-    int32_t receive(uint8_t* buffer, size_t buffer_size);
+    /**
+     * @brief Have the receive task open the socket, and wait for it
+     * 
+     * Starts the receive and send tasks on first use.
+     * 
+     * @return false if the socket could not be opened within CONNECT_TIMEOUT_MS
+     */
+    bool connect() override;
     
-    bool isConnected() const { return m_connected; }
+    /**
+     * @brief Stop sending and receiving; the receive task closes the socket
+     */
+    void disconnect() override;
+    
+    /**
+     * @brief Queue a datagram for the sender task
+     * 
+     * Uses the traffic class set by the innermost TrafficClassScope
+     * (CONTROL by default). Never blocks.
+     * 
+     * @return Number of bytes queued, or -1 if the datagram was dropped
+     */
+    int32_t send(const uint8_t* data, size_t length) override;
+    
+    /**
+     * @brief Hand the oldest queued datagram to the caller
+     * 
+     * Datagrams that do not fit buffer_size are dropped and counted in
+     * RxStats::too_large.
+     * 
+     * @return Datagram length, or 0 if nothing is queued
+     */
+    int32_t receive(uint8_t* buffer, size_t buffer_size) override;
+    
+    /**
+     * @brief Check whether a datagram is waiting for the consumer
+     */
+    bool hasPendingData() const override { return !m_rx_ready.empty(); }
+    
+    /**
+     * @brief Block until a datagram is queued, wakeup() is called or
+     *        the timeout expires
+     * 
+     * @param timeout_ms Maximum time to wait
+     * @return true if a datagram is ready to be read
+     */
+    bool waitForActivity(uint32_t timeout_ms) override;
+    
+    /**
+     * @brief Interrupt a pending waitForActivity() from another task
+     */
+    void wakeup() override;
+    
+    bool isConnected() const override { return m_connected; }
+    uint32_t getRxPacketCount() const override { return m_rx_packets; }
+    size_t getRxBacklog() const override { return m_rx_ready.size(); }
+    TransportMetrics getMetrics() const override;
+    TrafficClassMetrics getClassMetrics(TrafficClass tc) const override;
+    RxStats getRxStats() const;
+    TxStats getTxStats(TrafficClass tc) const;
     
 private:
+    struct RxSlot {
+        uint16_t length;
+        uint8_t data[RX_SLOT_SIZE + 1];     // A datagram that fills the spare byte did not fit
+    };
+    
+    struct TxSlot {
+        uint16_t length;
+        TrafficClass tc;
+        bool contended;                 // The other class had datagrams waiting
+        int64_t queued_at_us;
+        uint8_t data[TX_SLOT_SIZE];
+    };
+    
+    static void rxTaskEntry(void* arg);
+    void rxTask();
+    void releaseRxSlot(uint8_t index);
+    int openSocket();
+    void closeSocket();
+    static void txTaskEntry(void* arg);
+    void txTask();
+    void transmit(TxSlot& slot);
+    void releaseTxSlot(uint8_t index);
+    
     const char* m_server_ip;
     uint16_t m_port;
-    int m_socket;
-    bool m_connected;
+    std::atomic<int> m_socket;                                // Opened and closed by the receive task only
+    int m_wakeup_fd;
+    std::atomic<bool> m_connected;                            // Requested by connect()/disconnect()
+    uint32_t m_rx_packets;
+    uint64_t m_rx_bytes;
     struct sockaddr_in m_server_addr;
+    BaseType_t m_task_core;
+    
+    TaskHandle_t m_rx_task;
+    RxStats m_rx_stats;                                       // Written by the receive task only
+    RxSlot m_rx_pool[RX_POOL_SLOTS];
+    LockFree::SpscRing<uint8_t, RX_POOL_SLOTS> m_rx_ready;   // Receive task -> consumer
+    LockFree::SpscRing<uint8_t, RX_POOL_SLOTS> m_rx_free;    // Consumer -> receive task
+    std::atomic<bool> m_rx_starved;                           // Receive task waits for m_rx_free
+    uint32_t m_rx_too_large;                                  // Written by the consumer only
+    
+    // Any task may publish, so the TX side uses FreeRTOS queues (MPMC)
+    // of slot indices rather than SPSC rings
+    TaskHandle_t m_tx_task;
+    std::atomic<bool> m_tx_busy;                              // Sender task is using m_socket
+    std::atomic<uint32_t> m_socket_generation;                // Bumped for each socket opened
+    uint32_t m_tx_tos_generation;                             // Socket m_tx_tos was set on
+    int m_tx_tos;                                             // TOS currently set on the socket
+    TxStats m_tx_stats[static_cast<size_t>(TrafficClass::COUNT)];
+    TxSlot m_tx_pool[TX_POOL_SLOTS];
+    QueueHandle_t m_tx_free;                                  // Slots any class may take
+    QueueHandle_t m_tx_free_control;                          // The TX_CONTROL_SLOTS held back
+    QueueHandle_t m_tx_queues[static_cast<size_t>(TrafficClass::COUNT)];
 };
 
 } // namespace AVI
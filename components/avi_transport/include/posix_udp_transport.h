@@ -0,0 +1,58 @@
+/**
+ * @file posix_udp_transport.h
+ * @brief POSIX UDP transport for the ESP-IDF Linux host target
+ * 
+ * Same contract as UdpTransport, built on plain BSD sockets, poll() and
+ * eventfd so the transport path can be run and benchmarked on a Linux box
+ * (tools/transport_bench.cpp --posix).
+ * Sends are synchronous; traffic classes only select the IP_TOS marking.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <netinet/in.h>
+#include "transport.h"
+
+namespace AVI {
+
+class PosixUdpTransport : public Transport {
+public:
+    static constexpr uint8_t TOS_CONTROL = 0xB8;     // DSCP EF (46)
+    static constexpr uint8_t TOS_BULK = 0x28;        // DSCP AF11 (10)
+    
+    PosixUdpTransport(const char* server_ip, uint16_t port);
+    ~PosixUdpTransport() override;
+    
+    bool connect() override;
+    void disconnect() override;
+    bool isConnected() const override { return m_connected; }
+    
+    int32_t send(const uint8_t* data, size_t length) override;
+    int32_t receive(uint8_t* buffer, size_t buffer_size) override;
+    bool hasPendingData() const override;
+    bool waitForActivity(uint32_t timeout_ms) override;
+    void wakeup() override;
+    
+    uint32_t getRxPacketCount() const override { return m_metrics.rx_packets; }
+    
+    // The socket does not count its queued datagrams: 1 if any is waiting
+    size_t getRxBacklog() const override { return hasPendingData() ? 1 : 0; }
+    TransportMetrics getMetrics() const override { return m_metrics; }
+    TrafficClassMetrics getClassMetrics(TrafficClass tc) const override {
+        return m_class_metrics[static_cast<size_t>(tc)];
+    }
+    
+private:
+    const char* m_server_ip;
+    uint16_t m_port;
+    int m_socket;
+    int m_wakeup_fd;
+    int m_tos;
+    bool m_connected;
+    struct sockaddr_in m_server_addr;
+    TransportMetrics m_metrics;
+    TrafficClassMetrics m_class_metrics[static_cast<size_t>(TrafficClass::COUNT)];
+};
+
+} // namespace AVI
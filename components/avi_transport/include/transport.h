@@ -0,0 +1,133 @@
+/**
+ * @file transport.h
+ * @brief Platform-independent datagram transport interface
+ * 
+ * AviClient talks to the network only through this interface, so the
+ * protocol glue can run on the ESP32 (UdpTransport, lwIP) or on a Linux
+ * host (PosixUdpTransport) without changes.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AVI {
+
+/**
+ * @brief Transmit priority class
+ * 
+ * Control traffic (events, acks, small messages) always leaves the device
+ * before bulk stream data queued at the same time.
+ */
+enum class TrafficClass : uint8_t {
+    CONTROL = 0,
+    BULK,
+    COUNT
+};
+
+/**
+ * @brief Counters every transport implementation reports
+ */
+struct TransportMetrics {
+    uint32_t rx_packets;
+    uint32_t rx_dropped;
+    uint64_t rx_bytes;
+    uint32_t tx_packets;
+    uint32_t tx_dropped;   // Rejected before or by the socket
+    uint64_t tx_bytes;
+};
+
+/**
+ * @brief Send counters of one traffic class
+ */
+struct TrafficClassMetrics {
+    uint32_t accepted;          // Datagrams taken by send()
+    uint64_t accepted_bytes;    // Their length, counted as send() returns
+    uint32_t sent;              // Datagrams handed to the socket
+    uint32_t latency_max_us;    // Worst send()-to-socket time
+    uint64_t latency_total_us;  // Sum over sent datagrams, for averaging
+};
+
+/**
+ * @brief Datagram transport used by the AVI core
+ */
+class Transport {
+public:
+    virtual ~Transport() = default;
+    
+    virtual bool connect() = 0;
+    virtual void disconnect() = 0;
+    virtual bool isConnected() const = 0;
+    
+    /**
+     * @brief Send (or queue) one datagram with the current traffic class
+     * @return Number of bytes accepted, or -1 on failure
+     */
+    virtual int32_t send(const uint8_t* data, size_t length) = 0;
+    
+    /**
+     * @brief Read one datagram without blocking
+     * @return Datagram length, 0 if nothing is waiting, -1 on error
+     */
+    virtual int32_t receive(uint8_t* buffer, size_t buffer_size) = 0;
+    
+    /**
+     * @brief Check whether receive() would return a datagram
+     */
+    virtual bool hasPendingData() const = 0;
+    
+    /**
+     * @brief Block until a datagram is waiting, wakeup() is called or
+     *        the timeout expires
+     * 
+     * @return true if a datagram is ready to be read
+     */
+    virtual bool waitForActivity(uint32_t timeout_ms) = 0;
+    
+    /**
+     * @brief Interrupt a pending waitForActivity() from another task
+     */
+    virtual void wakeup() = 0;
+    
+    /**
+     * @brief Datagrams handed out by receive() so far (cheap, no locking)
+     */
+    virtual uint32_t getRxPacketCount() const = 0;
+    
+    /**
+     * @brief Datagrams received and waiting for receive() (cheap, no locking)
+     */
+    virtual size_t getRxBacklog() const = 0;
+    
+    virtual TransportMetrics getMetrics() const = 0;
+    virtual TrafficClassMetrics getClassMetrics(TrafficClass tc) const = 0;
+    
+    TrafficClass getTrafficClass() const { return m_tx_class; }
+    void setTrafficClass(TrafficClass tc) { m_tx_class = tc; }
+    
+protected:
+    TrafficClass m_tx_class = TrafficClass::CONTROL;
+};
+
+/**
+ * @brief Mark every send() from the current scope with a traffic class
+ */
+class TrafficClassScope {
+public:
+    TrafficClassScope(Transport& transport, TrafficClass tc)
+        : m_transport(transport)
+        , m_previous(transport.getTrafficClass()) {
+        m_transport.setTrafficClass(tc);
+    }
+    ~TrafficClassScope() { m_transport.setTrafficClass(m_previous); }
+    
+    TrafficClassScope(const TrafficClassScope&) = delete;
+    TrafficClassScope& operator=(const TrafficClassScope&) = delete;
+    
+private:
+    Transport& m_transport;
+    TrafficClass m_previous;
+};
+
+} // namespace AVI
@@ -0,0 +1,210 @@
+/**
+ * @file posix_udp_transport.cpp
+ * @brief POSIX UDP Transport Implementation (Linux host target)
+ */
+
+#include "posix_udp_transport.h"
+#include "esp_log.h"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const char* TAG = "AVI_TRANSPORT";
+
+static int64_t monotonicUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+namespace AVI {
+
+PosixUdpTransport::PosixUdpTransport(const char* server_ip, uint16_t port)
+    : m_server_ip(server_ip)
+    , m_port(port)
+    , m_socket(-1)
+    , m_wakeup_fd(-1)
+    , m_tos(-1)
+    , m_connected(false)
+    , m_metrics{}
+    , m_class_metrics{} {
+    std::memset(&m_server_addr, 0, sizeof(m_server_addr));
+    
+    m_wakeup_fd = eventfd(0, EFD_NONBLOCK);
+    if (m_wakeup_fd < 0) {
+        ESP_LOGW(TAG, "Wakeup eventfd unavailable: errno %d", errno);
+    }
+}
+
+PosixUdpTransport::~PosixUdpTransport() {
+    disconnect();
+    if (m_wakeup_fd >= 0) {
+        close(m_wakeup_fd);
+    }
+}
+
+bool PosixUdpTransport::connect() {
+    if (m_connected) {
+        return true;
+    }
+    
+    m_socket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+    if (m_socket < 0) {
+        ESP_LOGE(TAG, "Failed to create socket: errno %d", errno);
+        return false;
+    }
+    
+    m_server_addr.sin_family = AF_INET;
+    m_server_addr.sin_port = htons(m_port);
+    
+    if (inet_pton(AF_INET, m_server_ip, &m_server_addr.sin_addr) != 1) {
+        ESP_LOGE(TAG, "Invalid server IP: %s", m_server_ip);
+        close(m_socket);
+        m_socket = -1;
+        return false;
+    }
+    
+    m_tos = -1;
+    m_connected = true;
+    wakeup();
+    ESP_LOGI(TAG, "UDP connected to %s:%d", m_server_ip, m_port);
+    return true;
+}
+
+void PosixUdpTransport::disconnect() {
+    if (m_socket >= 0) {
+        close(m_socket);
+        m_socket = -1;
+    }
+    m_connected = false;
+}
+
+int32_t PosixUdpTransport::send(const uint8_t* data, size_t length) {
+    if (!m_connected) {
+        ESP_LOGW(TAG, "UDP not connected");
+        return -1;
+    }
+    
+    TrafficClassMetrics& metrics = m_class_metrics[static_cast<size_t>(m_tx_class)];
+    int64_t started = monotonicUs();
+    
+    int tos = m_tx_class == TrafficClass::CONTROL ? TOS_CONTROL : TOS_BULK;
+    if (tos != m_tos) {
+        if (setsockopt(m_socket, IPPROTO_IP, IP_TOS, &tos, sizeof(tos)) == 0) {
+            m_tos = tos;
+        } else {
+            ESP_LOGW(TAG, "Failed to set IP_TOS 0x%02x: errno %d", tos, errno);
+        }
+    }
+    
+    ssize_t sent = sendto(m_socket, data, length, 0,
+                          reinterpret_cast<struct sockaddr*>(&m_server_addr),
+                          sizeof(m_server_addr));
+    
+    if (sent < 0) {
+        ESP_LOGE(TAG, "UDP send failed: errno %d", errno);
+        m_metrics.tx_dropped++;
+        return -1;
+    }
+    
+    m_metrics.tx_packets++;
+    m_metrics.tx_bytes += static_cast<uint64_t>(sent);
+    
+    // Synchronous: accepted and handed to the socket in the same call
+    uint32_t latency = static_cast<uint32_t>(monotonicUs() - started);
+    metrics.accepted++;
+    metrics.accepted_bytes += static_cast<uint64_t>(sent);
+    metrics.sent++;
+    metrics.latency_total_us += latency;
+    if (latency > metrics.latency_max_us) {
+        metrics.latency_max_us = latency;
+    }
+    return static_cast<int32_t>(sent);
+}
+
+int32_t PosixUdpTransport::receive(uint8_t* buffer, size_t buffer_size) {
+    if (!m_connected) {
+        return 0;
+    }
+    
+    ssize_t len = recv(m_socket, buffer, buffer_size, MSG_DONTWAIT);
+    if (len < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        ESP_LOGE(TAG, "UDP receive failed: errno %d", errno);
+        return -1;
+    }
+    
+    m_metrics.rx_packets++;
+    m_metrics.rx_bytes += static_cast<uint64_t>(len);
+    return static_cast<int32_t>(len);
+}
+
+bool PosixUdpTransport::hasPendingData() const {
+    if (!m_connected) {
+        return false;
+    }
+    
+    uint8_t probe;
+    return recv(m_socket, &probe, sizeof(probe), MSG_PEEK | MSG_DONTWAIT) >= 0;
+}
+
+bool PosixUdpTransport::waitForActivity(uint32_t timeout_ms) {
+    struct pollfd fds[2];
+    nfds_t count = 0;
+    
+    if (m_connected) {
+        fds[count].fd = m_socket;
+        fds[count].events = POLLIN;
+        count++;
+    }
+    if (m_wakeup_fd >= 0) {
+        fds[count].fd = m_wakeup_fd;
+        fds[count].events = POLLIN;
+        count++;
+    }
+    
+    int ready = poll(fds, count, static_cast<int>(timeout_ms));
+    if (ready < 0) {
+        if (errno != EINTR) {
+            ESP_LOGE(TAG, "poll failed: errno %d", errno);
+        }
+        return false;
+    }
+    
+    bool readable = false;
+    for (nfds_t i = 0; i < count; i++) {
+        if (!(fds[i].revents & POLLIN)) {
+            continue;
+        }
+        if (fds[i].fd == m_wakeup_fd) {
+            uint64_t value;
+            if (read(m_wakeup_fd, &value, sizeof(value)) < 0) {
+                ESP_LOGV(TAG, "Wakeup drain failed: errno %d", errno);
+            }
+        } else {
+            readable = true;
+        }
+    }
+    
+    return readable;
+}
+
+void PosixUdpTransport::wakeup() {
+    if (m_wakeup_fd >= 0) {
+        uint64_t one = 1;
+        if (write(m_wakeup_fd, &one, sizeof(one)) < 0) {
+            ESP_LOGV(TAG, "Wakeup failed: errno %d", errno);
+        }
+    }
+}
+
+} // namespace AVI
@@ -6,10 +6,11 @@
 #include "device_features.h"
 #include "device_config.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include <cstdint>
 #include <cstring>
-#include "led_strip.h"
 
-#ifdef FEATURE_AUDIO_OUTPUT
+#if defined(FEATURE_AUDIO_OUTPUT) || defined(FEATURE_MICROPHONE)
 #include "driver/i2s.h"
 #endif
 
@@ -25,7 +26,9 @@ namespace Features {
 
 ButtonFeature::ButtonFeature(AVI_AviEmbedded* avi)
     : m_avi(avi)
-    , m_button_controller(nullptr) {
+    , m_button_controller(nullptr)
+    , m_connected(false)
+    , m_events_dropped(0) {
 }
 
 bool ButtonFeature::init() {
@@ -53,6 +56,10 @@ bool ButtonFeature::init() {
     return true;
 }
 
+Feature::Schedule ButtonFeature::getSchedule() const {
+    return {BUTTON_SAMPLE_PERIOD_MS * 1000, BUTTON_SAMPLE_DEADLINE_MS * 1000};
+}
+
 bool ButtonFeature::start() {
     ESP_LOGI(TAG, "Button feature started");
     return true;
@@ -68,28 +75,49 @@ void ButtonFeature::stop() {
     ESP_LOGI(TAG, "Button feature stopped");
 }
 
+static const char* const BUTTON_NAMES[6] = {"REC", "MODE", "PLAY", "SET", "VOL-", "VOL+"};
+
 void ButtonFeature::handleButtonEvent(uint8_t button_id, bool pressed) {
-    const char* button_names[6] = {"REC", "MODE", "PLAY", "SET", "VOL-", "VOL+"};
-    
+    // Input task: hand the event to the network task, which owns the AVI handle
     const char* state_str = pressed ? "pressed" : "released";
     ESP_LOGI(TAG, "Button %d (%s) %s", button_id, 
-             button_id < 6 ? button_names[button_id] : "UNKNOWN", state_str);
+             button_id < 6 ? BUTTON_NAMES[button_id] : "UNKNOWN", state_str);
+    
+    if (pressed && m_local_handler) {
+        m_local_handler(button_id);
+    }
     
-    char payload[128];
-    snprintf(payload, sizeof(payload),
-             "{\"button\":%d,\"name\":\"%s\"}",
-             button_id,
-             button_id < 6 ? button_names[button_id] : "UNKNOWN");
+    if (!m_events.push({button_id, pressed})) {
+        m_events_dropped++;
+        ESP_LOGW(TAG, "Button queue full, event dropped");
+        return;
+    }
+    wakeNetwork();
+}
 
-    if (pressed) {
+void ButtonFeature::serviceNetwork() {
+    ButtonEvent event;
+    while (m_events.pop(event)) {
+        if (!m_connected) {
+            ESP_LOGD(TAG, "Offline, button event not sent");
+            continue;
+        }
+        if (!event.pressed) {
+            continue;
+        }
+        
+        char payload[128];
+        snprintf(payload, sizeof(payload),
+                 "{\"button\":%d,\"name\":\"%s\"}",
+                 event.button_id,
+                 event.button_id < 6 ? BUTTON_NAMES[event.button_id] : "UNKNOWN");
+        
         uint8_t press_type = 0; // Single press
-        int ret = avi_embedded_button_pressed(m_avi, button_id, press_type, payload, strlen(payload));
+        int ret = avi_embedded_button_pressed(m_avi, event.button_id, press_type, payload, strlen(payload));
         ESP_LOGD(TAG, "AVI button event sent [ret=%d]", ret);
     }
 }
 
-void ButtonFeature::handleMessage(const char* topic, size_t topic_len,
-                               const uint8_t* data, size_t data_len) {}
 #endif // FEATURE_BUTTON_INPUT
 
 // ============================================================================
@@ -101,7 +129,8 @@ void ButtonFeature::handleMessage(const char* topic, size_t topic_len,
 LedFeature::LedFeature(AVI_AviEmbedded* avi)
     : m_avi(avi)
     , m_leds(nullptr)
-    , m_connected(false) {
+    , m_connected(false)
+    , m_commands_dropped(0) {
 }
 
 bool LedFeature::init() {
@@ -109,30 +138,33 @@ bool LedFeature::init() {
     
     m_leds = std::make_unique<LedController>();
     
-    if (!m_leds->init()) {
+    if (!m_leds->init(PIN_LED_DATA)) {
         ESP_LOGE(TAG, "Failed to initialize LED controller");
         return false;
     }
-    
-    // Subscribe to LED control topics
-    const char* topics[] = {
-        TOPIC_LED_CONTROL,
-        TOPIC_LED_ANIMATION,
-        TOPIC_LED_CLEAR
-    };
-    
-    for (const char* topic : topics) {
-        int ret = avi_embedded_subscribe(m_avi, topic, strlen(topic));
-        if (ret == 0) {
-            ESP_LOGI(TAG, "  ✓ Subscribed to: %s", topic);
-        } else {
-            ESP_LOGW(TAG, "  ✗ Failed to subscribe to: %s", topic);
-        }
-    }
+    m_leds->setFrameRate(1000 / LED_UPDATE_PERIOD_MS);
     
     return true;
 }
 
+void LedFeature::onConnected() {
+    setConnected(true);
+}
+
+void LedFeature::registerTopics(TopicRouter& router) {
+    router.registerHandler(TopicId::LED_CONTROL, this);
+    router.registerHandler(TopicId::LED_ANIMATION, this);
+    router.registerHandler(TopicId::LED_CLEAR, this);
+}
+
+void LedFeature::onDisconnected() {
+    setConnected(false);
+}
+
+Feature::Schedule LedFeature::getSchedule() const {
+    return {LED_UPDATE_PERIOD_MS * 1000, LED_UPDATE_DEADLINE_MS * 1000};
+}
+
 bool LedFeature::start() {
     // Start with boot animation
     m_leds->setAnimation(RAINBOW_PULSE, 5000);
@@ -141,9 +173,16 @@ bool LedFeature::start() {
 }
 
 void LedFeature::update() {
-    if (m_leds) {
-        m_leds->update(m_connected);
+    if (!m_leds) {
+        return;
     }
+    
+    LedCommand command;
+    while (m_commands.pop(command)) {
+        applyCommand(command);
+    }
+    
+    m_leds->update(m_connected.load(std::memory_order_relaxed));
 }
 
 void LedFeature::stop() {
@@ -157,43 +196,98 @@ void LedFeature::setConnected(bool connected) {
     m_connected = connected;
 }
 
-void LedFeature::handleMessage(const char* topic, size_t topic_len,
-                               const uint8_t* data, size_t data_len) {
+void LedFeature::logStats() const {
+    if (!m_leds) {
+        return;
+    }
+    const LedStats& stats = m_leds->getStats();
+    ESP_LOGI(TAG, "LED: %lu frames, %lu refreshes, %lu skipped unchanged, %lu dropped busy, "
+             "%lu errors, show %lu/%lu us avg/max, %lu FPS, %lu slowdowns, %lu commands dropped",
+             (unsigned long)stats.frames,
+             (unsigned long)stats.refreshes,
+             (unsigned long)stats.skipped,
+             (unsigned long)stats.busy,
+             (unsigned long)stats.errors,
+             (unsigned long)(stats.frames > 0 ? stats.show_us / stats.frames : 0),
+             (unsigned long)stats.show_max_us,
+             (unsigned long)(stats.frame_us > 0 ? 1000000 / stats.frame_us : 0),
+             (unsigned long)stats.slowdowns,
+             (unsigned long)m_commands_dropped);
+}
+
+void LedFeature::handleMessage(TopicId topic, const uint8_t* data, size_t data_len) {
     if (data_len == 0) return;
     
-    std::string topic_str(topic, topic_len);
-    std::string payload(reinterpret_cast<const char*>(data), data_len);
+    // NUL-terminated copy on the stack for sscanf; LED payloads are short
+    char payload[96];
+    size_t len = data_len < sizeof(payload) - 1 ? data_len : sizeof(payload) - 1;
+    memcpy(payload, data, len);
+    payload[len] = '\0';
+    
+    ESP_LOGI(TAG, "LED message on '%s': %s", TopicRouter::name(topic), payload);
     
-    ESP_LOGI(TAG, "LED message on '%s': %s", topic_str.c_str(), payload.c_str());
+    // Parse here in the network task, apply in the render task
+    LedCommand command = {};
+    command.topic = topic;
     
-    // LED Control: "index,r,g,b"
-    if (topic_str == TOPIC_LED_CONTROL) {
-        int index, r, g, b;
-        if (sscanf(payload.c_str(), "%d,%d,%d,%d", &index, &r, &g, &b) == 4) {
-            if (index >= 0 && index < LED_COUNT) {
-                m_leds->setLed(index, RgbColor(r, g, b));
-                ESP_LOGI(TAG, "Set LED %d to RGB(%d,%d,%d)", index, r, g, b);
+    switch (topic) {
+        // LED Control: "index,r,g,b"
+        case TopicId::LED_CONTROL: {
+            int r, g, b;
+            if (sscanf(payload, "%d,%d,%d,%d", &command.index, &r, &g, &b) != 4 ||
+                command.index < 0 || command.index >= LED_COUNT) {
+                return;
             }
+            command.r = r;
+            command.g = g;
+            command.b = b;
+            break;
         }
-    }
-    // LED Animation: "animation_id,duration[,config]"
-    else if (topic_str == TOPIC_LED_ANIMATION) {
-        int animation_id;
-        long duration;
-        char config[64] = "";
-        
-        int parsed = sscanf(payload.c_str(), "%d,%ld,%63s", 
-                           &animation_id, &duration, config);
         
-        if (parsed >= 2) {
-            m_leds->setAnimation(animation_id, duration, config);
-            ESP_LOGI(TAG, "Set animation %d, duration %ld", animation_id, duration);
+        // LED Animation: "animation_id,duration[,config]"
+        case TopicId::LED_ANIMATION: {
+            int parsed = sscanf(payload, "%d,%ld,%63s", 
+                               &command.animation_id, &command.duration, command.config);
+            if (parsed < 2) {
+                return;
+            }
+            break;
         }
+        
+        // LED Clear: "CLEAR"
+        case TopicId::LED_CLEAR:
+            break;
+        
+        default:
+            return;
     }
-    // LED Clear: "CLEAR"
-    else if (topic_str == TOPIC_LED_CLEAR) {
-        m_leds->clear();
-        ESP_LOGI(TAG, "Cleared all LEDs");
+    
+    if (!m_commands.push(command)) {
+        m_commands_dropped++;
+        ESP_LOGW(TAG, "LED command queue full, message dropped");
+    }
+}
+
+void LedFeature::applyCommand(const LedCommand& command) {
+    switch (command.topic) {
+        case TopicId::LED_CONTROL:
+            m_leds->setLed(command.index, RgbColor(command.r, command.g, command.b));
+            ESP_LOGI(TAG, "Set LED %d to RGB(%d,%d,%d)", command.index,
+                     command.r, command.g, command.b);
+            break;
+        
+        case TopicId::LED_ANIMATION:
+            m_leds->setAnimation(command.animation_id, command.duration, command.config);
+            ESP_LOGI(TAG, "Set animation %d, duration %ld", command.animation_id, command.duration);
+            break;
+        
+        case TopicId::LED_CLEAR:
+            m_leds->clear();
+            ESP_LOGI(TAG, "Cleared all LEDs");
+            break;
+        
+        default:
+            break;
     }
 }
 
@@ -215,7 +309,7 @@ bool AudioFeature::init() {
     // Configure I2S
     i2s_config_t i2s_config = {
         .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),
-        .sample_rate = 44100,
+        .sample_rate = AUDIO_SAMPLE_RATE,
         .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
         .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,
         .communication_format = I2S_COMM_FORMAT_STAND_I2S,
@@ -246,56 +340,429 @@ bool AudioFeature::init() {
         return false;
     }
     
-    // Subscribe to audio data topic
-    int sub_ret = avi_embedded_subscribe(m_avi, TOPIC_AUDIO_DATA, strlen(TOPIC_AUDIO_DATA));
-    if (sub_ret == 0) {
-        ESP_LOGI(TAG, "  ✓ Subscribed to: %s", TOPIC_AUDIO_DATA);
-    } else {
-        ESP_LOGW(TAG, "  ✗ Failed to subscribe to: %s", TOPIC_AUDIO_DATA);
+    const TaskConfig& task = getTaskConfig(TaskDomain::AUDIO);
+    Audio::AudioPlayer::Config player_config = {
+        .port = I2S_NUM_0,
+        .sample_rate = AUDIO_SAMPLE_RATE,
+        .channels = AUDIO_CHANNELS,
+        .prebuffer_ms = AUDIO_PREBUFFER_MS,
+        .max_depth_ms = AUDIO_JITTER_MAX_MS,
+        .jitter_multiplier = AUDIO_JITTER_MULTIPLIER,
+        .low_water_ms = AUDIO_LOW_WATER_MS,
+        .fade_ms = AUDIO_FADE_MS,
+        .flush_timeout_ms = AUDIO_FLUSH_TIMEOUT_MS,
+        .drift = {
+            .max_ppm = AUDIO_DRIFT_MAX_PPM,
+            .time_constant_s = AUDIO_DRIFT_TIME_S,
+            .filter_ms = AUDIO_DRIFT_FILTER_MS
+        },
+        .mixer = {
+            .sample_rate = AUDIO_SAMPLE_RATE,
+            .channels = AUDIO_CHANNELS,
+            .gain_db = {AUDIO_GAIN_STREAM_DB, AUDIO_GAIN_EARCON_DB, AUDIO_GAIN_TONE_DB},
+            .duck_db = AUDIO_DUCK_DB,
+            .duck_attack_ms = AUDIO_DUCK_ATTACK_MS,
+            .duck_release_ms = AUDIO_DUCK_RELEASE_MS,
+            .volume_steps = AUDIO_VOLUME_STEPS,
+            .volume_step_db = AUDIO_VOLUME_STEP_DB,
+            .volume = AUDIO_VOLUME_DEFAULT
+        },
+        .volume_tick_hz = AUDIO_VOLUME_TICK_HZ,
+        .volume_tick_ms = AUDIO_VOLUME_TICK_MS,
+        .task_name = task.name,
+        .task_stack_size = task.stack_size,
+        .task_priority = task.priority,
+        .task_core = task.core
+    };
+    
+    if (!m_player.init(player_config)) {
+        return false;
     }
     
+    // Optional: without the partition every sound comes from the server
+    if (!m_earcons.open(AUDIO_EARCON_PARTITION)) {
+        ESP_LOGW(TAG, "Earcons unavailable");
+    }
     return true;
 }
 
+void AudioFeature::onConnected() {
+    // Advertise what the player decodes so the server can pick the
+    // smallest codec instead of sending raw PCM, and the rates it converts
+    char payload[160];
+    int len = snprintf(payload, sizeof(payload), "{\"audio\":{\"codecs\":[");
+    for (size_t i = 0; i < sizeof(Audio::AudioPlayer::CODECS) / sizeof(Audio::AudioPlayer::CODECS[0]); i++) {
+        len += snprintf(payload + len, sizeof(payload) - len, "%s\"%s\"",
+                        i > 0 ? "," : "", Audio::codecName(Audio::AudioPlayer::CODECS[i]));
+    }
+    len += snprintf(payload + len, sizeof(payload) - len,
+                    "],\"sample_rate\":%d,\"channels\":%d,\"min_rate\":%lu,\"max_rate\":%lu,\"earcons\":%u}}",
+                    AUDIO_SAMPLE_RATE, AUDIO_CHANNELS,
+                    (unsigned long)Audio::AudioPlayer::MIN_INPUT_RATE,
+                    (unsigned long)AUDIO_SAMPLE_RATE * Audio::Resampler::MAX_RATIO,
+                    (unsigned)m_earcons.count());
+    
+    int ret = avi_embedded_publish(m_avi, TOPIC_STATUS, strlen(TOPIC_STATUS),
+                                   (const uint8_t*)payload, len);
+    if (ret != 0) {
+        ESP_LOGW(TAG, "Failed to publish audio capabilities: %d", ret);
+    }
+}
+
+void AudioFeature::registerTopics(TopicRouter& router) {
+    router.registerHandler(TopicId::AUDIO_DATA, this);
+    router.registerHandler(TopicId::AUDIO_EARCON, this);
+    router.registerHandler(TopicId::AUDIO_TONE, this);
+}
+
 bool AudioFeature::start() {
+    if (!m_player.start()) {
+        return false;
+    }
     ESP_LOGI(TAG, "Audio feature started");
     return true;
 }
 
 void AudioFeature::update() {
-    // Audio is event-driven via AVI messages
+    // Playback runs in the AudioPlayer task
 }
 
 void AudioFeature::stop() {
+    m_player.stop();
     i2s_driver_uninstall(I2S_NUM_0);
     ESP_LOGI(TAG, "Audio feature stopped");
 }
 
-void AudioFeature::handleMessage(const char* topic, size_t topic_len,
-                                 const uint8_t* data, size_t data_len) {
+void AudioFeature::handleMessage(TopicId topic, const uint8_t* data, size_t data_len) {
     if (data_len == 0) return;
     
-    std::string topic_str(topic, topic_len);
-    if (topic_str == TOPIC_AUDIO_DATA) {
-	    size_t bytes_written;
-		esp_err_t ret = i2s_write(I2S_NUM_0, data, data_len, &bytes_written, portMAX_DELAY);
-    
-	    if (ret != ESP_OK) {
-		    ESP_LOGW(TAG, "I2S write failed: %s", esp_err_to_name(ret));
-	    } else {
-	        ESP_LOGD(TAG, "🔊 Played %zu bytes of audio", bytes_written);
-	    }
-	}
+    if (topic == TopicId::AUDIO_DATA) {
+        // Network task: queue for the playback task, never wait on I2S here
+        if (!m_player.write(data, data_len)) {
+            ESP_LOGD(TAG, "Audio packet dropped (%zu bytes)", data_len);
+        }
+    } else if (topic == TopicId::AUDIO_EARCON) {
+        // Earcon: "id"
+        char payload[16];
+        size_t len = data_len < sizeof(payload) - 1 ? data_len : sizeof(payload) - 1;
+        memcpy(payload, data, len);
+        payload[len] = '\0';
+        
+        unsigned id;
+        Audio::EarconClip clip;
+        if (sscanf(payload, "%u", &id) != 1 || id > 0xFFFF || !m_earcons.find((uint16_t)id, clip)) {
+            ESP_LOGW(TAG, "Unknown earcon '%s'", payload);
+            return;
+        }
+        if (!m_player.playClip(clip)) {
+            ESP_LOGW(TAG, "Earcon %u not played", id);
+        }
+    } else if (topic == TopicId::AUDIO_TONE) {
+        // Tone: "hz,ms"
+        char payload[24];
+        size_t len = data_len < sizeof(payload) - 1 ? data_len : sizeof(payload) - 1;
+        memcpy(payload, data, len);
+        payload[len] = '\0';
+        
+        unsigned frequency_hz;
+        unsigned duration_ms;
+        if (sscanf(payload, "%u,%u", &frequency_hz, &duration_ms) != 2 ||
+            frequency_hz > 0xFFFF || duration_ms > 0xFFFF ||
+            !m_player.playTone((uint16_t)frequency_hz, (uint16_t)duration_ms)) {
+            ESP_LOGW(TAG, "Tone '%s' not played", payload);
+        }
+    }
+}
+
+uint8_t AudioFeature::stepVolume(int delta) {
+    uint8_t volume = m_player.stepVolume(delta);
+    ESP_LOGI(TAG, "Volume %u/%u", volume, m_player.getVolumeSteps());
+    return volume;
+}
+
+void AudioFeature::logStats() const {
+    Audio::AudioPlayer::Stats stats = m_player.getStats();
+    const auto& jitter = stats.jitter;
+    ESP_LOGI(TAG, "Audio: depth %lu/%lu pkts, jitter %lu us, %lu received, %lu played, "
+             "%lu lost, %lu late, %lu reordered, %lu dup, %lu overflow",
+             (unsigned long)jitter.depth_packets,
+             (unsigned long)jitter.target_packets,
+             (unsigned long)jitter.jitter_us,
+             (unsigned long)jitter.received,
+             (unsigned long)jitter.played,
+             (unsigned long)jitter.lost,
+             (unsigned long)jitter.late,
+             (unsigned long)jitter.reordered,
+             (unsigned long)jitter.duplicates,
+             (unsigned long)jitter.overflow);
+    ESP_LOGI(TAG, "Audio: %lu underruns, %lu rebuffers, %lu trimmed, %lu resyncs, %lu rejected, "
+             "%lu low-water dips, %llu played, %llu concealed bytes",
+             (unsigned long)jitter.underruns,
+             (unsigned long)jitter.rebuffers,
+             (unsigned long)jitter.trimmed,
+             (unsigned long)jitter.resyncs,
+             (unsigned long)stats.rejected,
+             (unsigned long)stats.low_water_dips,
+             (unsigned long long)stats.bytes_played,
+             (unsigned long long)stats.bytes_concealed);
+    if (stats.clips_played > 0 || stats.clips_rejected > 0) {
+        ESP_LOGI(TAG, "Audio: %lu earcons played, %lu rejected",
+                 (unsigned long)stats.clips_played,
+                 (unsigned long)stats.clips_rejected);
+    }
+    if (stats.tones_played > 0 || stats.tones_rejected > 0) {
+        ESP_LOGI(TAG, "Audio: %lu tones played, %lu rejected",
+                 (unsigned long)stats.tones_played,
+                 (unsigned long)stats.tones_rejected);
+    }
+    if (stats.frames_mixed > 0) {
+        ESP_LOGI(TAG, "Audio: volume %u/%u, mixer %lu cycles/frame",
+                 m_player.getVolume(), m_player.getVolumeSteps(),
+                 (unsigned long)(stats.mix_cycles / stats.frames_mixed));
+    }
+    if (stats.frames_resampled > 0) {
+        ESP_LOGI(TAG, "Audio: input %lu Hz, drift trim %ld ppm (excess %ld us), resampler %lu cycles/frame",
+                 (unsigned long)stats.input_rate,
+                 (long)stats.drift_ppm,
+                 (long)stats.drift_error_us,
+                 (unsigned long)(stats.resample_cycles / stats.frames_resampled));
+    }
+    if (stats.frames_decoded > 0) {
+        ESP_LOGI(TAG, "Audio: %llu frames decoded, %lu cycles/frame",
+                 (unsigned long long)stats.frames_decoded,
+                 (unsigned long)(stats.decode_cycles / stats.frames_decoded));
+    }
 }
 
 #endif // FEATURE_AUDIO_OUTPUT
 
+// ============================================================================
+// Microphone Feature
+// ============================================================================
+
+#ifdef FEATURE_MICROPHONE
+
+#ifdef FEATURE_LED_STRIP
+static_assert(PIN_MIC_BCK != PIN_LED_DATA && PIN_MIC_WS != PIN_LED_DATA &&
+              PIN_MIC_DATA_IN != PIN_LED_DATA, "Microphone pins clash with the LED data pin");
+#endif
+#ifdef FEATURE_AUDIO_OUTPUT
+static_assert(PIN_MIC_BCK != PIN_I2S_BCK && PIN_MIC_BCK != PIN_I2S_WS && PIN_MIC_BCK != PIN_I2S_DATA_OUT &&
+              PIN_MIC_WS != PIN_I2S_BCK && PIN_MIC_WS != PIN_I2S_WS && PIN_MIC_WS != PIN_I2S_DATA_OUT,
+              "Microphone clocks clash with the speaker I2S pins");
+#endif
+
+MicrophoneFeature::MicrophoneFeature(AVI_AviEmbedded* avi, AVI::Transport& transport)
+    : m_avi(avi)
+    , m_sender(avi, transport)
+    , m_task(nullptr)
+    , m_connected(false)
+    , m_vad_events_dropped(0) {
+}
+
+bool MicrophoneFeature::init() {
+    ESP_LOGI(TAG, "Initializing Microphone feature");
+    
+    // Port 0 is the speaker; the mic ADC has its own clocks on port 1
+    Audio::I2sCaptureSource::Config source_config = {
+        .port = I2S_NUM_1,
+        .sample_rate = MIC_SAMPLE_RATE,
+        .channels = MIC_CHANNELS,
+        .bck_pin = PIN_MIC_BCK,
+        .ws_pin = PIN_MIC_WS,
+        .data_in_pin = PIN_MIC_DATA_IN,
+        .dma_buf_count = MIC_DMA_BUF_COUNT,
+        .dma_buf_len = MIC_DMA_BUF_LEN
+    };
+    if (!m_source.init(source_config)) {
+        return false;
+    }
+    
+    StreamSender::Config sender_config = {
+        .mode = AUDIO_UPLINK_STREAM ? StreamSender::Mode::STREAM : StreamSender::Mode::PUBLISH,
+        .target = AUDIO_UPLINK_TARGET,
+        .reason = "microphone",
+        .topic = TOPIC_AUDIO_UPLINK,
+        .max_kbps = AUDIO_UPLINK_MAX_KBPS,
+        .burst_bytes = AUDIO_UPLINK_BURST_BYTES,
+        .max_age_ms = AUDIO_UPLINK_MAX_AGE_MS
+    };
+    m_sender.configure(sender_config);
+    
+    Audio::Vad::Config vad_config = {
+        .threshold_db = MIC_VAD_THRESHOLD_DB,
+        .min_level_dbfs = MIC_VAD_MIN_LEVEL_DBFS,
+        .max_zcr_permille = MIC_VAD_MAX_ZCR,
+        .onset_frames = (uint8_t)((MIC_VAD_ONSET_MS + MIC_FRAME_MS - 1) / MIC_FRAME_MS),
+        .hangover_frames = (uint16_t)((MIC_VAD_HANGOVER_MS + MIC_FRAME_MS - 1) / MIC_FRAME_MS)
+    };
+    m_vad.configure(vad_config);
+    
+    Audio::MicFramer::Config framer_config = {
+        .sample_rate = MIC_SAMPLE_RATE,
+        .channels = MIC_CHANNELS,
+        .frame_ms = MIC_FRAME_MS,
+        .preroll_ms = MIC_VAD_PREROLL_MS
+    };
+    if (!m_framer.init(framer_config, &m_source, &m_sender, MIC_VAD ? &m_vad : nullptr)) {
+        ESP_LOGE(TAG, "Microphone frame of %d ms does not fit a %zu byte packet, "
+                 "or no memory for the pre-roll", MIC_FRAME_MS, StreamSender::MAX_PACKET);
+        return false;
+    }
+    
+    ESP_LOGI(TAG, "Microphone: %d Hz, %d ch, %zu frames (%zu bytes) per packet",
+             MIC_SAMPLE_RATE, MIC_CHANNELS, m_framer.getFrameFrames(), m_framer.getPacketSize());
+    return true;
+}
+
+bool MicrophoneFeature::start() {
+    if (m_task) {
+        return true;
+    }
+    if (!m_source.start()) {
+        ESP_LOGE(TAG, "Failed to start I2S capture");
+        return false;
+    }
+    
+    const TaskConfig& task = getTaskConfig(TaskDomain::CAPTURE);
+    BaseType_t ok = xTaskCreatePinnedToCore(&MicrophoneFeature::taskEntry, task.name,
+                                            task.stack_size, this, task.priority,
+                                            &m_task, task.core);
+    if (ok != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create capture task");
+        m_task = nullptr;
+        m_source.stop();
+        return false;
+    }
+    
+    if (!MIC_VAD) {
+        m_sender.begin();
+    }
+    ESP_LOGI(TAG, "Microphone feature started");
+    return true;
+}
+
+void MicrophoneFeature::update() {
+    // Capture runs in its own task, paced by I2S
+}
+
+void MicrophoneFeature::stop() {
+    if (m_task) {
+        vTaskDelete(m_task);
+        m_task = nullptr;
+    }
+    m_source.stop();
+    m_sender.shutdown();
+    ESP_LOGI(TAG, "Microphone feature stopped");
+}
+
+void MicrophoneFeature::onConnected() {
+    m_connected = true;
+    m_sender.onConnected();
+}
+
+void MicrophoneFeature::onDisconnected() {
+    m_connected = false;
+    m_sender.onDisconnected();
+}
+
+void MicrophoneFeature::serviceNetwork() {
+    // Send first, so a start event carries the id of the stream it opened
+    m_sender.service();
+    
+    VadEvent event;
+    while (m_vad_events.pop(event)) {
+        if (!m_connected) {
+            continue;
+        }
+        char payload[64];
+        int len = snprintf(payload, sizeof(payload), "{\"speech\":%s,\"stream\":%u}",
+                           event.speech ? "true" : "false", (unsigned)m_sender.getStreamId());
+        int ret = avi_embedded_publish(m_avi, TOPIC_AUDIO_VAD, strlen(TOPIC_AUDIO_VAD),
+                                       (const uint8_t*)payload, len);
+        if (ret != 0) {
+            ESP_LOGD(TAG, "VAD event not sent: %d", ret);
+        }
+    }
+}
+
+void MicrophoneFeature::taskEntry(void* arg) {
+    static_cast<MicrophoneFeature*>(arg)->taskLoop();
+}
+
+void MicrophoneFeature::taskLoop() {
+    while (true) {
+        Audio::Vad::Event event;
+        if (m_framer.captureFrame(&event)) {
+            if (event != Audio::Vad::Event::NONE) {
+                bool speech = event == Audio::Vad::Event::ONSET;
+                if (speech) {
+                    m_sender.begin();
+                } else {
+                    m_sender.end();
+                }
+                if (!m_vad_events.push({speech})) {
+                    m_vad_events_dropped++;
+                }
+            }
+            wakeNetwork();
+        } else {
+            // Read error: back off instead of spinning on a broken port
+            vTaskDelay(pdMS_TO_TICKS(MIC_FRAME_MS));
+        }
+    }
+}
+
+void MicrophoneFeature::logStats() const {
+    Audio::MicFramer::Stats capture = m_framer.getStats();
+    StreamSender::Stats sender = m_sender.getStats();
+    uint32_t latency_avg_us = sender.sent > 0 ? (uint32_t)(sender.latency_total_us / sender.sent) : 0;
+    ESP_LOGI(TAG, "Mic: %lu frames, %lu dropped, %lu overruns, %lu read errors; "
+             "%lu sent, %lu stale, %lu send errors, latency %lu/%lu us avg/max",
+             (unsigned long)capture.frames,
+             (unsigned long)capture.dropped,
+             (unsigned long)capture.overruns,
+             (unsigned long)capture.read_errors,
+             (unsigned long)sender.sent,
+             (unsigned long)sender.stale,
+             (unsigned long)sender.send_errors,
+             (unsigned long)latency_avg_us,
+             (unsigned long)sender.latency_max_us);
+    ESP_LOGI(TAG, "Uplink: %llu payload bytes, %llu on the wire, send %lu/%lu us avg/max, "
+             "bulk send-to-socket %lu/%lu us avg/max",
+             (unsigned long long)sender.payload_bytes,
+             (unsigned long long)sender.wire_bytes,
+             (unsigned long)(sender.sent > 0 ? sender.send_total_us / sender.sent : 0),
+             (unsigned long)sender.send_max_us,
+             (unsigned long)(sender.bulk_sent > 0 ? sender.bulk_latency_total_us / sender.bulk_sent : 0),
+             (unsigned long)sender.bulk_latency_max_us);
+    
+    if (MIC_VAD) {
+        const Audio::Vad::Stats& vad = m_vad.getStats();
+        ESP_LOGI(TAG, "VAD: %lu onsets, speech %lu/%lu frames, %lu gated, level %d dBFS, "
+                 "floor %d dBFS, zcr %u, %lu cycles/frame, %lu events dropped",
+                 (unsigned long)vad.onsets,
+                 (unsigned long)vad.speech_frames,
+                 (unsigned long)vad.frames,
+                 (unsigned long)capture.gated,
+                 vad.level_dbfs,
+                 vad.floor_dbfs,
+                 (unsigned)vad.zcr_permille,
+                 (unsigned long)(vad.frames > 0 ? vad.cycles / vad.frames : 0),
+                 (unsigned long)m_vad_events_dropped);
+    }
+}
+
+#endif // FEATURE_MICROPHONE
+
 // ============================================================================
 // Feature Manager
 // ============================================================================
 
 FeatureManager::FeatureManager(AVI_AviEmbedded* avi)
-    : m_avi(avi) {
+    : m_avi(avi)
+    , m_task_args{}
+    , m_tasks{} {
 }
 
 void FeatureManager::addFeature(std::unique_ptr<Feature> feature) {
@@ -313,6 +780,7 @@ bool FeatureManager::initAll() {
             ESP_LOGE(TAG, "Failed to initialize feature: %s", feature->getName());
             return false;
         }
+        feature->registerTopics(m_router);
     }
     
     return true;
@@ -321,42 +789,217 @@ bool FeatureManager::initAll() {
 bool FeatureManager::startAll() {
     ESP_LOGI(TAG, "Starting all features");
     
+    m_schedule.clear();
+    int64_t now = esp_timer_get_time();
+    
     for (auto& feature : m_features) {
+        feature->m_wake_network = m_network_wakeup;
+        
         if (!feature->start()) {
             ESP_LOGE(TAG, "Failed to start feature: %s", feature->getName());
             return false;
         }
+        
+        TaskDomain domain = feature->getDomain();
+        Feature::Schedule schedule = feature->getSchedule();
+        if (schedule.period_us == 0) {
+            ESP_LOGI(TAG, "  %s: event-driven", feature->getName());
+            continue;
+        }
+        if (schedule.deadline_us == 0 || schedule.deadline_us > schedule.period_us) {
+            schedule.deadline_us = schedule.period_us;
+        }
+        
+        ESP_LOGI(TAG, "  %s: %s task, period %lu us, deadline %lu us", feature->getName(),
+                 getTaskConfig(domain).name,
+                 (unsigned long)schedule.period_us, (unsigned long)schedule.deadline_us);
+        m_schedule.push_back({feature.get(), domain, schedule, now, {}});
+    }
+    
+    return true;
+}
+
+bool FeatureManager::startTasks() {
+    for (size_t i = 0; i < static_cast<size_t>(TaskDomain::COUNT); i++) {
+        TaskDomain domain = static_cast<TaskDomain>(i);
+        if (domain == TaskDomain::NETWORK || m_tasks[i]) {
+            continue;
+        }
+        
+        bool scheduled = false;
+        for (const auto& entry : m_schedule) {
+            if (entry.domain == domain) {
+                scheduled = true;
+                break;
+            }
+        }
+        if (!scheduled) {
+            continue;
+        }
+        
+        const TaskConfig& config = getTaskConfig(domain);
+        m_task_args[i] = {this, domain};
+        BaseType_t ok = xTaskCreatePinnedToCore(&FeatureManager::domainTaskEntry, config.name,
+                                                config.stack_size, &m_task_args[i],
+                                                config.priority, &m_tasks[i], config.core);
+        if (ok != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create %s task", config.name);
+            return false;
+        }
+        ESP_LOGI(TAG, "Started %s task (prio %u, core %d)", config.name,
+                 (unsigned)config.priority, (int)config.core);
     }
     
     return true;
 }
 
-void FeatureManager::updateAll() {
+void FeatureManager::domainTaskEntry(void* arg) {
+    auto* task = static_cast<DomainTask*>(arg);
+    task->manager->runDomain(task->domain);
+}
+
+void FeatureManager::runDomain(TaskDomain domain) {
+    while (true) {
+        int64_t next_release = updateDue(domain, esp_timer_get_time());
+        
+        // Sleep until the next release; a notification ends the wait early
+        TickType_t ticks = portMAX_DELAY;
+        if (next_release != INT64_MAX) {
+            int64_t wait_us = next_release - esp_timer_get_time();
+            ticks = wait_us > 0 ? (TickType_t)((wait_us * configTICK_RATE_HZ + 999999) / 1000000) : 0;
+        }
+        if (ticks > 0) {
+            ulTaskNotifyTake(pdTRUE, ticks);
+        }
+    }
+}
+
+int64_t FeatureManager::updateDue(TaskDomain domain, int64_t now) {
+    int64_t next_release = INT64_MAX;
+    
+    for (auto& entry : m_schedule) {
+        if (entry.domain != domain) {
+            continue;
+        }
+        if (now >= entry.next_release_us) {
+            SchedStats& stats = entry.stats;
+            uint32_t lateness = (uint32_t)(now - entry.next_release_us);
+            
+            int64_t start = esp_timer_get_time();
+            entry.feature->update();
+            int64_t end = esp_timer_get_time();
+            uint32_t exec = (uint32_t)(end - start);
+            
+            stats.runs++;
+            stats.lateness_total_us += lateness;
+            if (lateness > stats.lateness_max_us) {
+                stats.lateness_max_us = lateness;
+            }
+            if (lateness > entry.schedule.deadline_us) {
+                stats.missed++;
+            }
+            if (exec > stats.exec_max_us) {
+                stats.exec_max_us = exec;
+            }
+            if (exec > entry.schedule.period_us) {
+                stats.overruns++;
+            }
+            
+            // Keep the release grid; if a whole period was lost, drop the
+            // backlog instead of running the feature back to back
+            entry.next_release_us += entry.schedule.period_us;
+            if (entry.next_release_us <= end) {
+                stats.skipped += (uint32_t)((end - entry.next_release_us) / entry.schedule.period_us) + 1;
+                entry.next_release_us = end + entry.schedule.period_us;
+            }
+            now = end;
+        }
+        
+        if (entry.next_release_us < next_release) {
+            next_release = entry.next_release_us;
+        }
+    }
+    
+    return next_release;
+}
+
+void FeatureManager::logStats() const {
+    for (const auto& entry : m_schedule) {
+        const SchedStats& stats = entry.stats;
+        ESP_LOGI(TAG, "Sched %s/%s: %lu runs, %lu missed, %lu skipped, %lu overruns, "
+                 "late avg %lu max %lu us, exec max %lu us",
+                 getTaskConfig(entry.domain).name,
+                 entry.feature->getName(),
+                 (unsigned long)stats.runs,
+                 (unsigned long)stats.missed,
+                 (unsigned long)stats.skipped,
+                 (unsigned long)stats.overruns,
+                 (unsigned long)(stats.runs ? stats.lateness_total_us / stats.runs : 0),
+                 (unsigned long)stats.lateness_max_us,
+                 (unsigned long)stats.exec_max_us);
+    }
+    
+    for (const auto& feature : m_features) {
+        feature->logStats();
+    }
+}
+
+void FeatureManager::serviceNetwork() {
     for (auto& feature : m_features) {
-        feature->update();
+        feature->serviceNetwork();
     }
 }
 
 void FeatureManager::stopAll() {
     ESP_LOGI(TAG, "Stopping all features");
     
+    for (size_t i = 0; i < static_cast<size_t>(TaskDomain::COUNT); i++) {
+        if (m_tasks[i]) {
+            vTaskDelete(m_tasks[i]);
+            m_tasks[i] = nullptr;
+        }
+    }
+    
     for (auto& feature : m_features) {
         feature->stop();
     }
 }
 
-void FeatureManager::handleMessage(const char* topic, size_t topic_len,
-                                   const uint8_t* data, size_t data_len) {
-    std::string topic_str(topic, topic_len);
+void FeatureManager::onConnected() {
+    ESP_LOGI(TAG, "Session up, subscribing");
     
-	
+    // Subscriptions do not survive a reconnect, renew every registered topic
+    for (size_t i = 0; i < static_cast<size_t>(TopicId::COUNT); i++) {
+        TopicId id = static_cast<TopicId>(i);
+        if (!m_router.hasHandlers(id)) {
+            continue;
+        }
+        
+        const char* topic = TopicRouter::name(id);
+        int ret = avi_embedded_subscribe(m_avi, topic, strlen(topic));
+        if (ret == 0) {
+            ESP_LOGI(TAG, "  ✓ Subscribed to: %s", topic);
+        } else {
+            ESP_LOGW(TAG, "  ✗ Failed to subscribe to: %s", topic);
+        }
+    }
+    
+    for (auto& feature : m_features) {
+        feature->onConnected();
+    }
+}
 
-    ESP_LOGI(TAG, "Recived msg from topi: %sc", topic);
+void FeatureManager::onDisconnected() {
+    ESP_LOGI(TAG, "Session down, notifying features");
     
-	// Route messages to appropriate features
-	//for (auto& feature : m_features) {
-    //    feature->handleMessage(topic, topic_len, data, data_len);
-    //}
+    for (auto& feature : m_features) {
+        feature->onDisconnected();
+    }
+}
+
+void FeatureManager::handleMessage(const char* topic, size_t topic_len,
+                                   const uint8_t* data, size_t data_len) {
+    m_router.dispatch(topic, topic_len, data, data_len);
 }
 
 } // namespace Features
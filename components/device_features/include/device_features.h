@@ -9,33 +9,29 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <vector>
 #include "avi_embedded.h"
+#include "audio_player.h"
+#include "earcon_bank.h"
+#include "i2s_capture_source.h"
+#include "mic_framer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 #include "board_korvo.h"
+#include "feature.h"
 #include "led_controller.h"
+#include "spsc_ring.h"
+#include "stream_sender.h"
+#include "task_layout.h"
+#include "topic_router.h"
+#include "transport.h"
 
 namespace Features {
 
-/**
- * @brief Base class for all device features
- * 
- * Features follow a lifecycle: init() -> start() -> update() -> stop()
- */
-class Feature {
-public:
-    virtual ~Feature() = default;
-    
-    virtual bool init() = 0;
-    virtual bool start() = 0;
-    virtual void update() = 0;
-    virtual void stop() = 0;
-	virtual void handleMessage(const char* topic, size_t topic_len,    
-                               const uint8_t* data, size_t data_len);
-    virtual const char* getName() const = 0;
-};
-
 /**
  * @brief Button input feature
  * 
@@ -52,14 +48,35 @@ public:
     void stop() override;
     
     const char* getName() const override { return "Button"; }
+    Schedule getSchedule() const override;
+    TaskDomain getDomain() const override { return TaskDomain::INPUT; }
+    
+    void onConnected() override { m_connected = true; }
+    void onDisconnected() override { m_connected = false; }
+    void serviceNetwork() override;
+    
+    /**
+     * @brief Act on presses on the device as well (before start())
+     * 
+     * Runs in the input task for every press, connected or not, before the
+     * event is queued for the server.
+     */
+    void setLocalHandler(std::function<void(uint8_t button_id)> handler) { m_local_handler = std::move(handler); }
     
 private:
+    struct ButtonEvent {
+        uint8_t button_id;
+        bool pressed;
+    };
+    
     void handleButtonEvent(uint8_t button_id, bool pressed);
     
-	void handleMessage(const char* topic, size_t topic_len,
-                               const uint8_t* data, size_t data_len);
     AVI_AviEmbedded* m_avi;
     std::unique_ptr<class Board::ButtonController> m_button_controller;
+    bool m_connected;                                  // Network task only
+    LockFree::SpscRing<ButtonEvent, 8> m_events;      // Input task -> network task
+    uint32_t m_events_dropped;
+    std::function<void(uint8_t)> m_local_handler;
 };
 
 /**
@@ -77,21 +94,46 @@ public:
     void stop() override;
     
     const char* getName() const override { return "LED"; }
+    Schedule getSchedule() const override;
+    TaskDomain getDomain() const override { return TaskDomain::RENDER; }
     
+    void onConnected() override;
+    void onDisconnected() override;
+    void registerTopics(TopicRouter& router) override;
     void setConnected(bool connected);
-    void handleMessage(const char* topic, size_t topic_len,
-                      const uint8_t* data, size_t data_len);
+    void handleMessage(TopicId topic, const uint8_t* data, size_t data_len) override;
+    void logStats() const override;
     
 private:
+    /**
+     * @brief Parsed LED message, applied by the render task
+     */
+    struct LedCommand {
+        TopicId topic;
+        int index;
+        uint8_t r, g, b;
+        int animation_id;
+        long duration;
+        char config[64];
+    };
+    
+    void applyCommand(const LedCommand& command);
+    
     AVI_AviEmbedded* m_avi;
     std::unique_ptr<class LedController> m_leds;
-    bool m_connected;
+    std::atomic<bool> m_connected;
+    LockFree::SpscRing<LedCommand, 8> m_commands;     // Network task -> render task
+    uint32_t m_commands_dropped;
 };
 
 /**
  * @brief Audio output feature
  * 
- * Receives audio data via AVI and plays through I2S
+ * Receives audio data via AVI and plays through I2S. Payloads are queued
+ * in the AudioPlayer ring; its own task on the AUDIO core drains them.
+ * TOPIC_AUDIO_EARCON plays a clip from the earcon partition by id, mixed
+ * over the stream, without a round trip to the server; TOPIC_AUDIO_TONE
+ * a beep synthesized on the device. The master volume is local too.
  */
 class AudioFeature : public Feature {
 public:
@@ -103,40 +145,171 @@ public:
     void stop() override;
     
     const char* getName() const override { return "Audio"; }
+    TaskDomain getDomain() const override { return TaskDomain::AUDIO; }
     
-    void handleMessage(const char* topic, size_t topic_len,
-                      const uint8_t* data, size_t data_len);
+    void onConnected() override;
+    void registerTopics(TopicRouter& router) override;
+    void handleMessage(TopicId topic, const uint8_t* data, size_t data_len) override;
+    void logStats() const override;
+    
+    /**
+     * @brief Step the master volume (any task, e.g. from the volume buttons)
+     */
+    uint8_t stepVolume(int delta);
+    
+private:
+    AVI_AviEmbedded* m_avi;
+    Audio::AudioPlayer m_player;
+    Audio::EarconBank m_earcons;
+};
+
+/**
+ * @brief Microphone uplink feature
+ * 
+ * A capture task (CAPTURE domain) blocks on I2S RX and frames each
+ * MIC_FRAME_MS of audio in place into a StreamSender slot; the network
+ * task sends the slots on an AVI stream in serviceNetwork(). With MIC_VAD
+ * the stream only runs during talkspurts, and their starts and ends are
+ * published on TOPIC_AUDIO_VAD.
+ */
+class MicrophoneFeature : public Feature {
+public:
+    MicrophoneFeature(AVI_AviEmbedded* avi, AVI::Transport& transport);
+    
+    bool init() override;
+    bool start() override;
+    void update() override;
+    void stop() override;
+    
+    const char* getName() const override { return "Microphone"; }
+    TaskDomain getDomain() const override { return TaskDomain::CAPTURE; }
+    
+    void onConnected() override;
+    void onDisconnected() override;
+    void serviceNetwork() override;
+    void logStats() const override;
     
 private:
+    struct VadEvent {
+        bool speech;                // Talkspurt started (true) or ended
+    };
+    
+    static void taskEntry(void* arg);
+    void taskLoop();
+    
     AVI_AviEmbedded* m_avi;
+    Audio::I2sCaptureSource m_source;
+    Audio::Vad m_vad;
+    Audio::MicFramer m_framer;
+    StreamSender m_sender;
+    TaskHandle_t m_task;
+    bool m_connected;
+    
+    LockFree::SpscRing<VadEvent, 8> m_vad_events;     // Capture task -> network task
+    uint32_t m_vad_events_dropped;
 };
 
 /**
  * @brief Feature Manager
  * 
- * Manages the lifecycle of all enabled features
+ * Manages the lifecycle of all enabled features and schedules their
+ * update() calls. Each periodic feature has a release time; updateDue()
+ * runs only the features whose release time has passed and reports when
+ * the next one is due, so the caller can sleep exactly that long.
  */
 class FeatureManager {
 public:
+    /**
+     * @brief Per-feature scheduling counters
+     */
+    struct SchedStats {
+        uint32_t runs;
+        uint32_t missed;             // Runs started later than the deadline
+        uint32_t skipped;            // Releases dropped because a run fell a full period behind
+        uint32_t overruns;           // Runs that took longer than the period
+        uint32_t lateness_max_us;
+        uint64_t lateness_total_us;  // Sum over all runs, for averaging
+        uint32_t exec_max_us;
+    };
+    
     explicit FeatureManager(AVI_AviEmbedded* avi);
     
     void addFeature(std::unique_ptr<Feature> feature);
     
     bool initAll();
     bool startAll();
-    void updateAll();
     void stopAll();
     
+    /**
+     * @brief Set how features wake the network task (before startAll())
+     */
+    void setNetworkWakeup(std::function<void()> wakeup) { m_network_wakeup = std::move(wakeup); }
+    
+    /**
+     * @brief Start one pinned task per non-network domain with scheduled features
+     * 
+     * NETWORK domain features are run by the caller's loop through
+     * updateDue(TaskDomain::NETWORK, ...).
+     */
+    bool startTasks();
+    
+    /**
+     * @brief Run every feature of a domain whose release time has passed
+     * 
+     * @param domain Domain served by the calling task
+     * @param now Current esp_timer time in microseconds
+     * @return Release time of the domain's next due feature, or INT64_MAX
+     *         if it has no periodic features
+     */
+    int64_t updateDue(TaskDomain domain, int64_t now);
+    
+    /**
+     * @brief Let features send the work queued by other domains (network task)
+     */
+    void serviceNetwork();
+    
+    /**
+     * @brief Log scheduling counters and each feature's own stats
+     */
+    void logStats() const;
+    
+    TaskHandle_t getTask(TaskDomain domain) const { return m_tasks[static_cast<size_t>(domain)]; }
+    
+    void onConnected();
+    void onDisconnected();
+    
+    /**
+     * @brief Entry point for the AVI message callback
+     */
     void handleMessage(const char* topic, size_t topic_len,
                       const uint8_t* data, size_t data_len);
     
-#ifdef FEATURE_LED_STRIP
-    void setLedConnected(bool connected);
-#endif
+    const TopicRouter& getRouter() const { return m_router; }
     
 private:
+    struct SchedEntry {
+        Feature* feature;
+        TaskDomain domain;
+        Feature::Schedule schedule;
+        int64_t next_release_us;
+        SchedStats stats;
+    };
+    
     AVI_AviEmbedded* m_avi;
     std::vector<std::unique_ptr<Feature>> m_features;
+    struct DomainTask {
+        FeatureManager* manager;
+        TaskDomain domain;
+    };
+    
+    static void domainTaskEntry(void* arg);
+    void runDomain(TaskDomain domain);
+    
+    std::vector<SchedEntry> m_schedule;   // Periodic features only, built by startAll()
+    std::function<void()> m_network_wakeup;
+    DomainTask m_task_args[static_cast<size_t>(TaskDomain::COUNT)];
+    TaskHandle_t m_tasks[static_cast<size_t>(TaskDomain::COUNT)];
+    TopicRouter m_router;
 };
 
 } // namespace Features
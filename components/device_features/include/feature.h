@@ -0,0 +1,80 @@
+/**
+ * @file feature.h
+ * @brief Feature base class
+ * 
+ * Split from device_features.h so the TopicRouter, which only calls into
+ * this interface, builds without the board and audio headers (see
+ * tools/router_bench.cpp).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "task_layout.h"
+#include "topic_router.h"
+
+namespace Features {
+
+/**
+ * @brief Base class for all device features
+ * 
+ * Features follow a lifecycle: init() -> start() -> update() -> stop()
+ * 
+ * onConnected()/onDisconnected() bracket each AVI session. Features are
+ * kept alive across reconnects; topics are declared once in
+ * registerTopics() and (re)subscribed by the FeatureManager per session.
+ * 
+ * update() is called by the FeatureManager scheduler at the period given
+ * by getSchedule(), from the task of the feature's domain. Event-driven
+ * features keep the default (period 0) and are never updated.
+ * 
+ * The AVI handle belongs to the network task: handleMessage(),
+ * onConnected()/onDisconnected() and serviceNetwork() run there. A
+ * feature in another domain hands work across through a lock-free queue
+ * and calls wakeNetwork() when the network side has something to send.
+ */
+class Feature {
+public:
+    /**
+     * @brief Scheduling requirements for update()
+     */
+    struct Schedule {
+        uint32_t period_us;     // Release interval, 0 = event-driven
+        uint32_t deadline_us;   // Allowed start lateness before a run is a miss
+    };
+    
+    virtual ~Feature() = default;
+    
+    virtual Schedule getSchedule() const { return {0, 0}; }
+    virtual TaskDomain getDomain() const { return TaskDomain::NETWORK; }
+    
+    virtual bool init() = 0;
+    virtual bool start() = 0;
+    virtual void update() = 0;
+    virtual void stop() = 0;
+    virtual void onConnected() {}
+    virtual void onDisconnected() {}
+    virtual void registerTopics(TopicRouter& router) {}
+    virtual void handleMessage(TopicId topic, const uint8_t* data, size_t data_len) {}
+    virtual void serviceNetwork() {}
+    virtual void logStats() const {}
+    virtual const char* getName() const = 0;
+    
+protected:
+    /**
+     * @brief Ask the network task to run serviceNetwork() soon
+     */
+    void wakeNetwork() {
+        if (m_wake_network) {
+            m_wake_network();
+        }
+    }
+    
+private:
+    friend class FeatureManager;
+    std::function<void()> m_wake_network;
+};
+
+} // namespace Features
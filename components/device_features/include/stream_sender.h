@@ -0,0 +1,192 @@
+/**
+ * @file stream_sender.h
+ * @brief Paced device-to-server media over AVI streams
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "avi_embedded.h"
+#include "mic_framer.h"
+#include "spsc_ring.h"
+#include "transport.h"
+
+namespace Features {
+
+/**
+ * @brief One long-lived outbound AVI stream fed from a media task
+ * 
+ * A producer task (e.g. audio capture) push()es whole packets into a
+ * fixed slot pool, or fills a slot in place through the Audio::PacketSink
+ * acquire()/commit() pair; the network task drains them in service(). Over an AVI
+ * stream each packet carries only the local stream id, instead of the
+ * topic string every pub/sub message repeats.
+ * 
+ * Lifecycle: begin() asks for the stream, which is opened on the network
+ * task once the session is up and reopened with a fresh id after every
+ * reconnect; end() closes it once the packets queued before it are sent. Stream ids are allocated from a pool shared
+ * by all senders.
+ * 
+ * Flow control: sends are paced by a token bucket so a capture burst
+ * never floods the uplink, and packets that waited in the queue longer
+ * than max_age_ms (behind the bucket or a dead link) are dropped rather
+ * than sent late. The bucket is charged what the transport actually took
+ * for each packet, and every send goes out as TrafficClass::BULK so
+ * control messages overtake the stream in the transport.
+ * 
+ * Mode::PUBLISH sends the same packets as pub/sub messages on a topic,
+ * with identical queueing, to compare the two paths on the wire.
+ */
+class StreamSender : public Audio::PacketSink {
+public:
+    static constexpr size_t SLOTS = 8;                  // Must be a power of two
+    static constexpr size_t MAX_PACKET = 1024;
+    
+    enum class Mode : uint8_t {
+        STREAM,     // avi_embedded_send_stream_data on an open stream
+        PUBLISH,    // avi_embedded_publish on config.topic
+    };
+    
+    struct Config {
+        Mode mode;
+        const char* target;         // Peer the stream is opened to
+        const char* reason;         // Stream purpose announced at open
+        const char* topic;          // PUBLISH mode only
+        uint32_t max_kbps;          // Pacing rate, 0 = unpaced
+        uint32_t burst_bytes;       // Bucket depth
+        uint32_t max_age_ms;        // Packets queued longer are dropped instead of sent
+    };
+    
+    /**
+     * @brief Sender counters
+     */
+    struct Stats {
+        uint32_t queued;            // Packets accepted by push() or commit()
+        uint32_t queue_full;        // Packets rejected by push(), failed acquire()s
+        uint32_t sent;
+        uint32_t stale;             // Dropped after queueing longer than max_age_ms
+        uint32_t send_errors;       // Refused by the AVI core (dropped)
+        uint32_t throttled;         // Drains stopped by the bucket
+        uint32_t opens;             // Streams opened (once per session)
+        uint32_t open_failures;
+        uint64_t payload_bytes;     // Packet bytes sent
+        uint64_t wire_bytes;        // Datagram bytes the transport took for them
+        uint32_t send_max_us;       // Worst time in one AVI send call, transport queueing included
+        uint64_t send_total_us;     // Sum over sent packets, for averaging
+        uint32_t bulk_sent;         // BULK datagrams handed to the socket by the transport
+        uint32_t bulk_latency_max_us;   // Their worst send()-to-socket time
+        uint64_t bulk_latency_total_us; // Sum over them, for averaging
+        uint32_t latency_max_us;    // Worst capture-to-send time (push-to-send for push())
+        uint64_t latency_total_us;  // Sum over sent packets, for averaging
+    };
+    
+    /**
+     * @param transport The transport the AVI core sends through, for the
+     *                  traffic class and the byte counts
+     */
+    StreamSender(AVI_AviEmbedded* avi, AVI::Transport& transport);
+    ~StreamSender();
+    
+    StreamSender(const StreamSender&) = delete;
+    StreamSender& operator=(const StreamSender&) = delete;
+    
+    void configure(const Config& config) { m_config = config; }
+    
+    /**
+     * @brief Request the stream (any task); opened by service()
+     */
+    void begin() { m_wanted.store(true, std::memory_order_release); }
+    
+    /**
+     * @brief Release the stream (any task); closed by service()
+     */
+    void end() { m_wanted.store(false, std::memory_order_release); }
+    
+    bool isActive() const { return m_wanted.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief Producer: queue one packet, never blocks
+     * 
+     * @return false if the packet is too large or the pool is full
+     */
+    bool push(const uint8_t* data, size_t length);
+    
+    size_t getCapacity() const override { return MAX_PACKET; }
+    
+    /**
+     * @brief Producer: borrow a free slot to fill in place, never blocks
+     */
+    uint8_t* acquire() override;
+    
+    /**
+     * @brief Producer: queue the acquired slot
+     * 
+     * @param captured_at_us esp_timer_get_time() when its content was
+     *                       captured; latency is counted from here, the
+     *                       max_age_ms limit from the commit
+     */
+    void commit(size_t length, int64_t captured_at_us) override;
+    
+    /**
+     * @brief Network task: open/close as requested and send what is due
+     */
+    void service();
+    
+    /**
+     * @brief Network task: session state, from Feature::onConnected()/onDisconnected()
+     */
+    void onConnected();
+    void onDisconnected();
+    
+    /**
+     * @brief Network task: close the stream and drop queued packets
+     */
+    void shutdown();
+    
+    Stats getStats() const;
+    uint8_t getStreamId() const { return m_stream_id; }
+    
+private:
+    static constexpr uint8_t NO_SLOT = 0xFF;
+    
+    struct Slot {
+        uint16_t length;
+        int64_t captured_at_us;
+        int64_t queued_at_us;
+        uint8_t data[MAX_PACKET];
+    };
+    
+    static uint8_t allocateStreamId();
+    static void releaseStreamId(uint8_t id);
+    
+    bool open();
+    void close();
+    bool refill(size_t cost);
+    void drain(bool can_send);
+    
+    AVI_AviEmbedded* m_avi;
+    AVI::Transport& m_transport;
+    Config m_config;
+    std::atomic<bool> m_wanted;
+    
+    Slot m_pool[SLOTS];
+    LockFree::SpscRing<uint8_t, SLOTS> m_ready;    // Producer -> network task
+    LockFree::SpscRing<uint8_t, SLOTS> m_free;     // Network task -> producer
+    
+    // Network task only
+    bool m_connected;
+    uint8_t m_stream_id;                            // 0 = not open
+    int64_t m_tokens;                               // Bucket level in bytes
+    int64_t m_refilled_at_us;
+    size_t m_overhead;                              // Transport bytes over the payload, last measured
+    Stats m_stats;
+    
+    // Producer only, counters folded into getStats()
+    uint8_t m_acquired;                             // Slot lent out by acquire(), or NO_SLOT
+    uint32_t m_queued;
+    uint32_t m_queue_full;
+};
+
+} // namespace Features
@@ -0,0 +1,50 @@
+/**
+ * @file task_layout.h
+ * @brief Task domains and their placement
+ * 
+ * Work is split into domains, each served by its own FreeRTOS task pinned
+ * to a core. Names, stack sizes, priorities and cores come from the
+ * TASK_LAYOUT table in device_config.h. Domains only talk to each other
+ * through lock-free queues, so a stall in one (e.g. a blocked I2S write)
+ * no longer holds up the others.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "freertos/FreeRTOS.h"
+#include "device_config.h"
+
+namespace Features {
+
+#define TASK_LAYOUT_DOMAIN(domain, name, stack, prio, core) domain,
+#define TASK_LAYOUT_CONFIG(domain, name, stack, prio, core) { name, stack, prio, core },
+
+/**
+ * @brief Task domains, in TASK_LAYOUT order
+ */
+enum class TaskDomain : uint8_t {
+    TASK_LAYOUT(TASK_LAYOUT_DOMAIN)
+    COUNT
+};
+
+struct TaskConfig {
+    const char* name;
+    uint32_t stack_size;
+    UBaseType_t priority;
+    BaseType_t core;
+};
+
+static constexpr TaskConfig TASK_CONFIGS[] = {
+    TASK_LAYOUT(TASK_LAYOUT_CONFIG)
+};
+
+#undef TASK_LAYOUT_DOMAIN
+#undef TASK_LAYOUT_CONFIG
+
+inline const TaskConfig& getTaskConfig(TaskDomain domain) {
+    return TASK_CONFIGS[static_cast<size_t>(domain)];
+}
+
+} // namespace Features
@@ -0,0 +1,105 @@
+/**
+ * @file topic_router.h
+ * @brief Inbound topic interning and dispatch
+ * 
+ * Every topic the device subscribes to is listed once in TOPIC_TABLE and
+ * gets a small integer TopicId. Incoming topic strings are interned with a
+ * single FNV-1a pass plus a probe into a hash table built at compile time;
+ * dispatch is then an array lookup handing the payload to the registered
+ * features as a plain pointer/length view. Nothing is allocated per message.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "device_config.h"
+
+namespace Features {
+
+class Feature;
+
+/**
+ * @brief Interned inbound topics
+ */
+enum class TopicId : uint8_t {
+    LED_CONTROL = 0,
+    LED_ANIMATION,
+    LED_CLEAR,
+    AUDIO_DATA,
+    AUDIO_EARCON,
+    AUDIO_TONE,
+    COMMAND,
+    COUNT,
+    UNKNOWN = 0xFF
+};
+
+struct TopicEntry {
+    TopicId id;
+    const char* name;
+};
+
+// Keep in TopicId order
+static constexpr TopicEntry TOPIC_TABLE[] = {
+    { TopicId::LED_CONTROL,   TOPIC_LED_CONTROL },
+    { TopicId::LED_ANIMATION, TOPIC_LED_ANIMATION },
+    { TopicId::LED_CLEAR,     TOPIC_LED_CLEAR },
+    { TopicId::AUDIO_DATA,    TOPIC_AUDIO_DATA },
+    { TopicId::AUDIO_EARCON,  TOPIC_AUDIO_EARCON },
+    { TopicId::AUDIO_TONE,    TOPIC_AUDIO_TONE },
+    { TopicId::COMMAND,       TOPIC_COMMAND },
+};
+
+static_assert(sizeof(TOPIC_TABLE) / sizeof(TOPIC_TABLE[0]) == static_cast<size_t>(TopicId::COUNT),
+              "TOPIC_TABLE must list every TopicId");
+
+/**
+ * @brief Routes inbound AVI messages to the features that registered for them
+ */
+class TopicRouter {
+public:
+    static constexpr size_t MAX_HANDLERS_PER_TOPIC = 2;
+    
+    /**
+     * @brief Dispatch counters
+     */
+    struct Stats {
+        uint32_t dispatched;       // Messages delivered to at least one handler
+        uint32_t unhandled;        // Known topic, nobody registered
+        uint32_t unknown;          // Topic not in TOPIC_TABLE
+        uint64_t lookup_cycles;    // CPU cycles spent interning + table lookup (ESP32 only)
+    };
+    
+    TopicRouter();
+    
+    /**
+     * @brief Register a feature for a topic (call during init)
+     * @return false if the topic already has MAX_HANDLERS_PER_TOPIC handlers
+     */
+    bool registerHandler(TopicId topic, Feature* feature);
+    
+    /**
+     * @brief Whether any feature registered for this topic
+     */
+    bool hasHandlers(TopicId topic) const;
+    
+    /**
+     * @brief Map a topic string to its TopicId
+     * @return TopicId::UNKNOWN if the topic is not in TOPIC_TABLE
+     */
+    static TopicId intern(const char* topic, size_t topic_len);
+    
+    static const char* name(TopicId topic);
+    
+    void dispatch(const char* topic, size_t topic_len,
+                  const uint8_t* data, size_t data_len);
+    
+    const Stats& getStats() const { return m_stats; }
+    
+private:
+    Feature* m_handlers[static_cast<size_t>(TopicId::COUNT)][MAX_HANDLERS_PER_TOPIC];
+    uint8_t m_handler_count[static_cast<size_t>(TopicId::COUNT)];
+    Stats m_stats;
+};
+
+} // namespace Features
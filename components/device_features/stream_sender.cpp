@@ -0,0 +1,270 @@
+/**
+ * @file stream_sender.cpp
+ * @brief Paced device-to-server media over AVI streams
+ */
+
+#include "stream_sender.h"
+#include <cstring>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "STREAM";
+
+namespace Features {
+
+namespace {
+
+// Local stream ids in use, shared by every sender (network task only).
+// Id 0 is reserved to mean "not open".
+uint32_t s_stream_ids[256 / 32] = {1};
+
+} // namespace
+
+StreamSender::StreamSender(AVI_AviEmbedded* avi, AVI::Transport& transport)
+    : m_avi(avi)
+    , m_transport(transport)
+    , m_config{}
+    , m_wanted(false)
+    , m_connected(false)
+    , m_stream_id(0)
+    , m_tokens(0)
+    , m_refilled_at_us(0)
+    , m_overhead(0)
+    , m_stats{}
+    , m_acquired(NO_SLOT)
+    , m_queued(0)
+    , m_queue_full(0) {
+    for (uint8_t i = 0; i < SLOTS; i++) {
+        m_free.push(i);
+    }
+}
+
+StreamSender::~StreamSender() {
+    shutdown();
+}
+
+uint8_t StreamSender::allocateStreamId() {
+    for (uint32_t id = 1; id < 256; id++) {
+        uint32_t& word = s_stream_ids[id / 32];
+        uint32_t bit = 1u << (id % 32);
+        if (!(word & bit)) {
+            word |= bit;
+            return (uint8_t)id;
+        }
+    }
+    return 0;
+}
+
+void StreamSender::releaseStreamId(uint8_t id) {
+    if (id != 0) {
+        s_stream_ids[id / 32] &= ~(1u << (id % 32));
+    }
+}
+
+uint8_t* StreamSender::acquire() {
+    if (m_acquired == NO_SLOT && !m_free.pop(m_acquired)) {
+        m_acquired = NO_SLOT;
+        m_queue_full++;
+        return nullptr;
+    }
+    return m_pool[m_acquired].data;
+}
+
+void StreamSender::commit(size_t length, int64_t captured_at_us) {
+    if (m_acquired == NO_SLOT || length == 0 || length > MAX_PACKET) {
+        return;
+    }
+    
+    Slot& slot = m_pool[m_acquired];
+    slot.length = (uint16_t)length;
+    slot.captured_at_us = captured_at_us;
+    slot.queued_at_us = esp_timer_get_time();
+    m_ready.push(m_acquired);
+    m_acquired = NO_SLOT;
+    m_queued++;
+}
+
+bool StreamSender::push(const uint8_t* data, size_t length) {
+    if (length == 0 || length > MAX_PACKET) {
+        m_queue_full++;
+        return false;
+    }
+    
+    uint8_t* slot = acquire();
+    if (!slot) {
+        return false;
+    }
+    memcpy(slot, data, length);
+    commit(length, esp_timer_get_time());
+    return true;
+}
+
+void StreamSender::onConnected() {
+    m_connected = true;
+    m_tokens = m_config.burst_bytes;
+    m_refilled_at_us = esp_timer_get_time();
+}
+
+void StreamSender::onDisconnected() {
+    // The session took the stream with it; reopen on the next one
+    m_connected = false;
+    releaseStreamId(m_stream_id);
+    m_stream_id = 0;
+}
+
+bool StreamSender::open() {
+    uint8_t id = allocateStreamId();
+    if (id == 0) {
+        ESP_LOGW(TAG, "No free stream id");
+        m_stats.open_failures++;
+        return false;
+    }
+    
+    int ret = avi_embedded_start_stream(m_avi, id,
+                                        m_config.target, strlen(m_config.target),
+                                        m_config.reason, strlen(m_config.reason));
+    if (ret != 0) {
+        ESP_LOGW(TAG, "Failed to open stream %u to %s: %d", id, m_config.target, ret);
+        releaseStreamId(id);
+        m_stats.open_failures++;
+        return false;
+    }
+    
+    m_stream_id = id;
+    m_stats.opens++;
+    ESP_LOGI(TAG, "Stream %u open to %s (%s)", id, m_config.target, m_config.reason);
+    return true;
+}
+
+void StreamSender::close() {
+    if (m_stream_id == 0) {
+        return;
+    }
+    if (m_connected) {
+        avi_embedded_close_stream(m_avi, m_stream_id);
+    }
+    ESP_LOGI(TAG, "Stream %u closed", m_stream_id);
+    releaseStreamId(m_stream_id);
+    m_stream_id = 0;
+}
+
+void StreamSender::shutdown() {
+    m_wanted.store(false, std::memory_order_release);
+    close();
+    
+    uint8_t index;
+    while (m_ready.pop(index)) {
+        m_free.push(index);
+    }
+}
+
+bool StreamSender::refill(size_t cost) {
+    if (m_config.max_kbps == 0) {
+        return true;
+    }
+    
+    // kbit/s over microseconds: bytes = us * kbps / 8000. Only whole bytes
+    // are credited; the remainder carries over to the next refill.
+    int64_t now = esp_timer_get_time();
+    int64_t earned = (now - m_refilled_at_us) * m_config.max_kbps / 8000;
+    if (earned > 0) {
+        m_refilled_at_us += earned * 8000 / m_config.max_kbps;
+        m_tokens += earned;
+        if (m_tokens > (int64_t)m_config.burst_bytes) {
+            m_tokens = m_config.burst_bytes;
+            m_refilled_at_us = now;
+        }
+    }
+    return m_tokens >= (int64_t)cost;
+}
+
+void StreamSender::service() {
+    bool wanted = m_wanted.load(std::memory_order_acquire);
+    if (m_config.mode == Mode::STREAM && wanted && m_connected && m_stream_id == 0) {
+        open();
+    }
+    
+    // Packets queued before end() still go out; the stream closes once
+    // they are gone
+    drain(m_connected && (m_config.mode == Mode::PUBLISH || m_stream_id != 0));
+    
+    if (m_config.mode == Mode::STREAM && !wanted && m_stream_id != 0 && m_ready.empty()) {
+        close();
+    }
+}
+
+void StreamSender::drain(bool can_send) {
+    // Media never delays control traffic queued behind it; the stream's
+    // open and close stay control
+    AVI::TrafficClassScope bulk(m_transport, AVI::TrafficClass::BULK);
+    int64_t max_age_us = (int64_t)m_config.max_age_ms * 1000;
+    
+    const uint8_t* head;
+    while ((head = m_ready.peek()) != nullptr) {
+        uint8_t index = *head;
+        Slot& slot = m_pool[index];
+        int64_t now = esp_timer_get_time();
+        
+        if (now - slot.queued_at_us > max_age_us) {
+            // Late audio is worse than missing audio
+            m_stats.stale++;
+        } else if (!can_send) {
+            break;
+        } else {
+            // Paced on the overhead the last packet actually had
+            if (!refill(slot.length + m_overhead)) {
+                m_stats.throttled++;
+                break;
+            }
+            
+            uint64_t accepted = m_transport.getClassMetrics(AVI::TrafficClass::BULK).accepted_bytes;
+            int ret = m_config.mode == Mode::STREAM
+                ? avi_embedded_send_stream_data(m_avi, m_stream_id, slot.data, slot.length)
+                : avi_embedded_publish(m_avi, m_config.topic, strlen(m_config.topic),
+                                       slot.data, slot.length);
+            int64_t done = esp_timer_get_time();
+            size_t wire = (size_t)(m_transport.getClassMetrics(AVI::TrafficClass::BULK).accepted_bytes - accepted);
+            if (ret != 0) {
+                m_stats.send_errors++;
+            } else {
+                // A core that defers the datagram is charged the last overhead
+                if (wire >= slot.length) {
+                    m_overhead = wire - slot.length;
+                    m_tokens -= wire;
+                } else {
+                    m_tokens -= slot.length + m_overhead;
+                }
+                m_stats.sent++;
+                m_stats.payload_bytes += slot.length;
+                m_stats.wire_bytes += wire;
+                uint32_t send_us = (uint32_t)(done - now);
+                m_stats.send_total_us += send_us;
+                if (send_us > m_stats.send_max_us) {
+                    m_stats.send_max_us = send_us;
+                }
+                uint32_t latency = (uint32_t)(now - slot.captured_at_us);
+                m_stats.latency_total_us += latency;
+                if (latency > m_stats.latency_max_us) {
+                    m_stats.latency_max_us = latency;
+                }
+            }
+        }
+        
+        m_ready.pop(index);
+        m_free.push(index);
+    }
+}
+
+StreamSender::Stats StreamSender::getStats() const {
+    Stats stats = m_stats;
+    stats.queue_full = m_queue_full;
+    stats.queued = m_queued;
+    
+    AVI::TrafficClassMetrics bulk = m_transport.getClassMetrics(AVI::TrafficClass::BULK);
+    stats.bulk_sent = bulk.sent;
+    stats.bulk_latency_max_us = bulk.latency_max_us;
+    stats.bulk_latency_total_us = bulk.latency_total_us;
+    return stats;
+}
+
+} // namespace Features
@@ -0,0 +1,173 @@
+/**
+ * @file topic_router.cpp
+ * @brief Topic Router Implementation
+ */
+
+#include "topic_router.h"
+#include "feature.h"
+#include "esp_log.h"
+#include <cstring>
+
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#endif
+
+static const char* TAG = "ROUTER";
+
+namespace Features {
+
+namespace {
+
+constexpr size_t TOPIC_COUNT = static_cast<size_t>(TopicId::COUNT);
+constexpr size_t BUCKET_COUNT = 16;   // Power of two, comfortably > TOPIC_COUNT
+
+static_assert(BUCKET_COUNT >= 2 * TOPIC_COUNT, "Grow BUCKET_COUNT with the topic table");
+
+constexpr uint32_t fnv1a(const char* str, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ static_cast<uint8_t>(str[i])) * 16777619u;
+    }
+    return hash;
+}
+
+constexpr size_t constLength(const char* str) {
+    size_t len = 0;
+    while (str[len]) {
+        len++;
+    }
+    return len;
+}
+
+struct Bucket {
+    uint32_t hash;
+    uint8_t length;
+    TopicId id;
+};
+
+struct BucketTable {
+    Bucket buckets[BUCKET_COUNT];
+};
+
+// Open-addressed table, filled at compile time
+constexpr BucketTable buildTable() {
+    BucketTable table = {};
+    for (size_t b = 0; b < BUCKET_COUNT; b++) {
+        table.buckets[b] = Bucket{0, 0, TopicId::UNKNOWN};
+    }
+    for (size_t i = 0; i < TOPIC_COUNT; i++) {
+        size_t len = constLength(TOPIC_TABLE[i].name);
+        uint32_t hash = fnv1a(TOPIC_TABLE[i].name, len);
+        size_t b = hash & (BUCKET_COUNT - 1);
+        while (table.buckets[b].id != TopicId::UNKNOWN) {
+            b = (b + 1) & (BUCKET_COUNT - 1);
+        }
+        table.buckets[b] = Bucket{hash, static_cast<uint8_t>(len), TOPIC_TABLE[i].id};
+    }
+    return table;
+}
+
+constexpr bool hashesUnique() {
+    for (size_t i = 0; i < TOPIC_COUNT; i++) {
+        for (size_t j = i + 1; j < TOPIC_COUNT; j++) {
+            if (fnv1a(TOPIC_TABLE[i].name, constLength(TOPIC_TABLE[i].name)) ==
+                fnv1a(TOPIC_TABLE[j].name, constLength(TOPIC_TABLE[j].name))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+constexpr bool tableOrdered() {
+    for (size_t i = 0; i < TOPIC_COUNT; i++) {
+        if (static_cast<size_t>(TOPIC_TABLE[i].id) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(hashesUnique(), "Topic hash collision, rename a topic");
+static_assert(tableOrdered(), "TOPIC_TABLE must be in TopicId order");
+
+constexpr BucketTable BUCKETS = buildTable();
+
+} // namespace
+
+TopicRouter::TopicRouter()
+    : m_handlers{}
+    , m_handler_count{}
+    , m_stats{} {
+}
+
+bool TopicRouter::registerHandler(TopicId topic, Feature* feature) {
+    size_t index = static_cast<size_t>(topic);
+    if (index >= TOPIC_COUNT || !feature) {
+        return false;
+    }
+    if (m_handler_count[index] >= MAX_HANDLERS_PER_TOPIC) {
+        ESP_LOGE(TAG, "Too many handlers for %s", name(topic));
+        return false;
+    }
+    
+    m_handlers[index][m_handler_count[index]++] = feature;
+    ESP_LOGI(TAG, "%s -> %s", name(topic), feature->getName());
+    return true;
+}
+
+bool TopicRouter::hasHandlers(TopicId topic) const {
+    size_t index = static_cast<size_t>(topic);
+    return index < TOPIC_COUNT && m_handler_count[index] > 0;
+}
+
+TopicId TopicRouter::intern(const char* topic, size_t topic_len) {
+    uint32_t hash = fnv1a(topic, topic_len);
+    size_t b = hash & (BUCKET_COUNT - 1);
+    
+    while (BUCKETS.buckets[b].id != TopicId::UNKNOWN) {
+        const Bucket& bucket = BUCKETS.buckets[b];
+        if (bucket.hash == hash && bucket.length == topic_len) {
+            // Confirm, a hash match alone could be a foreign topic
+            const char* expected = TOPIC_TABLE[static_cast<size_t>(bucket.id)].name;
+            return std::memcmp(expected, topic, topic_len) == 0 ? bucket.id : TopicId::UNKNOWN;
+        }
+        b = (b + 1) & (BUCKET_COUNT - 1);
+    }
+    return TopicId::UNKNOWN;
+}
+
+const char* TopicRouter::name(TopicId topic) {
+    size_t index = static_cast<size_t>(topic);
+    return index < TOPIC_COUNT ? TOPIC_TABLE[index].name : "unknown";
+}
+
+void TopicRouter::dispatch(const char* topic, size_t topic_len,
+                           const uint8_t* data, size_t data_len) {
+#ifdef ESP_PLATFORM
+    uint32_t start = esp_cpu_get_cycle_count();
+#endif
+    TopicId id = intern(topic, topic_len);
+#ifdef ESP_PLATFORM
+    m_stats.lookup_cycles += esp_cpu_get_cycle_count() - start;
+#endif
+    
+    if (id == TopicId::UNKNOWN) {
+        m_stats.unknown++;
+        ESP_LOGD(TAG, "Unknown topic: %.*s", (int)topic_len, topic);
+        return;
+    }
+    
+    size_t index = static_cast<size_t>(id);
+    if (m_handler_count[index] == 0) {
+        m_stats.unhandled++;
+        return;
+    }
+    
+    m_stats.dispatched++;
+    for (uint8_t i = 0; i < m_handler_count[index]; i++) {
+        m_handlers[index][i]->handleMessage(id, data, data_len);
+    }
+}
+
+} // namespace Features
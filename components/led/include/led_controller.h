@@ -1,15 +1,16 @@
 #pragma once
 
 #include <driver/gpio.h>
-#include <led_strip.h>
+#include <driver/rmt_tx.h>
+#include <atomic>
 #include <vector>
-#include <string>
-#include <math.h>
 #include "esp_timer.h"
+#include "led_math.h"
 
-// Hardware Config
-#define LED_PIN GPIO_NUM_33
+// Hardware Config (the data pin comes from the board, see init())
+#ifndef NUM_LEDS
 #define NUM_LEDS 12
+#endif
 
 // Color structure (Replaces CRGB)
 struct RgbColor {
@@ -66,43 +67,132 @@ enum AnimationType {
     SOLID_COLOR
 };
 
+// Keys a configurable animation may take ("SPEED:20,COLOR:#FF0000,...")
+enum AnimParam : uint8_t {
+    PARAM_SPEED     = 1 << 0,   // SPEED:<n>, meaning per animation
+    PARAM_COLOR     = 1 << 1,   // COLOR:#RRGGBB or RED/GREEN/BLUE
+    PARAM_COLOR2    = 1 << 2,   // COLOR2: as COLOR
+    PARAM_FADE      = 1 << 3,   // FADE:<0-255> trail fade per frame
+    PARAM_DIRECTION = 1 << 4,   // DIR:FWD or DIR:REV
+};
+
+// Animation config, parsed once by setAnimation()
+struct AnimParams {
+    uint16_t speed;
+    RgbColor color;
+    RgbColor color2;
+    uint8_t fade;
+    int8_t direction;           // 1 forward, -1 reverse
+};
+
+// What a configurable animation accepts, and its defaults
+struct AnimSchema {
+    AnimationType type;
+    uint8_t params;             // AnimParam bits
+    uint16_t min_speed;
+    uint16_t max_speed;
+    AnimParams defaults;
+};
+
+// Animation time for the frame being rendered: started by setAnimation(),
+// advanced by update() once per rendered frame. Animations move on these
+// rather than per frame, so their speed does not depend on the frame rate.
+struct AnimClock {
+    int64_t start_us = 0;
+    uint32_t duration_ms = 0;   // 0 runs until replaced
+    uint32_t elapsed_ms = 0;    // Since setAnimation()
+    uint32_t dt_ms = 0;         // Since the previous rendered frame
+    uint16_t progress = 0;      // elapsed / duration, 0-65535; 0 if endless
+
+    void start(int64_t now_us, uint32_t duration) {
+        *this = AnimClock();
+        start_us = now_us;
+        duration_ms = duration;
+    }
+
+    void tick(int64_t now_us) {
+        uint32_t elapsed = (uint32_t)((now_us - start_us) / 1000);
+        dt_ms = elapsed - elapsed_ms;
+        elapsed_ms = elapsed;
+        if (duration_ms > 0) {
+            uint64_t p = (uint64_t)elapsed * 65535 / duration_ms;
+            progress = p > 65535 ? 65535 : (uint16_t)p;
+        }
+    }
+
+    bool expired(int64_t now_us) const {
+        return duration_ms > 0 && now_us - start_us > (int64_t)duration_ms * 1000;
+    }
+};
+
+// Output counters, since boot
+struct LedStats {
+    uint32_t frames;            // show() calls
+    uint32_t refreshes;         // Frames sent to the strip
+    uint32_t skipped;           // Frames identical to the last one sent
+    uint32_t errors;            // Failed transmits, retried next frame
+    uint32_t busy;              // Changed frames dropped, the last still on the wire
+    uint64_t show_us;           // Total time in show()
+    uint32_t show_max_us;
+    uint32_t frame_us;          // Current frame period, raised under load
+    uint32_t slowdowns;         // Frame rate reductions under load
+};
+
 class LedController {
 private:
-    led_strip_handle_t led_strip;
+    rmt_channel_handle_t rmtChannel = nullptr;
+    rmt_encoder_handle_t encoder = nullptr;
+    gpio_num_t pin = GPIO_NUM_NC;
+    bool withDma = false;
     std::vector<RgbColor> leds; // Internal buffer
     
+    // Wire format (GRB, gamma corrected). The front buffer holds the last
+    // frame sent and may still be on the wire; show() renders into the back.
+    uint8_t frames[2][NUM_LEDS * 3] = {};
+    uint8_t front = 0;
+    std::atomic<bool> transmitting{false};  // Cleared by the RMT ISR
+    bool refreshPending = true; // Send even if unchanged (first frame, errors)
+    LedStats stats = {};
+    
     AnimationType currentAnim = OFF;
     AnimationType nextAnim = OFF;
     
-    int64_t animStartTime = 0;
-    int64_t animDuration = 0;
-    int64_t lastFrameTime = 0;
+    AnimClock clock;
     
-    // Configuration storage
-    std::string currentConfig;
+    // Frame rate: the configured period, stretched while rendering takes
+    // too much of it
+    uint32_t targetFrameUs = 1000000 / 60;
+    uint32_t frameUs = 1000000 / 60;
+    int64_t lastFrameUs = 0;
+    uint32_t loadAvg = 0;       // Render time / frame period, Q8, x16 (EWMA)
+    uint8_t adaptHold = 0;      // Frames before the next rate change
     
-    // State variables for animations
-    uint16_t state_step = 0;
-    uint16_t state_val1 = 0;
-    uint16_t state_val2 = 0;
-    float state_float = 0.0f;
-    bool state_bool = false;
+    // Configuration of the current animation
+    AnimParams params = {};
+    
+    // Per-activation animation state, reset by setAnimation()
+    struct AnimState {
+        uint8_t step;
+        uint32_t mark_ms;       // clock.elapsed_ms the steps are timed from
+    } state = {};
 
     // Helpers
+    bool initOutput(bool dma);
+    static bool onTransmitDone(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t* event, void* ctx);
     void show();
     void setPixel(int idx, RgbColor color);
     void setAll(RgbColor color);
     void fadeToBlack(uint8_t amount);
     RgbColor hsv2rgb(uint8_t h, uint8_t s, uint8_t v);
-    uint32_t millis();
+    void adaptFrameRate(uint32_t render_us);
     
-    // Math helpers for smooth animations (sine waves, etc)
+    // Math helpers for smooth animations (sine waves, etc), see led_math.h
     uint8_t beatsin8(uint8_t bpm, uint8_t lowest = 0, uint8_t highest = 255, uint32_t time_shift = 0, uint8_t phase_offset = 0);
     
     // Config Parser Helpers
-    int getConfigInt(const char* key, int defaultVal);
-    RgbColor getConfigColor(const char* key, RgbColor defaultVal);
-    bool getConfigBool(const char* key, bool defaultVal);
+    static const AnimSchema* findSchema(AnimationType type);
+    static bool parseColor(const char* val, size_t len, RgbColor& out);
+    void parseConfig(AnimationType type, const char* config);
 
     // Animation Implementations
     void anim_processing();
@@ -125,10 +215,14 @@ private:
 
 public:
     LedController();
-    bool init();
+    ~LedController();
+    bool init(gpio_num_t dataPin);
     void update(bool connected); // Call this in your main loop
     
     void setLed(int idx, RgbColor color);
     void setAnimation(int type, int duration_ms, const char* config = "");
+    void setFrameRate(uint8_t fps); // Target; lowered automatically under load
     void clear();
+    
+    const LedStats& getStats() const { return stats; }
 };
@@ -0,0 +1,162 @@
+/**
+ * @file led_math.h
+ * @brief Fixed-point waves and gamma correction for the LED animations
+ * 
+ * All tables are generated at compile time and the functions are integer
+ * only, so no animation does floating point per pixel. Platform
+ * independent so it can be measured on the host (tools/led_bench.cpp).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace LedMath {
+
+/**
+ * @brief 256 entries indexed by an 8-bit value or angle
+ */
+struct Table8 {
+    uint8_t value[256];
+};
+
+namespace Detail {
+
+constexpr double PI = 3.14159265358979323846;
+
+// Taylor series after folding into [-pi/2, pi/2]
+constexpr double sin(double x) {
+    if (x > PI) {
+        x -= 2 * PI;
+    }
+    if (x > PI / 2) {
+        x = PI - x;
+    } else if (x < -PI / 2) {
+        x = -PI - x;
+    }
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 12; n++) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+// x^2.2 as x^2 * x^(1/5), the fifth root by Newton's method
+constexpr double gamma(double x) {
+    if (x <= 0.0) {
+        return 0.0;
+    }
+    double root = 1.0;
+    for (int n = 0; n < 64; n++) {
+        double r4 = root * root * root * root;
+        root = (4.0 * root + x / r4) / 5.0;
+    }
+    return x * x * root;
+}
+
+constexpr uint8_t round8(double value) {
+    return value <= 0.0 ? 0 : value >= 255.0 ? 255 : (uint8_t)(value + 0.5);
+}
+
+constexpr uint8_t scale8(uint8_t value, uint8_t scale) {
+    return (uint8_t)(((uint16_t)value * (uint16_t)(scale + 1)) >> 8);
+}
+
+constexpr Table8 makeSin8() {
+    Table8 table = {};
+    for (size_t i = 0; i < 256; i++) {
+        table.value[i] = round8(127.5 + 127.5 * Detail::sin(2 * PI * (double)i / 256));
+    }
+    return table;
+}
+
+// Triangle wave eased in and out quadratically: sine-like, cheaper to make
+constexpr Table8 makeQuadwave8() {
+    Table8 table = {};
+    for (size_t i = 0; i < 256; i++) {
+        uint8_t tri = (uint8_t)((i & 0x80 ? 255 - i : i) << 1);
+        uint8_t half = tri & 0x80 ? (uint8_t)(255 - tri) : tri;
+        uint8_t eased = (uint8_t)(scale8(half, half) << 1);
+        table.value[i] = tri & 0x80 ? (uint8_t)(255 - eased) : eased;
+    }
+    return table;
+}
+
+constexpr Table8 makeGamma8() {
+    Table8 table = {};
+    for (size_t i = 0; i < 256; i++) {
+        table.value[i] = round8(255.0 * gamma((double)i / 255.0));
+    }
+    return table;
+}
+
+} // namespace Detail
+
+inline constexpr Table8 SIN8 = Detail::makeSin8();
+inline constexpr Table8 QUADWAVE8 = Detail::makeQuadwave8();
+inline constexpr Table8 GAMMA8 = Detail::makeGamma8();
+
+/**
+ * @brief value * scale / 256, where scale 255 keeps the value
+ */
+constexpr uint8_t scale8(uint8_t value, uint8_t scale) {
+    return Detail::scale8(value, scale);
+}
+
+/**
+ * @brief Sine of an 8-bit angle (256 = one turn), 0..255 centred on 128
+ */
+constexpr uint8_t sin8(uint8_t theta) {
+    return SIN8.value[theta];
+}
+
+constexpr uint8_t cos8(uint8_t theta) {
+    return SIN8.value[(uint8_t)(theta + 64)];
+}
+
+/**
+ * @brief Smooth 0..255..0 wave over one turn, from 0 at theta 0
+ */
+constexpr uint8_t quadwave8(uint8_t theta) {
+    return QUADWAVE8.value[theta];
+}
+
+/**
+ * @brief Perceived brightness to PWM duty (gamma 2.2)
+ */
+constexpr uint8_t gamma8(uint8_t value) {
+    return GAMMA8.value[value];
+}
+
+/**
+ * @brief Phase of a beat at bpm beats per minute, 65536 per beat
+ * 
+ * 280 / 256 stands in for 65536 / 60000 (0.14% fast), so the product
+ * stays in 32 bits: it may wrap, but only its low 24 bits are used.
+ */
+constexpr uint16_t beat16(uint16_t bpm, uint32_t ms, uint32_t timebase = 0) {
+    return (uint16_t)(((ms - timebase) * bpm * 280u) >> 8);
+}
+
+constexpr uint8_t beat8(uint16_t bpm, uint32_t ms, uint32_t timebase = 0) {
+    return (uint8_t)(beat16(bpm, ms, timebase) >> 8);
+}
+
+/**
+ * @brief Sine wave between lowest and highest at bpm beats per minute
+ */
+constexpr uint8_t beatsin8(uint16_t bpm, uint32_t ms, uint8_t lowest = 0, uint8_t highest = 255,
+                           uint32_t timebase = 0, uint8_t phase_offset = 0) {
+    uint8_t wave = sin8((uint8_t)(beat8(bpm, ms, timebase) + phase_offset));
+    return (uint8_t)(lowest + scale8(wave, (uint8_t)(highest - lowest)));
+}
+
+static_assert(sin8(0) == 128 && sin8(64) == 255 && sin8(192) == 0, "sin8 range");
+static_assert(quadwave8(0) == 0 && quadwave8(128) == 255, "quadwave8 phase");
+static_assert(gamma8(0) == 0 && gamma8(255) == 255 && gamma8(128) == 56, "gamma 2.2");
+static_assert(beat16(60, 1000, 1000) == 0 && beat8(60, 500) == 128, "one beat per second");
+
+} // namespace LedMath
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <driver/rmt_encoder.h>
+
+// RMT encoder for WS2812: the GRB bytes MSB first, then the low reset
+// time that latches the frame. resolution_hz is the RMT channel's.
+esp_err_t ws2812_new_encoder(uint32_t resolution_hz, rmt_encoder_handle_t* ret_encoder);
@@ -1,36 +1,93 @@
 #include "led_controller.h"
+#include <esp_attr.h>
 #include <esp_log.h>
 #include <esp_random.h>
 #include <string.h>
 #include <algorithm>
-#include "led_strip.h"
+#include <soc/soc_caps.h>
+#include "ws2812_encoder.h"
 
 #define TAG "LED_CTRL"
+#define RMT_RESOLUTION_HZ (10 * 1000 * 1000) // 10MHz, 0.1us ticks
+#define RMT_MEM_SYMBOLS 64                    // One channel's RAM, refilled from the ISR
+#define RMT_DMA_SYMBOLS 1024                  // DMA buffer, 42 LEDs per refill
+
+// Frame period the per-frame amounts (fades, hue steps) were tuned at
+#define ANIM_FRAME_MS 16
+#define MIN_FPS 15
+#define LOAD_HIGH 128                         // Render time over frame period, Q8: 50%
+#define LOAD_LOW 51                           // 20%
+#define ADAPT_HOLD_FRAMES 16
 
 LedController::LedController() {
     leds.resize(NUM_LEDS);
+    stats.frame_us = frameUs;
 }
 
-bool LedController::init() {
-    ESP_LOGI(TAG, "Initializing LED Strip on GPIO %d", LED_PIN);
+LedController::~LedController() {
+    // The ISR must not call back into a destroyed controller
+    if (rmtChannel) {
+        rmt_tx_wait_all_done(rmtChannel, -1);
+        rmt_disable(rmtChannel);
+        rmt_del_channel(rmtChannel);
+    }
+    if (encoder) rmt_del_encoder(encoder);
+}
 
-    led_strip_config_t strip_config = {
-        .strip_gpio_num = LED_PIN,
-        .max_leds = NUM_LEDS,
-        .led_model = LED_MODEL_WS2812,
-        .flags = { .invert_out = false } 
-    };
+bool LedController::init(gpio_num_t dataPin) {
+    pin = dataPin;
+    ESP_LOGI(TAG, "Initializing LED Strip on GPIO %d", pin);
+
+    // DMA where the RMT has it, so the CPU is not interrupted every few
+    // LEDs; otherwise (or if no DMA channel is free) the ISR refills the
+    // channel RAM. Either way show() does not wait for the transmit.
+    bool ok = false;
+#if SOC_RMT_SUPPORT_DMA
+    ok = initOutput(true);
+#endif
+    if (!ok && !initOutput(false)) {
+        return false;
+    }
+    ESP_LOGI(TAG, "RMT output %s DMA", withDma ? "with" : "without");
 
-    led_strip_rmt_config_t rmt_config = {
-        .clk_src = RMT_CLK_SRC_DEFAULT,
-        .resolution_hz = 10 * 1000 * 1000, // 10MHz
-        .flags = { .with_dma = false }
-    };
+    clear();
+	return true;
+}
 
-    ESP_ERROR_CHECK(led_strip_new_rmt_device(&strip_config, &rmt_config, &led_strip));
-    led_strip_clear(led_strip);
+bool LedController::initOutput(bool dma) {
+    // RMT driven directly rather than through led_strip, so show() can
+    // write the wire format in place and skip frames that did not change
+    rmt_tx_channel_config_t tx_config = {};
+    tx_config.gpio_num = pin;
+    tx_config.clk_src = RMT_CLK_SRC_DEFAULT;
+    tx_config.resolution_hz = RMT_RESOLUTION_HZ;
+    tx_config.mem_block_symbols = dma ? RMT_DMA_SYMBOLS : RMT_MEM_SYMBOLS;
+    tx_config.trans_queue_depth = 1;
+    tx_config.flags.with_dma = dma;
+
+    rmt_tx_event_callbacks_t callbacks = {};
+    callbacks.on_trans_done = onTransmitDone;
+
+    esp_err_t err = rmt_new_tx_channel(&tx_config, &rmtChannel);
+    if (err == ESP_OK) err = rmt_tx_register_event_callbacks(rmtChannel, &callbacks, this);
+    if (err == ESP_OK && !encoder) err = ws2812_new_encoder(RMT_RESOLUTION_HZ, &encoder);
+    if (err == ESP_OK) err = rmt_enable(rmtChannel);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "RMT setup %s DMA failed: %s", dma ? "with" : "without", esp_err_to_name(err));
+        if (rmtChannel) {
+            rmt_del_channel(rmtChannel);
+            rmtChannel = nullptr;
+        }
+        return false;
+    }
+    withDma = dma;
+    return true;
+}
 
-	return true;
+// RMT ISR: the front buffer is free again
+bool IRAM_ATTR LedController::onTransmitDone(rmt_channel_handle_t, const rmt_tx_done_event_data_t*, void* ctx) {
+    static_cast<LedController*>(ctx)->transmitting.store(false, std::memory_order_release);
+    return false;
 }
 
 // ---------------------------------------------------------
@@ -38,14 +95,12 @@ bool LedController::init() {
 // ---------------------------------------------------------
 
 void LedController::update(bool connected) {
-    int64_t now = millis();
+    int64_t now = esp_timer_get_time();
     
     // Handle Duration / Auto-switch
     if (currentAnim != OFF && currentAnim != SOLID_COLOR) {
-        if (animDuration > 0 && (now - animStartTime > animDuration)) {
+        if (clock.expired(now)) {
             // Animation finished
-            currentConfig = "";
-            
             if (nextAnim != OFF) {
                 setAnimation(nextAnim, 5000);
                 nextAnim = OFF;
@@ -58,9 +113,10 @@ void LedController::update(bool connected) {
         }
     }
 
-    // Limit framerate to ~60FPS (16ms)
-    if (now - lastFrameTime < 6) return;
-    lastFrameTime = now;
+    // Limit framerate, with a quarter period of slack for scheduling jitter
+    if (now - lastFrameUs < frameUs - frameUs / 4) return;
+    lastFrameUs = now;
+    clock.tick(now);
 
     // Run Animation Logic
     switch (currentAnim) {
@@ -88,19 +144,50 @@ void LedController::update(bool connected) {
     }
     
     show();
+    adaptFrameRate((uint32_t)(esp_timer_get_time() - now));
+}
+
+// Under CPU pressure render less often: the animations run on the clock,
+// so only smoothness drops, never speed
+void LedController::adaptFrameRate(uint32_t render_us) {
+    uint32_t load = std::min<uint32_t>((uint64_t)render_us * 256 / frameUs, 1024);
+    loadAvg = loadAvg - loadAvg / 16 + load;
+    if (adaptHold > 0) {
+        adaptHold--;
+        return;
+    }
+    
+    uint32_t avg = loadAvg / 16;
+    uint32_t slowest = 1000000 / MIN_FPS;
+    if (avg > LOAD_HIGH && frameUs < slowest) {
+        frameUs = std::min(frameUs * 5 / 4, slowest);
+        stats.slowdowns++;
+        ESP_LOGW(TAG, "Render load %lu%%, frame rate down to %lu FPS",
+                 (unsigned long)(avg * 100 / 256), (unsigned long)(1000000 / frameUs));
+    } else if (avg < LOAD_LOW && frameUs > targetFrameUs) {
+        frameUs = std::max(frameUs * 4 / 5, targetFrameUs);
+    } else {
+        return;
+    }
+    stats.frame_us = frameUs;
+    adaptHold = ADAPT_HOLD_FRAMES;
+}
+
+void LedController::setFrameRate(uint8_t fps) {
+    fps = std::max<uint8_t>(fps, MIN_FPS);
+    targetFrameUs = 1000000 / fps;
+    frameUs = targetFrameUs;
+    stats.frame_us = frameUs;
+    adaptHold = ADAPT_HOLD_FRAMES;
 }
 
 void LedController::setAnimation(int type, int duration_ms, const char* config) {
     currentAnim = (AnimationType)type;
-    animDuration = duration_ms;
-    animStartTime = millis();
-    if (config) currentConfig = config;
+    clock.start(esp_timer_get_time(), std::max(duration_ms, 0));
+    parseConfig(currentAnim, config);
     
     // Reset states
-    state_step = 0;
-    state_val1 = 0;
-    state_float = 0;
-    state_bool = false;
+    state = {};
     
     ESP_LOGI(TAG, "Animation Set: %d, Dur: %d", type, duration_ms);
 }
@@ -114,15 +201,53 @@ void LedController::clear() {
 // Helpers
 // ---------------------------------------------------------
 
-uint32_t LedController::millis() {
-    return (uint32_t)(esp_timer_get_time() / 1000ULL);
-}
-
 void LedController::show() {
-    for (int i = 0; i < NUM_LEDS; i++) {
-        led_strip_set_pixel(led_strip, i, leds[i].r, leds[i].g, leds[i].b);
+    if (!rmtChannel) return;
+    int64_t start = esp_timer_get_time();
+    stats.frames++;
+
+    // Animations work in perceived brightness; the LEDs are linear and take
+    // GRB. Comparing with the front buffer (what the strip shows) while
+    // writing the back one finds an unchanged frame in the same pass.
+    const uint8_t* shown = frames[front];
+    uint8_t* out = frames[front ^ 1];
+    bool dirty = refreshPending;
+    for (const RgbColor& led : leds) {
+        uint8_t g = LedMath::gamma8(led.g);
+        uint8_t r = LedMath::gamma8(led.r);
+        uint8_t b = LedMath::gamma8(led.b);
+        dirty |= (shown[0] != g) | (shown[1] != r) | (shown[2] != b);
+        out[0] = g;
+        out[1] = r;
+        out[2] = b;
+        out += 3;
+        shown += 3;
+    }
+
+    if (!dirty) {
+        stats.skipped++;
+    } else if (transmitting.load(std::memory_order_acquire)) {
+        // Strip slower than the frame rate: drop this frame rather than
+        // wait, the next one is compared against what is on the wire
+        stats.busy++;
+    } else {
+        // Mark busy first: the ISR may finish before rmt_transmit() returns
+        transmitting.store(true, std::memory_order_relaxed);
+        rmt_transmit_config_t tx_config = {};
+        esp_err_t err = rmt_transmit(rmtChannel, encoder, frames[front ^ 1], sizeof(frames[0]), &tx_config);
+        if (err == ESP_OK) {
+            front ^= 1;
+            refreshPending = false;
+            stats.refreshes++;
+        } else {
+            transmitting.store(false, std::memory_order_relaxed);
+            stats.errors++;
+        }
     }
-    led_strip_refresh(led_strip);
+
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+    stats.show_us += elapsed;
+    stats.show_max_us = std::max(stats.show_max_us, elapsed);
 }
 
 void LedController::setPixel(int idx, RgbColor color) {
@@ -137,9 +262,18 @@ void LedController::setAll(RgbColor color) {
     for(auto& led : leds) led = color;
 }
 
+// amount is per 16 ms frame; compounded over the time since the last
+// frame so trails keep their length at any frame rate
 void LedController::fadeToBlack(uint8_t amount) {
+    uint32_t ms = std::min<uint32_t>(clock.dt_ms, 16 * ANIM_FRAME_MS);
+    if (ms == 0) return;
+    uint32_t keep = 256;
+    for (; ms >= ANIM_FRAME_MS; ms -= ANIM_FRAME_MS) keep = keep * (255 - amount) >> 8;
+    if (ms > 0) keep = keep * (256 - amount * ms / ANIM_FRAME_MS) >> 8;
+    keep = std::min<uint32_t>(keep, 255);
+    
     for(auto& led : leds) {
-        led.scale(255 - amount);
+        led.scale(keep);
     }
 }
 
@@ -172,42 +306,137 @@ RgbColor LedController::hsv2rgb(uint8_t h, uint8_t s, uint8_t v) {
 }
 
 uint8_t LedController::beatsin8(uint8_t bpm, uint8_t lowest, uint8_t highest, uint32_t time_shift, uint8_t phase_offset) {
-    uint8_t beat = 0;
-    uint32_t m = millis();
-    uint16_t beat16 = (m * bpm * 280) / 60000; // Approximate math
-    uint8_t wave = (sin((beat16 + phase_offset) * 3.14159 / 128.0) + 1.0) * 127.5;
-    
-    return lowest + (((highest - lowest) * wave) >> 8);
+    return LedMath::beatsin8(bpm, clock.elapsed_ms, lowest, highest, time_shift, phase_offset);
 }
 
 // ---------------------------------------------------------
-// Config Parser (Simplified)
+// Config Parser
 // ---------------------------------------------------------
 
-int LedController::getConfigInt(const char* key, int defaultVal) {
-    std::string k = key; k += ":";
-    size_t pos = currentConfig.find(k);
-    if (pos == std::string::npos) return defaultVal;
-    return atoi(currentConfig.c_str() + pos + k.length());
+// Defaults are what each animation did before it took a config
+static const AnimSchema ANIM_SCHEMAS[] = {
+    // SPEED in beats per minute
+    {CONF_PULSE, PARAM_SPEED | PARAM_COLOR, 1, 240,
+        {15, RgbColor(0, 0, 255), RgbColor(), 0, 1}},
+    // SPEED in ms per step
+    {CONF_CHASE, PARAM_SPEED | PARAM_COLOR | PARAM_FADE | PARAM_DIRECTION, 10, 5000,
+        {100, RgbColor(255, 0, 0), RgbColor(), 40, 1}},
+    // SPEED as a relative rate
+    {CONF_PLASMA, PARAM_SPEED, 1, 200,
+        {20, RgbColor(), RgbColor(), 0, 1}},
+    {CONF_AURORA, PARAM_SPEED, 1, 200,
+        {20, RgbColor(), RgbColor(), 0, 1}},
+};
+
+static const struct {
+    const char* name;
+    AnimParam param;
+} PARAM_KEYS[] = {
+    {"SPEED", PARAM_SPEED},
+    {"COLOR", PARAM_COLOR},
+    {"COLOR2", PARAM_COLOR2},
+    {"FADE", PARAM_FADE},
+    {"DIR", PARAM_DIRECTION},
+};
+
+const AnimSchema* LedController::findSchema(AnimationType type) {
+    for (const auto& schema : ANIM_SCHEMAS) {
+        if (schema.type == type) return &schema;
+    }
+    return nullptr;
 }
 
-RgbColor LedController::getConfigColor(const char* key, RgbColor defaultVal) {
-    std::string k = key; k += ":";
-    size_t pos = currentConfig.find(k);
-    if (pos == std::string::npos) return defaultVal;
-    
-    // Very basic HEX parser (assumes #RRGGBB format)
-    const char* val = currentConfig.c_str() + pos + k.length();
-    if (val[0] == '#') {
-        uint32_t c = strtoul(val + 1, NULL, 16);
-        return RgbColor((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF);
+bool LedController::parseColor(const char* val, size_t len, RgbColor& out) {
+    // #RRGGBB
+    if (len == 7 && val[0] == '#') {
+        uint32_t c = 0;
+        for (size_t i = 1; i < len; i++) {
+            char ch = val[i];
+            int digit = (ch >= '0' && ch <= '9') ? ch - '0' :
+                        (ch >= 'A' && ch <= 'F') ? ch - 'A' + 10 :
+                        (ch >= 'a' && ch <= 'f') ? ch - 'a' + 10 : -1;
+            if (digit < 0) return false;
+            c = (c << 4) | digit;
+        }
+        out = RgbColor((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF);
+        return true;
     }
     // Named colors could be added here
-    if (strncmp(val, "RED", 3) == 0) return RgbColor(255, 0, 0);
-    if (strncmp(val, "BLUE", 4) == 0) return RgbColor(0, 0, 255);
-    if (strncmp(val, "GREEN", 5) == 0) return RgbColor(0, 255, 0);
+    if (len == 3 && strncmp(val, "RED", 3) == 0) { out = RgbColor(255, 0, 0); return true; }
+    if (len == 4 && strncmp(val, "BLUE", 4) == 0) { out = RgbColor(0, 0, 255); return true; }
+    if (len == 5 && strncmp(val, "GREEN", 5) == 0) { out = RgbColor(0, 255, 0); return true; }
+    return false;
+}
+
+void LedController::parseConfig(AnimationType type, const char* config) {
+    const AnimSchema* schema = findSchema(type);
+    if (schema) {
+        params = schema->defaults;
+    } else {
+        params = AnimParams();
+        params.direction = 1;
+    }
+    if (!config || !config[0]) return;
+    
+    if (!schema) {
+        ESP_LOGW(TAG, "Animation %d takes no config, ignoring '%s'", type, config);
+        return;
+    }
     
-    return defaultVal;
+    // KEY:VALUE pairs separated by commas; bad entries keep the default
+    const char* p = config;
+    while (*p) {
+        const char* end = strchr(p, ',');
+        if (!end) end = p + strlen(p);
+        const char* colon = (const char*)memchr(p, ':', end - p);
+        
+        uint8_t param = 0;
+        if (colon) {
+            for (const auto& key : PARAM_KEYS) {
+                if (strlen(key.name) == (size_t)(colon - p) && strncmp(p, key.name, colon - p) == 0) {
+                    param = key.param;
+                    break;
+                }
+            }
+        }
+        
+        if (!(schema->params & param)) {
+            ESP_LOGW(TAG, "Animation %d: unknown config '%.*s'", type, (int)(end - p), p);
+        } else {
+            const char* val = colon + 1;
+            size_t len = end - val;
+            char* num_end = nullptr;
+            long num = strtol(val, &num_end, 10);
+            bool is_num = len > 0 && num_end == end;
+            bool ok = true;
+            
+            switch (param) {
+                case PARAM_SPEED:
+                    ok = is_num;
+                    if (ok) params.speed = std::min<long>(std::max<long>(num, schema->min_speed), schema->max_speed);
+                    if (ok && params.speed != num) {
+                        ESP_LOGW(TAG, "Animation %d: SPEED %ld out of %u-%u", type, num,
+                                 schema->min_speed, schema->max_speed);
+                    }
+                    break;
+                case PARAM_COLOR: ok = parseColor(val, len, params.color); break;
+                case PARAM_COLOR2: ok = parseColor(val, len, params.color2); break;
+                case PARAM_FADE:
+                    ok = is_num && num >= 0 && num <= 255;
+                    if (ok) params.fade = num;
+                    break;
+                case PARAM_DIRECTION:
+                    if (len == 3 && strncmp(val, "FWD", 3) == 0) params.direction = 1;
+                    else if (len == 3 && strncmp(val, "REV", 3) == 0) params.direction = -1;
+                    else ok = false;
+                    break;
+            }
+            if (!ok) {
+                ESP_LOGW(TAG, "Animation %d: bad value '%.*s'", type, (int)(end - p), p);
+            }
+        }
+        p = *end ? end + 1 : end;
+    }
 }
 
 // ---------------------------------------------------------
@@ -216,8 +445,7 @@ RgbColor LedController::getConfigColor(const char* key, RgbColor defaultVal) {
 
 void LedController::anim_processing() {
     fadeToBlack(64);
-    uint32_t m = millis();
-    int pos = (m / 100) % NUM_LEDS; // Rotate every 100ms
+    int pos = (clock.elapsed_ms / 100) % NUM_LEDS; // Rotate every 100ms
     
     for(int i = 0; i < 3; i++) {
         int idx = (pos + i) % NUM_LEDS;
@@ -232,14 +460,15 @@ void LedController::anim_success() {
     uint8_t bright = beatsin8(30, 100, 255);
     
     for(int i=0; i<NUM_LEDS; i++) {
-        if((esp_random() % 100) < 10) leds[i] = RgbColor(255, 255, 255); // Sparkle
+        // Sparkle: 10% of the LEDs per 16 ms, whatever the frame rate
+        if((esp_random() % (100 * ANIM_FRAME_MS)) < 10 * clock.dt_ms) leds[i] = RgbColor(255, 255, 255);
         leds[i].scale(bright);
     }
 }
 
 void LedController::anim_waiting() {
     fadeToBlack(20);
-    int pos = (millis() / 100) % NUM_LEDS;
+    int pos = (clock.elapsed_ms / 100) % NUM_LEDS;
     uint8_t b = beatsin8(30, 50, 255);
     RgbColor c(255, 255, 255);
     c.scale(b);
@@ -247,8 +476,7 @@ void LedController::anim_waiting() {
 }
 
 void LedController::anim_rainbow_pulse() {
-    static uint8_t hue = 0;
-    hue++; // Cycles automatically per frame
+    uint8_t hue = clock.elapsed_ms / ANIM_FRAME_MS; // One step per 16 ms
     uint8_t bri = beatsin8(30, 100, 255);
     
     for(int i=0; i<NUM_LEDS; i++) {
@@ -260,30 +488,27 @@ void LedController::anim_rainbow_pulse() {
 void LedController::anim_firework() {
     fadeToBlack(64);
     
-    // State machine using member variables
-    if(state_step == 0) {
+    // State machine using member variables. Launch, explode 112 ms later,
+    // relaunch 336 ms after the launch: timed from the cycle start, not the
+    // frame that noticed, so the cycle keeps time at any frame rate
+    if(state.step == 0 || clock.elapsed_ms - state.mark_ms >= 336) {
         // Launch
         setPixel(NUM_LEDS/2, RgbColor(255, 255, 255));
-        state_step = 1;
-        state_val1 = millis(); // Timestamp
-    } else if (state_step == 1) {
+        state.step = 1;
+        state.mark_ms = clock.elapsed_ms - clock.elapsed_ms % 336;
+    } else if (state.step == 1 && clock.elapsed_ms - state.mark_ms >= 112) {
         // Explode
-        if (millis() - state_val1 > 100) {
-            int center = NUM_LEDS/2;
-            for(int i=1; i<=2; i++) {
-                setPixel(center+i, RgbColor(255, 200, 0));
-                setPixel(center-i, RgbColor(255, 200, 0));
-            }
-            state_step = 2;
-            state_val1 = millis();
+        int center = NUM_LEDS/2;
+        for(int i=1; i<=2; i++) {
+            setPixel(center+i, RgbColor(255, 200, 0));
+            setPixel(center-i, RgbColor(255, 200, 0));
         }
-    } else {
-        if (millis() - state_val1 > 200) state_step = 0; // Reset
+        state.step = 2;
     }
 }
 
 void LedController::anim_police() {
-    bool redPhase = (millis() / 200) % 2 == 0;
+    bool redPhase = (clock.elapsed_ms / 200) % 2 == 0;
     for(int i=0; i<NUM_LEDS; i++) {
         if(i < NUM_LEDS/2) setPixel(i, redPhase ? RgbColor(255,0,0) : RgbColor(0,0,0));
         else setPixel(i, redPhase ? RgbColor(0,0,0) : RgbColor(0,0,255));
@@ -314,29 +539,25 @@ void LedController::anim_fire() {
 }
 
 void LedController::anim_device_shutdown() {
-    // Collapse to center
-    if(state_step == 0) {
-        state_val1 = 255; // Brightness
-        state_step = 1;
-    }
-    
-    if(state_val1 > 5) state_val1 -= 5;
-    else state_val1 = 0;
+    // Collapse to center: out over the duration if there is one, else
+    // 5 steps of brightness per 16 ms
+    uint32_t fade = clock.duration_ms > 0 ? clock.progress >> 8 : clock.elapsed_ms * 5 / ANIM_FRAME_MS;
+    uint8_t bright = 255 - std::min<uint32_t>(fade, 255);
     
     int center = NUM_LEDS / 2;
     setAll(RgbColor(0,0,0));
     
-    if(state_val1 > 0) {
+    if(bright > 0) {
         // Only light up center pixels fading out
-        setPixel(center, RgbColor(state_val1, state_val1, state_val1));
-        setPixel(center-1, RgbColor(state_val1, state_val1, state_val1));
+        setPixel(center, RgbColor(bright, bright, bright));
+        setPixel(center-1, RgbColor(bright, bright, bright));
     }
 }
 
 void LedController::anim_wake_word() {
     fadeToBlack(60);
     int center = NUM_LEDS / 2;
-    int width = (millis() / 50) % (NUM_LEDS/2 + 1);
+    int width = (clock.elapsed_ms / 50) % (NUM_LEDS/2 + 1);
     
     setPixel(center, RgbColor(0, 100, 255));
     for(int i=1; i<=width; i++) {
@@ -350,7 +571,6 @@ void LedController::anim_wake_word() {
 void LedController::anim_voice_response() {
     fadeToBlack(40);
     // Voice waveform simulation using multiple sine waves
-    uint32_t t = millis();
     for(int i=0; i<NUM_LEDS; i++) {
         uint8_t wave = beatsin8(60, 10, 255, 0, i*30);
         leds[i] = RgbColor(255, 255, 255);
@@ -363,42 +583,37 @@ void LedController::anim_voice_response() {
 // ---------------------------------------------------------
 
 void LedController::anim_conf_pulse() {
-    int speed = getConfigInt("SPEED", 15);
-    RgbColor col = getConfigColor("COLOR", RgbColor(0,0,255));
-    
-    uint8_t b = beatsin8(speed, 50, 255);
-    setAll(col);
+    uint8_t b = beatsin8(params.speed, 50, 255);
+    setAll(params.color);
     for(int i=0; i<NUM_LEDS; i++) leds[i].scale(b);
 }
 
 void LedController::anim_conf_chase() {
-    fadeToBlack(getConfigInt("FADE", 40));
-    int speed = getConfigInt("SPEED", 100);
-    RgbColor col = getConfigColor("COLOR", RgbColor(255,0,0));
+    fadeToBlack(params.fade);
     
-    int pos = (millis() / speed) % NUM_LEDS;
-    setPixel(pos, col);
+    int pos = (clock.elapsed_ms / params.speed) % NUM_LEDS;
+    if (params.direction < 0) pos = NUM_LEDS - 1 - pos;
+    setPixel(pos, params.color);
 }
 
 void LedController::anim_conf_plasma() {
-    int speed = getConfigInt("SPEED", 20);
-    uint32_t t = millis() * speed / 10;
+    uint32_t t = (uint64_t)clock.elapsed_ms * params.speed / 100;
     
+    // Two waves across the strip at different speeds, 8-bit angles
     for(int i=0; i<NUM_LEDS; i++) {
-        uint8_t v1 = sin(i * 10 + t) * 127 + 128;
-        uint8_t v2 = sin((i*15) + (t/2)) * 127 + 128;
+        uint8_t v1 = LedMath::sin8(i * 10 + t);
+        uint8_t v2 = LedMath::sin8(i * 15 + t / 2);
         setPixel(i, hsv2rgb((v1+v2)/2, 255, 255));
     }
 }
 
 void LedController::anim_conf_aurora() {
-    int speed = getConfigInt("SPEED", 20);
-    static uint16_t time = 0;
-    time += speed;
+    uint16_t time = (uint64_t)clock.elapsed_ms * params.speed / ANIM_FRAME_MS; // speed per 16 ms
     
-    // Simple Perlin-ish noise approximation
+    // Simple Perlin-ish noise approximation: 0.01 rad is 26/64 of an
+    // 8-bit angle step, and the 16-bit time wraps on a whole turn
     for(int i=0; i<NUM_LEDS; i++) {
-        uint8_t noise = (sin((i * 50 + time) * 0.01) + 1.0) * 127.5;
+        uint8_t noise = LedMath::sin8(((uint32_t)(i * 50 + time) * 26) >> 6);
         uint8_t hue = 120 + (noise / 3); // Greenish-Purple range
         setPixel(i, hsv2rgb(hue, 200, noise));
     }
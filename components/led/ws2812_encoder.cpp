@@ -0,0 +1,108 @@
+#include "ws2812_encoder.h"
+#include <stdlib.h>
+
+// WS2812 bit timings and the reset (latch) time, in ns
+#define T0H_NS 300
+#define T0L_NS 900
+#define T1H_NS 900
+#define T1L_NS 300
+#define RESET_NS 50000
+
+namespace {
+
+struct Ws2812Encoder {
+    rmt_encoder_t base;                 // First, so the callbacks can cast back
+    rmt_encoder_handle_t bytesEncoder;  // Pixel data
+    rmt_encoder_handle_t copyEncoder;   // Reset code
+    rmt_symbol_word_t resetCode;
+    bool sendingReset;
+};
+
+uint16_t ticks(uint32_t resolution_hz, uint32_t ns) {
+    return (uint16_t)((uint64_t)resolution_hz * ns / 1000000000ULL);
+}
+
+// Called from the RMT ISR until the frame is in the channel memory; may
+// stop part way with MEM_FULL and resume where it left off
+size_t ws2812_encode(rmt_encoder_t* encoder, rmt_channel_handle_t channel, const void* data, size_t size,
+                     rmt_encode_state_t* ret_state) {
+    Ws2812Encoder* ws = reinterpret_cast<Ws2812Encoder*>(encoder);
+    rmt_encode_state_t session = RMT_ENCODING_RESET;
+    int state = RMT_ENCODING_RESET;
+    size_t encoded = 0;
+    
+    if (!ws->sendingReset) {
+        encoded += ws->bytesEncoder->encode(ws->bytesEncoder, channel, data, size, &session);
+        if (session & RMT_ENCODING_COMPLETE) ws->sendingReset = true;
+        if (session & RMT_ENCODING_MEM_FULL) {
+            *ret_state = (rmt_encode_state_t)(state | RMT_ENCODING_MEM_FULL);
+            return encoded;
+        }
+    }
+    
+    encoded += ws->copyEncoder->encode(ws->copyEncoder, channel, &ws->resetCode, sizeof(ws->resetCode), &session);
+    if (session & RMT_ENCODING_COMPLETE) {
+        ws->sendingReset = false;
+        state |= RMT_ENCODING_COMPLETE;
+    }
+    if (session & RMT_ENCODING_MEM_FULL) state |= RMT_ENCODING_MEM_FULL;
+    *ret_state = (rmt_encode_state_t)state;
+    return encoded;
+}
+
+esp_err_t ws2812_reset(rmt_encoder_t* encoder) {
+    Ws2812Encoder* ws = reinterpret_cast<Ws2812Encoder*>(encoder);
+    rmt_encoder_reset(ws->bytesEncoder);
+    rmt_encoder_reset(ws->copyEncoder);
+    ws->sendingReset = false;
+    return ESP_OK;
+}
+
+esp_err_t ws2812_del(rmt_encoder_t* encoder) {
+    Ws2812Encoder* ws = reinterpret_cast<Ws2812Encoder*>(encoder);
+    if (ws->bytesEncoder) rmt_del_encoder(ws->bytesEncoder);
+    if (ws->copyEncoder) rmt_del_encoder(ws->copyEncoder);
+    free(ws);
+    return ESP_OK;
+}
+
+} // namespace
+
+esp_err_t ws2812_new_encoder(uint32_t resolution_hz, rmt_encoder_handle_t* ret_encoder) {
+    if (!ret_encoder || resolution_hz == 0) return ESP_ERR_INVALID_ARG;
+    
+    Ws2812Encoder* ws = static_cast<Ws2812Encoder*>(calloc(1, sizeof(Ws2812Encoder)));
+    if (!ws) return ESP_ERR_NO_MEM;
+    ws->base.encode = ws2812_encode;
+    ws->base.reset = ws2812_reset;
+    ws->base.del = ws2812_del;
+    
+    rmt_bytes_encoder_config_t bytes_config = {};
+    bytes_config.bit0.level0 = 1;
+    bytes_config.bit0.duration0 = ticks(resolution_hz, T0H_NS);
+    bytes_config.bit0.level1 = 0;
+    bytes_config.bit0.duration1 = ticks(resolution_hz, T0L_NS);
+    bytes_config.bit1.level0 = 1;
+    bytes_config.bit1.duration0 = ticks(resolution_hz, T1H_NS);
+    bytes_config.bit1.level1 = 0;
+    bytes_config.bit1.duration1 = ticks(resolution_hz, T1L_NS);
+    bytes_config.flags.msb_first = 1;
+    
+    rmt_copy_encoder_config_t copy_config = {};
+    esp_err_t err = rmt_new_bytes_encoder(&bytes_config, &ws->bytesEncoder);
+    if (err == ESP_OK) err = rmt_new_copy_encoder(&copy_config, &ws->copyEncoder);
+    if (err != ESP_OK) {
+        ws2812_del(&ws->base);
+        return err;
+    }
+    
+    // Low for the whole reset time, split over the symbol's two halves
+    uint16_t half = ticks(resolution_hz, RESET_NS / 2);
+    ws->resetCode.level0 = 0;
+    ws->resetCode.duration0 = half;
+    ws->resetCode.level1 = 0;
+    ws->resetCode.duration1 = half;
+    
+    *ret_encoder = &ws->base;
+    return ESP_OK;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file spsc_ring.h
+ * @brief Lock-free single-producer/single-consumer ring
+ * 
+ * Fixed capacity, no heap allocation. Exactly one task may push and
+ * exactly one (other) task may pop; no locks or critical sections are
+ * taken on either side.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace LockFree {
+
+/**
+ * @brief Bounded SPSC ring of trivially copyable values
+ * 
+ * @tparam T        Element type (typically a small handle or index)
+ * @tparam Capacity Number of slots, must be a power of two
+ */
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRing capacity must be a power of two");
+    
+public:
+    SpscRing() : m_head(0), m_tail(0) {}
+    
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+    
+    /**
+     * @brief Producer side: append a value
+     * @return false if the ring is full
+     */
+    bool push(const T& value) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        size_t tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail >= Capacity) {
+            return false;
+        }
+        m_slots[head & (Capacity - 1)] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    
+    /**
+     * @brief Consumer side: remove the oldest value
+     * @return false if the ring is empty
+     */
+    bool pop(T& value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t head = m_head.load(std::memory_order_acquire);
+        if (head == tail) {
+            return false;
+        }
+        value = m_slots[tail & (Capacity - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    
+    /**
+     * @brief Consumer side: look at the oldest value without removing it
+     * @return nullptr if the ring is empty
+     */
+    const T* peek() const {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t head = m_head.load(std::memory_order_acquire);
+        if (head == tail) {
+            return nullptr;
+        }
+        return &m_slots[tail & (Capacity - 1)];
+    }
+    
+    /**
+     * @brief Approximate fill level (exact when called from either end)
+     */
+    size_t size() const {
+        return m_head.load(std::memory_order_acquire) -
+               m_tail.load(std::memory_order_acquire);
+    }
+    
+    bool empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return Capacity; }
+    
+private:
+    T m_slots[Capacity];
+    std::atomic<size_t> m_head;  // Written by producer only
+    std::atomic<size_t> m_tail;  // Written by consumer only
+};
+
+} // namespace LockFree
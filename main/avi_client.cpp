@@ -0,0 +1,123 @@
+/**
+ * @file avi_client.cpp
+ * @brief AVI client implementation
+ */
+
+#include "avi_client.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+static const char* TAG = "AVI_CLIENT";
+
+AviClient::AviClient(AVI::Transport& transport)
+    : m_transport(transport)
+    , m_avi(nullptr)
+    , m_msg_callback(nullptr)
+    , m_msg_user_data(nullptr)
+    , m_stats{} {
+}
+
+AviClient::~AviClient() {
+    if (m_avi) {
+        avi_embedded_free(m_avi);
+    }
+}
+
+bool AviClient::init() {
+    if (m_avi) {
+        return true;  // Session is reused across reconnects
+    }
+    
+    AVI_AviEmbeddedConfig config = {
+        .device_id = DEVICE_ID
+    };
+    
+    ESP_LOGI(TAG, "Initializing AVI (device: 0x%llx)", DEVICE_ID);
+    
+    m_avi = avi_embedded_new(
+        config,
+        m_scratch_buffer,
+        sizeof(m_scratch_buffer),
+        &m_transport,
+        &AviClient::sendCallback,
+        &AviClient::receiveCallback,
+        m_msg_user_data,
+        m_msg_callback
+    );
+    
+    if (!m_avi) {
+        ESP_LOGE(TAG, "Failed to create AVI instance");
+        return false;
+    }
+    
+    ESP_LOGI(TAG, "AVI initialized (heap: %lu)", esp_get_free_heap_size());
+    return true;
+}
+
+bool AviClient::connect() {
+    int ret = avi_embedded_connect(m_avi);
+    if (ret == 0) {
+        ESP_LOGI(TAG, "AVI connect queued");
+        return true;
+    }
+    ESP_LOGW(TAG, "AVI connect failed: %d", ret);
+    return false;
+}
+
+uint32_t AviClient::poll() {
+    if (!m_avi) {
+        return 0;
+    }
+    
+    int64_t start = esp_timer_get_time();
+    uint32_t backlog = static_cast<uint32_t>(m_transport.getRxBacklog());
+    uint32_t drained = 0;
+    bool budget_hit = false;
+    
+    while (true) {
+        uint32_t rx_before = m_transport.getRxPacketCount();
+        avi_embedded_poll(m_avi);
+        uint32_t rx_count = m_transport.getRxPacketCount() - rx_before;
+    
+        if (rx_count == 0) {
+            break;  // Core found nothing to read
+        }
+        drained += rx_count;
+    
+        if (!m_transport.hasPendingData()) {
+            break;
+        }
+        if (drained >= AVI_POLL_MAX_PACKETS ||
+            esp_timer_get_time() - start >= AVI_POLL_BUDGET_US) {
+            budget_hit = true;
+            break;
+        }
+    }
+    
+    m_stats.iterations++;
+    m_stats.packets += drained;
+    m_stats.last_drained = drained;
+    if (drained > m_stats.drained_max) {
+        m_stats.drained_max = drained;
+    }
+    m_stats.last_backlog = backlog;
+    if (backlog > m_stats.backlog_max) {
+        m_stats.backlog_max = backlog;
+    }
+    if (budget_hit) {
+        m_stats.budget_exhausted++;
+    }
+    
+    return drained;
+}
+
+int32_t AviClient::sendCallback(void* user_data, const uint8_t* buf, size_t len) {
+    auto* transport = static_cast<AVI::Transport*>(user_data);
+    return transport->send(buf, len);
+}
+
+int32_t AviClient::receiveCallback(void* user_data, uint8_t* buf, size_t len) {
+    auto* transport = static_cast<AVI::Transport*>(user_data);
+    return transport->receive(buf, len);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file avi_client.h
+ * @brief AVI core session bound to a Transport
+ * 
+ * Kept out of main.cpp so the same client can be run on the host over
+ * PosixUdpTransport (tools/transport_bench.cpp).
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "avi_embedded.h"
+#include "device_config.h"
+#include "transport.h"
+
+/**
+ * @brief High-level AVI client that integrates transport and protocol
+ */
+class AviClient {
+public:
+    /**
+     * @brief Polling statistics, accumulated across loop iterations
+     */
+    struct PollStats {
+        uint32_t iterations;          // poll() calls
+        uint32_t packets;             // Datagrams handed to the AVI core
+        uint32_t last_drained;        // Datagrams drained by the last poll()
+        uint32_t drained_max;         // Most datagrams drained in one poll()
+        uint32_t last_backlog;        // Datagrams waiting when the last poll() began
+        uint32_t backlog_max;         // Most datagrams waiting when a poll() began
+        uint32_t budget_exhausted;    // poll() calls that stopped on budget
+    };
+    
+    AviClient(AVI::Transport& transport);
+    ~AviClient();
+    
+    AviClient(const AviClient&) = delete;
+    AviClient& operator=(const AviClient&) = delete;
+    
+    /**
+     * @brief Set the inbound message callback (before init())
+     */
+    void onMessage(AVI_CMessageCallback callback, void* user_data) {
+        m_msg_callback = callback;
+        m_msg_user_data = user_data;
+    }
+    
+    bool init();
+    bool connect();
+    
+    /**
+     * @brief Drain inbound datagrams into the AVI core
+     * 
+     * Keeps calling avi_embedded_poll() while the transport has data queued,
+     * bounded by AVI_POLL_MAX_PACKETS and AVI_POLL_BUDGET_US.
+     * 
+     * @return Number of datagrams consumed by the core
+     */
+    uint32_t poll();
+    
+    bool isConnected() const {
+        return m_avi && avi_embedded_is_connected(m_avi);
+    }
+    
+    AVI_AviEmbedded* getHandle() { return m_avi; }
+    const PollStats& getPollStats() const { return m_stats; }
+    
+private:
+    static int32_t sendCallback(void* user_data, const uint8_t* buf, size_t len);
+    static int32_t receiveCallback(void* user_data, uint8_t* buf, size_t len);
+    
+    AVI::Transport& m_transport;
+    AVI_AviEmbedded* m_avi;
+    AVI_CMessageCallback m_msg_callback;
+    void* m_msg_user_data;
+    PollStats m_stats;
+    uint8_t m_scratch_buffer[SCRATCH_BUFFER_SIZE];
+};
@@ -29,6 +29,13 @@
 #define AVI_SERVER_IP  "192.168.1.111"
 #define AVI_SERVER_PORT 8888
 
+// Fast association: reuse the last-good BSSID/channel cached in NVS, and
+// optionally the last DHCP lease as a static IP (only safe when the
+// router reserves the address for this device)
+#define WIFI_FAST_CONNECT           1
+#define WIFI_CACHED_STATIC_IP       0
+#define WIFI_FAST_CONNECT_ATTEMPTS  2
+
 // ============================================================================
 // Device Identity
 // ============================================================================
@@ -45,12 +52,16 @@
 #define TOPIC_LED_ANIMATION     "device/led/animation"
 #define TOPIC_LED_CLEAR         "device/led/clear"
 #define TOPIC_AUDIO_DATA        "device/audio/data"
+#define TOPIC_AUDIO_EARCON      "device/audio/earcon"   // Clip id to play from flash
+#define TOPIC_AUDIO_TONE        "device/audio/tone"     // "hz,ms" beep synthesized on the device
 #define TOPIC_COMMAND           "device/command"
 
 // Publications (device sends to these)
 #define TOPIC_BUTTON_EVENT      "device/button/event"
 #define TOPIC_STATUS            "device/status"
 #define TOPIC_HEARTBEAT         "device/heartbeat"
+#define TOPIC_AUDIO_UPLINK      "device/audio/uplink"   // Only with AUDIO_UPLINK_STREAM 0
+#define TOPIC_AUDIO_VAD         "device/audio/vad"      // Talkspurt start/end from the microphone
 
 // ============================================================================
 // Board-Specific Feature Flags
@@ -60,6 +71,7 @@
     #define FEATURE_AUDIO_OUTPUT
     #define FEATURE_BUTTON_INPUT
     #define FEATURE_LED_STRIP
+    // #define FEATURE_MICROPHONE   // Off until capture is verified on hardware
     
     // Korvo v1.1 has 6 buttons on a resistor ladder connected to GPIO36 (ADC1_CH0)
     #define BUTTON_COUNT 6
@@ -77,13 +89,25 @@
     };
     static const float BUTTON_TOLERANCE = 0.2f;  // ±0.2V tolerance
     
-    #define PIN_LED_DATA        GPIO_NUM_22
+    // Handled on the device (master volume), still reported to the server
+    #define BUTTON_VOLUME_DOWN  4
+    #define BUTTON_VOLUME_UP    5
+    
+    #define PIN_LED_DATA        GPIO_NUM_33     // Drives the LED ring on shipped boards
     #define PIN_I2S_BCK         GPIO_NUM_27
     #define PIN_I2S_WS          GPIO_NUM_25
     #define PIN_I2S_DATA_OUT    GPIO_NUM_26
     
-    #define LED_COUNT           12
+    // Microphone array ADC (ES7210) on the second I2S port. Not yet checked
+    // against a board: these only stay clear of the pins above. The ADC
+    // also takes MCLK and register setup over I2C, which this driver does
+    // not do yet.
+    #define PIN_MIC_BCK         GPIO_NUM_32
+    #define PIN_MIC_WS          GPIO_NUM_21
+    #define PIN_MIC_DATA_IN     GPIO_NUM_36
     
+    #define LED_COUNT           12
+
 #elif defined(BOARD_ESP32_DEVKIT_V1)
     #define FEATURE_BUTTON_INPUT
     #define FEATURE_LED_STRIP
@@ -92,11 +116,11 @@
     #define PIN_BUTTON          GPIO_NUM_0
     #define PIN_LED_DATA        GPIO_NUM_5
     #define LED_COUNT           8
-    
+
 #elif defined(BOARD_CUSTOM)
     // Define your custom board features here
     #error "Please configure BOARD_CUSTOM features"
-    
+
 #else
     #error "No board selected! Please define a board type in device_config.h"
 #endif
@@ -105,10 +129,99 @@
 // Application Configuration
 // ============================================================================
 
-#define MAIN_TASK_STACK_SIZE    8192
-#define MAIN_TASK_PRIORITY      5
+// Task layout: one row per task domain with its task name, stack size
+// (bytes), priority and core. Network/AVI shares the PRO core (0) with
+// the Wi-Fi and lwIP tasks; real-time media runs on the APP core (1).
+// Use tskNO_AFFINITY to let FreeRTOS place a task. Task wakeups are tick
+// based, so periods below 10 ms want CONFIG_FREERTOS_HZ=1000.
+#define TASK_LAYOUT(X) \
+    /*  domain    name        stack  prio  core */ \
+    X(NETWORK,   "avi_net",   8192,  5,    0) \
+    X(AUDIO,     "audio",     4096,  7,    1) \
+    X(RENDER,    "render",    4096,  3,    1) \
+    X(INPUT,     "input",     3072,  4,    1) \
+    X(CAPTURE,   "mic",       3072,  6,    1)
 #define SCRATCH_BUFFER_SIZE     2048
 
 #define WIFI_CONNECT_TIMEOUT_MS 10000
-#define AVI_CONNECT_DELAY_MS    2000
-#define MAIN_LOOP_INTERVAL_MS   50
+#define AVI_SESSION_TIMEOUT_MS  5000    // Wait for the server to accept a connect
+#define AVI_BACKOFF_MIN_MS      500     // First retry delay after a failed connect
+#define AVI_BACKOFF_MAX_MS      30000   // Retry delay cap
+
+// Feature scheduling: each periodic feature is released every period and
+// may start up to its deadline late before the run counts as a miss.
+// Packets and link timers wake the main loop in between.
+#define LED_UPDATE_PERIOD_MS    16      // ~60 FPS
+#define LED_UPDATE_DEADLINE_MS  8
+#define BUTTON_SAMPLE_PERIOD_MS 10
+#define BUTTON_SAMPLE_DEADLINE_MS 5
+
+// Audio playback: 16-bit interleaved PCM, buffered to absorb network jitter.
+// The jitter buffer depth adapts between the prebuffer and the maximum.
+#define AUDIO_SAMPLE_RATE       44100
+#define AUDIO_CHANNELS          2
+#define AUDIO_PREBUFFER_MS      40      // Minimum depth before playback (re)starts
+#define AUDIO_JITTER_MAX_MS     200     // Upper bound for the adaptive depth
+#define AUDIO_JITTER_MULTIPLIER 4       // Depth covers this many jitter estimates
+#define AUDIO_LOW_WATER_MS      20      // Dips below this are counted as near-underruns
+#define AUDIO_FADE_MS           5       // Fade-out on loss/underrun, fade-in on resume, trim crossfade
+#define AUDIO_FLUSH_TIMEOUT_MS  100     // Play a short tail once the stream has been quiet this long
+#define AUDIO_EARCON_PARTITION  "earcons"   // Label in partitions.csv, image from tools/pack_earcons.py
+
+// Streams at other rates (8 kHz up to twice AUDIO_SAMPLE_RATE) or in mono are
+// resampled to the output. The resampler also runs up to AUDIO_DRIFT_MAX_PPM
+// fast or slow to hold the jitter buffer at its target against clock drift.
+#define AUDIO_DRIFT_MAX_PPM     500     // 0 disables the trim
+#define AUDIO_DRIFT_TIME_S      30      // Response time of the trim
+#define AUDIO_DRIFT_FILTER_MS   2000    // Fill level averaging, rides out network jitter
+
+// Output mixer: per-source trims (dB, 0 or below) under a master volume of
+// AUDIO_VOLUME_STEPS steps, each AUDIO_VOLUME_STEP_DB apart (step 0 mutes).
+// The stream is ducked while an earcon or requested tone plays.
+#define AUDIO_GAIN_STREAM_DB    0
+#define AUDIO_GAIN_EARCON_DB    0
+#define AUDIO_GAIN_TONE_DB      -6
+#define AUDIO_DUCK_DB           -14     // Stream level under a prompt
+#define AUDIO_DUCK_ATTACK_MS    30
+#define AUDIO_DUCK_RELEASE_MS   300
+#define AUDIO_VOLUME_STEPS      16
+#define AUDIO_VOLUME_STEP_DB    3
+#define AUDIO_VOLUME_DEFAULT    12      // -12 dB
+#define AUDIO_VOLUME_TICK_HZ    1200    // Confirms a volume change, 0 = silent
+#define AUDIO_VOLUME_TICK_MS    40
+
+// Audio uplink (device -> server): one AVI stream per session, paced and
+// with stale packets dropped. Set AUDIO_UPLINK_STREAM to 0 to publish the
+// same packets on TOPIC_AUDIO_UPLINK instead, for comparison.
+#define AUDIO_UPLINK_STREAM     1
+#define AUDIO_UPLINK_TARGET     "server"
+#define AUDIO_UPLINK_MAX_KBPS   512     // Pacing rate
+#define AUDIO_UPLINK_BURST_BYTES 4096   // Sent back to back before pacing kicks in
+#define AUDIO_UPLINK_MAX_AGE_MS 200     // Packets queued longer are dropped instead of sent
+
+// Microphone capture: one uplink packet of MIC_FRAME_MS of PCM per frame.
+// A frame plus its header must fit StreamSender::MAX_PACKET.
+#define MIC_SAMPLE_RATE         16000
+#define MIC_CHANNELS            1
+#define MIC_FRAME_MS            20
+#define MIC_DMA_BUF_COUNT       4
+#define MIC_DMA_BUF_LEN         160     // Frames per DMA buffer
+
+// Voice activity gate: with MIC_VAD 1 the uplink stream only runs during
+// speech, opened at onset with MIC_VAD_PREROLL_MS of audio from before it
+// and closed after MIC_VAD_HANGOVER_MS without speech. Onsets and ends are
+// published on TOPIC_AUDIO_VAD.
+#define MIC_VAD                 1
+#define MIC_VAD_THRESHOLD_DB    9       // Level over the tracked noise floor
+#define MIC_VAD_MIN_LEVEL_DBFS  -55     // Quieter frames are never speech
+#define MIC_VAD_MAX_ZCR         350     // Zero crossings per 1000 samples for voiced speech
+#define MIC_VAD_ONSET_MS        60      // Speech needed to open the stream
+#define MIC_VAD_HANGOVER_MS     400     // Silence needed to close it
+#define MIC_VAD_PREROLL_MS      200     // Audio sent ahead of the onset
+
+// AVI polling: drain inbound datagrams until the socket is empty or the
+// per-iteration budget is spent. Set AVI_POLL_MAX_PACKETS to 1 for the
+// legacy single-poll behaviour.
+#define AVI_POLL_MAX_PACKETS    32
+#define AVI_POLL_BUDGET_US      10000
+#define STATS_LOG_INTERVAL_MS   10000
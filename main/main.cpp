@@ -6,18 +6,24 @@
  * automatically detects and enables features based on the board configuration.
  */
 
+#include <atomic>
 #include <memory>
+#include <cstdint>
 #include <cstring>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "esp_random.h"
 #include "esp_netif.h"
 #include "esp_event.h"
+#include "esp_timer.h"
+#include "esp_vfs_eventfd.h"
 #include "nvs_flash.h"
 
 #include "device_config.h"
+#include "avi_client.h"
 #include "avi_transport.h"
 #include "device_features.h"
 #include "avi_embedded.h"
@@ -25,122 +31,130 @@
 static const char* TAG = "MAIN";
 
 // ============================================================================
-// AVI Client Wrapper
+// Boot Timeline
 // ============================================================================
 
 /**
- * @brief High-level AVI client that integrates transport and protocol
+ * @brief Boot phase timestamps (esp_timer time, µs since power-on)
  */
-class AviClient {
-public:
-    AviClient(AVI::UdpTransport& transport)
-        : m_transport(transport)
-        , m_avi(nullptr) {
-    }
-    
-    ~AviClient() {
-        if (m_avi) {
-            avi_embedded_free(m_avi);
-        }
-    }
-    
-    bool init() {
-        AVI_AviEmbeddedConfig config = {
-            .device_id = DEVICE_ID
-        };
-        
-        ESP_LOGI(TAG, "Initializing AVI (device: 0x%llx)", DEVICE_ID);
-        
-        m_avi = avi_embedded_new(
-            config,
-            m_scratch_buffer,
-            sizeof(m_scratch_buffer),
-            &m_transport,
-            &AviClient::sendCallback,
-            &AviClient::receiveCallback,
-            nullptr,
-            nullptr  // Message callback handled by features
-        );
-        
-        if (!m_avi) {
-            ESP_LOGE(TAG, "Failed to create AVI instance");
-            return false;
-        }
-        
-        ESP_LOGI(TAG, "AVI initialized (heap: %lu)", esp_get_free_heap_size());
-        return true;
-    }
-    
-    bool connect() {
-        int ret = avi_embedded_connect(m_avi);
-        if (ret == 0) {
-            ESP_LOGI(TAG, "AVI connect queued");
-            return true;
-        }
-        ESP_LOGW(TAG, "AVI connect failed: %d", ret);
-        return false;
-    }
-    
-    void poll() {
-        if (m_avi) {
-            avi_embedded_poll(m_avi);
-        }
-    }
-    
-    bool isConnected() const {
-        return m_avi && avi_embedded_is_connected(m_avi);
-    }
-    
-    AVI_AviEmbedded* getHandle() { return m_avi; }
-    
-private:
-    static int32_t sendCallback(void* user_data, const uint8_t* buf, size_t len) {
-        auto* transport = static_cast<AVI::UdpTransport*>(user_data);
-        return transport->send(buf, len);
-    }
-    
-    static int32_t receiveCallback(void* user_data, uint8_t* buf, size_t len) {
-        auto* transport = static_cast<AVI::UdpTransport*>(user_data);
-        return transport->receive(buf, len);
-    }
-    
-    AVI::UdpTransport& m_transport;
-    AVI_AviEmbedded* m_avi;
-    uint8_t m_scratch_buffer[SCRATCH_BUFFER_SIZE];
+struct BootTimeline {
+    int64_t app_main;         // app_main() entered
+    int64_t system_ready;     // NVS, netif and event loop up
+    int64_t features_ready;   // Hardware side of all features running
+    int64_t wifi_started;     // Association in progress
+    int64_t ip_acquired;      // First IP address
+    int64_t session_up;       // First AVI session established
+    int64_t subscribed;       // Features subscribed, device fully online
 };
 
+static BootTimeline s_boot = {};
+
+static void logBootTimeline() {
+    ESP_LOGI(TAG, "Boot timeline (ms since power-on):");
+    ESP_LOGI(TAG, "  app_main        %6lld", (long long)(s_boot.app_main / 1000));
+    ESP_LOGI(TAG, "  system ready    %6lld", (long long)(s_boot.system_ready / 1000));
+    ESP_LOGI(TAG, "  features ready  %6lld", (long long)(s_boot.features_ready / 1000));
+    ESP_LOGI(TAG, "  WiFi started    %6lld", (long long)(s_boot.wifi_started / 1000));
+    ESP_LOGI(TAG, "  IP acquired     %6lld", (long long)(s_boot.ip_acquired / 1000));
+    ESP_LOGI(TAG, "  AVI session up  %6lld", (long long)(s_boot.session_up / 1000));
+    ESP_LOGI(TAG, "  subscribed      %6lld", (long long)(s_boot.subscribed / 1000));
+}
+
 // ============================================================================
 // Application
 // ============================================================================
 
+/**
+ * @brief Network link state, driven from the application task
+ */
+enum class LinkState {
+    WIFI_DOWN,      // Waiting for an IP address
+    CONNECTING,     // Issue an AVI connect on the existing session
+    WAIT_SESSION,   // Connect queued, waiting for the server to accept
+    CONNECTED,      // Session up, features subscribed
+    BACKOFF         // Attempt failed, waiting before the next one
+};
+
+static const char* linkStateName(LinkState state) {
+    switch (state) {
+        case LinkState::WIFI_DOWN:    return "WIFI_DOWN";
+        case LinkState::CONNECTING:   return "CONNECTING";
+        case LinkState::WAIT_SESSION: return "WAIT_SESSION";
+        case LinkState::CONNECTED:    return "CONNECTED";
+        case LinkState::BACKOFF:      return "BACKOFF";
+    }
+    return "UNKNOWN";
+}
+
 class Application {
 public:
+    /**
+     * @brief Reconnect statistics
+     */
+    struct LinkStats {
+        uint32_t reconnects;        // Outages recovered from
+        uint32_t attempts;          // AVI connect attempts in total
+        int64_t last_recovery_ms;   // Outage-to-connected time of the last recovery
+        int64_t max_recovery_ms;
+    };
+    
     Application()
         : m_wifi(WIFI_SSID, WIFI_PASSWORD)
         , m_transport(AVI_SERVER_IP, AVI_SERVER_PORT)
         , m_client(m_transport)
         , m_features(nullptr)
-        , m_wifi_connected(false) {
+        , m_wifi_connected(false)
+        , m_link_state(LinkState::WIFI_DOWN)
+        , m_state_deadline(0)
+        , m_backoff_ms(AVI_BACKOFF_MIN_MS)
+        , m_outage_start(0)
+        , m_ever_connected(false)
+        , m_link_stats{}
+        , m_rx_wakeups(0)
+        , m_idle_wakeups(0)
+        , m_task_samples{}
+        , m_task_sample_count(0)
+        , m_task_total_runtime(0) {
     }
     
     bool init() {
         ESP_LOGI(TAG, "Initializing application");
         
+        // The AVI handle needs no network; create it up front so features
+        // can be built before association
+        m_client.onMessage(&Application::messageCallback, this);
+        if (!m_client.init()) {
+            ESP_LOGE(TAG, "AVI client initialization failed");
+            return false;
+        }
+        
+        // Bring up the hardware side of every feature now, so LEDs, buttons
+        // and I2S work while WiFi associates. Subscriptions and publishing
+        // wait for the session (Feature::onConnected).
+        setupFeatures();
+        s_boot.features_ready = esp_timer_get_time();
+        
         // Initialize WiFi
+        AVI::WiFiManager::FastConnectConfig fast_config = {
+            .use_cached_ap = WIFI_FAST_CONNECT != 0,
+            .use_cached_ip = WIFI_CACHED_STATIC_IP != 0,
+            .max_fast_attempts = WIFI_FAST_CONNECT_ATTEMPTS
+        };
+        m_wifi.setFastConnect(fast_config);
+        m_transport.setTaskAffinity(Features::getTaskConfig(Features::TaskDomain::NETWORK).core);
+        
         if (!m_wifi.init()) {
             ESP_LOGE(TAG, "WiFi initialization failed");
             return false;
         }
         
-        // Set up WiFi connection callback
+        // Runs in the event loop task: only record the change and let the
+        // application task act on it
         m_wifi.onConnectionChange([this](bool connected) {
             m_wifi_connected = connected;
-            if (connected) {
-                onWiFiConnected();
-            } else {
-                onWiFiDisconnected();
-            }
+            m_transport.wakeup();
         });
+        s_boot.wifi_started = esp_timer_get_time();
         
         return true;
     }
@@ -149,6 +163,7 @@ public:
         ESP_LOGI(TAG, "Application running");
         
         uint32_t loop_count = 0;
+        int64_t last_stats_time = esp_timer_get_time();
         
         while (true) {
             loop_count++;
@@ -156,48 +171,320 @@ public:
             // Poll AVI protocol
             m_client.poll();
             
-            // Update all features
+            int64_t now = esp_timer_get_time();
+            serviceLink(now);
+            
+            // Send what the other domains queued, then run the network
+            // domain's features whose release time has passed
+            int64_t next_release = INT64_MAX;
             if (m_features) {
-                m_features->updateAll();
+                m_features->serviceNetwork();
+                next_release = m_features->updateDue(Features::TaskDomain::NETWORK, now);
             }
             
-            vTaskDelay(pdMS_TO_TICKS(MAIN_LOOP_INTERVAL_MS));
+            if (now - last_stats_time >= STATS_LOG_INTERVAL_MS * 1000LL) {
+                last_stats_time = now;
+                logPollStats();
+                logTaskStats();
+            }
+            
+            // Sleep until a packet arrives, another task wakes us, the next
+            // feature release, the link deadline or the next stats dump
+            now = esp_timer_get_time();
+            int64_t wake_time = last_stats_time + STATS_LOG_INTERVAL_MS * 1000LL;
+            if (next_release < wake_time) {
+                wake_time = next_release;
+            }
+            if (m_state_deadline > 0 && m_state_deadline < wake_time) {
+                wake_time = m_state_deadline;
+            }
+            int64_t wait_us = wake_time - now;
+            uint32_t wait_ms = wait_us > 0 ? (uint32_t)((wait_us + 999) / 1000) : 0;
+            if (m_transport.waitForActivity(wait_ms)) {
+                m_rx_wakeups++;
+            } else {
+                m_idle_wakeups++;
+            }
         }
     }
     
 private:
-    void onWiFiConnected() {
-        ESP_LOGI(TAG, "WiFi connected, setting up AVI");
+    static void messageCallback(void* user_data, const char* topic, uintptr_t topic_len,
+                                const uint8_t* data, uintptr_t data_len) {
+        auto* app = static_cast<Application*>(user_data);
+        if (app->m_features) {
+            app->m_features->handleMessage(topic, topic_len, data, data_len);
+        }
+    }
+    
+    /**
+     * @brief Log per-task CPU share since the last call and stack headroom
+     * 
+     * CPU share needs CONFIG_FREERTOS_USE_TRACE_FACILITY and
+     * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS; without them only the stack
+     * high-water marks of the application tasks are reported.
+     */
+    void logTaskStats() {
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+        static TaskStatus_t tasks[MAX_TASK_REPORT];
+        uint32_t total_runtime = 0;
+        UBaseType_t count = uxTaskGetSystemState(tasks, MAX_TASK_REPORT, &total_runtime);
+        if (count == 0) {
+            ESP_LOGW(TAG, "Tasks: more than %u, not reported", (unsigned)MAX_TASK_REPORT);
+            return;
+        }
         
-        // Connect UDP transport
-        if (!m_transport.connect()) {
-            ESP_LOGE(TAG, "UDP transport connection failed");
+        uint32_t elapsed = total_runtime - m_task_total_runtime;
+        m_task_total_runtime = total_runtime;
+        
+        TaskSample samples[MAX_TASK_REPORT];
+        for (UBaseType_t i = 0; i < count; i++) {
+            const TaskStatus_t& task = tasks[i];
+            
+            uint32_t previous = 0;
+            for (size_t j = 0; j < m_task_sample_count; j++) {
+                if (m_task_samples[j].number == task.xTaskNumber) {
+                    previous = m_task_samples[j].runtime;
+                    break;
+                }
+            }
+            samples[i] = {task.xTaskNumber, task.ulRunTimeCounter};
+            
+            // Run time counts per core, so a task pinned to one core tops
+            // out at 100 / portNUM_PROCESSORS percent of the total
+            uint32_t busy = task.ulRunTimeCounter - previous;
+            unsigned long permille = elapsed ? (unsigned long)((uint64_t)busy * 1000 / elapsed) : 0;
+            ESP_LOGI(TAG, "Task %-12s core %2d prio %2u cpu %3lu.%lu%% stack free %lu",
+                     task.pcTaskName,
+                     task.xCoreID == tskNO_AFFINITY ? -1 : (int)task.xCoreID,
+                     (unsigned)task.uxCurrentPriority,
+                     permille / 10, permille % 10,
+                     (unsigned long)task.usStackHighWaterMark);
+        }
+        
+        memcpy(m_task_samples, samples, sizeof(TaskSample) * count);
+        m_task_sample_count = count;
+#else
+        ESP_LOGI(TAG, "Task %-12s stack free %lu",
+                 pcTaskGetName(nullptr),
+                 (unsigned long)uxTaskGetStackHighWaterMark(nullptr));
+        if (m_features) {
+            for (size_t i = 0; i < static_cast<size_t>(Features::TaskDomain::COUNT); i++) {
+                TaskHandle_t task = m_features->getTask(static_cast<Features::TaskDomain>(i));
+                if (task) {
+                    ESP_LOGI(TAG, "Task %-12s stack free %lu",
+                             pcTaskGetName(task),
+                             (unsigned long)uxTaskGetStackHighWaterMark(task));
+                }
+            }
+        }
+#endif
+    }
+    
+    void logPollStats() {
+        const auto& stats = m_client.getPollStats();
+        ESP_LOGI(TAG, "Poll stats: %lu loops, %lu packets, drained last %lu max %lu, "
+                 "backlog last %lu max %lu, budget hit %lu",
+                 (unsigned long)stats.iterations,
+                 (unsigned long)stats.packets,
+                 (unsigned long)stats.last_drained,
+                 (unsigned long)stats.drained_max,
+                 (unsigned long)stats.last_backlog,
+                 (unsigned long)stats.backlog_max,
+                 (unsigned long)stats.budget_exhausted);
+        ESP_LOGI(TAG, "Wakeups: %lu rx, %lu idle",
+                 (unsigned long)m_rx_wakeups,
+                 (unsigned long)m_idle_wakeups);
+        
+        if (m_features) {
+            m_features->logStats();
+            
+            const auto& router = m_features->getRouter().getStats();
+            uint32_t lookups = router.dispatched + router.unhandled + router.unknown;
+            ESP_LOGI(TAG, "Router: %lu dispatched, %lu unhandled, %lu unknown, %lu cycles/lookup",
+                     (unsigned long)router.dispatched,
+                     (unsigned long)router.unhandled,
+                     (unsigned long)router.unknown,
+                     (unsigned long)(lookups ? router.lookup_cycles / lookups : 0));
+        }
+        const auto& wifi = m_wifi.getMetrics();
+        ESP_LOGI(TAG, "WiFi: time to IP boot %lld ms, reconnect last %lld ms max %lld ms, "
+                 "%lu fast, %lu full scan, %lu fallbacks, %lu disconnects",
+                 (long long)wifi.boot_to_ip_ms,
+                 (long long)wifi.last_reconnect_ms,
+                 (long long)wifi.max_reconnect_ms,
+                 (unsigned long)wifi.fast_connects,
+                 (unsigned long)wifi.full_scans,
+                 (unsigned long)wifi.fallbacks,
+                 (unsigned long)wifi.disconnects);
+        ESP_LOGI(TAG, "Link: %s, %lu reconnects, %lu attempts, recovery last %lld ms max %lld ms",
+                 linkStateName(m_link_state),
+                 (unsigned long)m_link_stats.reconnects,
+                 (unsigned long)m_link_stats.attempts,
+                 (long long)m_link_stats.last_recovery_ms,
+                 (long long)m_link_stats.max_recovery_ms);
+        
+        auto rx = m_transport.getRxStats();
+        ESP_LOGI(TAG, "RX pool: %lu received, %lu dropped (%lu oversize, %lu too large), "
+                 "%lu exhausted, ring high-water %lu/%u",
+                 (unsigned long)rx.received,
+                 (unsigned long)rx.dropped,
+                 (unsigned long)rx.oversize,
+                 (unsigned long)rx.too_large,
+                 (unsigned long)rx.pool_exhausted,
+                 (unsigned long)rx.ring_high_water,
+                 (unsigned)AVI::UdpTransport::RX_POOL_SLOTS);
+        
+        static const char* const class_names[] = {"control", "bulk"};
+        for (size_t i = 0; i < static_cast<size_t>(AVI::TrafficClass::COUNT); i++) {
+            auto tx = m_transport.getTxStats(static_cast<AVI::TrafficClass>(i));
+            ESP_LOGI(TAG, "TX %s: %lu sent, %lu dropped, %lu errors, depth %lu (max %lu), "
+                     "latency avg %lu us max %lu us",
+                     class_names[i],
+                     (unsigned long)tx.sent,
+                     (unsigned long)tx.dropped,
+                     (unsigned long)tx.send_errors,
+                     (unsigned long)tx.depth,
+                     (unsigned long)tx.depth_high_water,
+                     (unsigned long)(tx.sent ? tx.latency_total_us / tx.sent : 0),
+                     (unsigned long)tx.latency_max_us);
+            if (tx.contended > 0) {
+                ESP_LOGI(TAG, "TX %s while %s queued: %lu sent, latency avg %lu us max %lu us",
+                         class_names[i], class_names[1 - i],
+                         (unsigned long)tx.contended,
+                         (unsigned long)(tx.contended_latency_total_us / tx.contended),
+                         (unsigned long)tx.contended_latency_max_us);
+            }
+        }
+    }
+    
+    void setLinkState(LinkState state, int64_t deadline = 0) {
+        if (state != m_link_state) {
+            ESP_LOGI(TAG, "Link %s -> %s", linkStateName(m_link_state), linkStateName(state));
+            m_link_state = state;
+        }
+        m_state_deadline = deadline;
+    }
+    
+    /**
+     * @brief Advance the connection state machine
+     * 
+     * The AVI handle and the features survive Wi-Fi and session drops;
+     * recovery only re-issues the AVI connect and re-subscribes.
+     */
+    void serviceLink(int64_t now) {
+        bool wifi_up = m_wifi_connected;
+        
+        if (!wifi_up && m_link_state != LinkState::WIFI_DOWN) {
+            ESP_LOGW(TAG, "WiFi disconnected");
+            onLinkLost(now);
+            setLinkState(LinkState::WIFI_DOWN);
             return;
         }
         
-        // Initialize AVI client
-        if (!m_client.init()) {
-            ESP_LOGE(TAG, "AVI client initialization failed");
+        switch (m_link_state) {
+            case LinkState::WIFI_DOWN:
+                if (wifi_up) {
+                    ESP_LOGI(TAG, "WiFi connected, setting up AVI");
+                    if (s_boot.ip_acquired == 0) {
+                        s_boot.ip_acquired = now;
+                    }
+                    setLinkState(LinkState::CONNECTING);
+                    attemptConnect(now);
+                }
+                break;
+            
+            case LinkState::CONNECTING:
+                attemptConnect(now);
+                break;
+            
+            case LinkState::WAIT_SESSION:
+                if (m_client.isConnected()) {
+                    onSessionUp(now);
+                } else if (now >= m_state_deadline) {
+                    ESP_LOGW(TAG, "AVI session not established within %d ms", AVI_SESSION_TIMEOUT_MS);
+                    scheduleRetry(now);
+                }
+                break;
+            
+            case LinkState::CONNECTED:
+                if (!m_client.isConnected()) {
+                    ESP_LOGW(TAG, "AVI session lost");
+                    onLinkLost(now);
+                    setLinkState(LinkState::CONNECTING);
+                    attemptConnect(now);
+                }
+                break;
+            
+            case LinkState::BACKOFF:
+                if (now >= m_state_deadline) {
+                    setLinkState(LinkState::CONNECTING);
+                    attemptConnect(now);
+                }
+                break;
+        }
+    }
+    
+    void attemptConnect(int64_t now) {
+        m_link_stats.attempts++;
+        
+        if (!m_transport.connect()) {
+            ESP_LOGE(TAG, "UDP transport connection failed");
+            scheduleRetry(now);
             return;
         }
         
-        // Connect to AVI server
         if (!m_client.connect()) {
             ESP_LOGW(TAG, "AVI server connection failed");
+            scheduleRetry(now);
             return;
         }
         
-        vTaskDelay(pdMS_TO_TICKS(AVI_CONNECT_DELAY_MS));
+        setLinkState(LinkState::WAIT_SESSION, now + AVI_SESSION_TIMEOUT_MS * 1000LL);
+    }
+    
+    void scheduleRetry(int64_t now) {
+        // Exponential backoff with up to 25% jitter
+        uint32_t delay_ms = m_backoff_ms + esp_random() % (m_backoff_ms / 4 + 1);
+        ESP_LOGI(TAG, "Retrying AVI connect in %lu ms", (unsigned long)delay_ms);
         
-        // Initialize features
-        setupFeatures();
+        m_backoff_ms = m_backoff_ms * 2 > AVI_BACKOFF_MAX_MS ? AVI_BACKOFF_MAX_MS : m_backoff_ms * 2;
+        setLinkState(LinkState::BACKOFF, now + delay_ms * 1000LL);
     }
     
-    void onWiFiDisconnected() {
-        ESP_LOGW(TAG, "WiFi disconnected");
+    void onSessionUp(int64_t now) {
+        setLinkState(LinkState::CONNECTED);
+        m_backoff_ms = AVI_BACKOFF_MIN_MS;
         
         if (m_features) {
-            m_features->stopAll();
+            m_features->onConnected();
+        }
+        
+        if (s_boot.session_up == 0) {
+            s_boot.session_up = now;
+            s_boot.subscribed = esp_timer_get_time();
+            logBootTimeline();
+        }
+        
+        if (m_ever_connected && m_outage_start > 0) {
+            int64_t recovery_ms = (now - m_outage_start) / 1000;
+            m_link_stats.reconnects++;
+            m_link_stats.last_recovery_ms = recovery_ms;
+            if (recovery_ms > m_link_stats.max_recovery_ms) {
+                m_link_stats.max_recovery_ms = recovery_ms;
+            }
+            ESP_LOGI(TAG, "AVI link recovered in %lld ms", (long long)recovery_ms);
+        }
+        m_ever_connected = true;
+        m_outage_start = 0;
+    }
+    
+    void onLinkLost(int64_t now) {
+        if (m_outage_start == 0) {
+            m_outage_start = now;
+        }
+        if (m_features) {
+            m_features->onDisconnected();
         }
     }
     
@@ -205,13 +492,32 @@ private:
         ESP_LOGI(TAG, "Setting up device features");
         
         m_features = std::make_unique<Features::FeatureManager>(m_client.getHandle());
+        m_features->setNetworkWakeup([this]() { m_transport.wakeup(); });
         
         // Add features based on board configuration
-        
+
 #ifdef FEATURE_BUTTON_INPUT
-        m_features->addFeature(
-            std::make_unique<Features::ButtonFeature>(m_client.getHandle())
-        );
+        auto buttons = std::make_unique<Features::ButtonFeature>(m_client.getHandle());
+#endif
+
+#ifdef FEATURE_AUDIO_OUTPUT
+        auto audio = std::make_unique<Features::AudioFeature>(m_client.getHandle());
+#endif
+
+#if defined(FEATURE_BUTTON_INPUT) && defined(FEATURE_AUDIO_OUTPUT) && defined(BUTTON_VOLUME_UP)
+        // Volume keys act on the device, no round trip to the server
+        Features::AudioFeature* audio_feature = audio.get();
+        buttons->setLocalHandler([audio_feature](uint8_t button_id) {
+            if (button_id == BUTTON_VOLUME_UP) {
+                audio_feature->stepVolume(1);
+            } else if (button_id == BUTTON_VOLUME_DOWN) {
+                audio_feature->stepVolume(-1);
+            }
+        });
+#endif
+
+#ifdef FEATURE_BUTTON_INPUT
+        m_features->addFeature(std::move(buttons));
 #endif
 
 #ifdef FEATURE_LED_STRIP
@@ -221,8 +527,12 @@ private:
 #endif
 
 #ifdef FEATURE_AUDIO_OUTPUT
+        m_features->addFeature(std::move(audio));
+#endif
+
+#ifdef FEATURE_MICROPHONE
         m_features->addFeature(
-            std::make_unique<Features::AudioFeature>(m_client.getHandle())
+            std::make_unique<Features::MicrophoneFeature>(m_client.getHandle(), m_transport)
         );
 #endif
         
@@ -238,6 +548,12 @@ private:
             return;
         }
         
+        // Move input, rendering and audio onto their own pinned tasks
+        if (!m_features->startTasks()) {
+            ESP_LOGE(TAG, "Feature task start failed");
+            return;
+        }
+        
         ESP_LOGI(TAG, "All features initialized and started");
     }
     
@@ -245,7 +561,27 @@ private:
     AVI::UdpTransport m_transport;
     AviClient m_client;
     std::unique_ptr<Features::FeatureManager> m_features;
-    bool m_wifi_connected;
+    std::atomic<bool> m_wifi_connected;
+    
+    LinkState m_link_state;
+    int64_t m_state_deadline;     // Timeout/retry time of the current state, 0 = none
+    uint32_t m_backoff_ms;
+    int64_t m_outage_start;       // When the current outage began, 0 = none
+    bool m_ever_connected;
+    LinkStats m_link_stats;
+    
+    uint32_t m_rx_wakeups;
+    uint32_t m_idle_wakeups;
+    
+    struct TaskSample {
+        UBaseType_t number;
+        uint32_t runtime;
+    };
+    
+    static constexpr UBaseType_t MAX_TASK_REPORT = 24;
+    TaskSample m_task_samples[MAX_TASK_REPORT];   // Run time per task at the last report
+    size_t m_task_sample_count;
+    uint32_t m_task_total_runtime;
 };
 
 // ============================================================================
@@ -266,6 +602,8 @@ static void app_task(void* pvParameters) {
 // ============================================================================
 
 extern "C" void app_main() {
+    s_boot.app_main = esp_timer_get_time();
+    
     ESP_LOGI(TAG, "");
     ESP_LOGI(TAG, "╔═══════════════════════════════════════╗");
     ESP_LOGI(TAG, "║         AVI Embedded Firmware         ║");
@@ -305,9 +643,14 @@ extern "C" void app_main() {
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
     
+    // eventfd backs the network loop's wakeup channel
+    esp_vfs_eventfd_config_t eventfd_config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_vfs_eventfd_register(&eventfd_config));
+    
     // Initialize AVI system
     ESP_LOGI(TAG, "Initializing AVI embedded system");
     avi_embedded_init();
+    s_boot.system_ready = esp_timer_get_time();
     
     // Create application
     static Application app;
@@ -317,12 +660,15 @@ extern "C" void app_main() {
         return;
     }
     
-    // Create application task
-    xTaskCreate(app_task, "app_main", 
-                MAIN_TASK_STACK_SIZE, 
-                &app, 
-                MAIN_TASK_PRIORITY, 
-                nullptr);
+    // Create the network task; it owns the AVI handle and runs the
+    // application loop
+    const Features::TaskConfig& network = Features::getTaskConfig(Features::TaskDomain::NETWORK);
+    xTaskCreatePinnedToCore(app_task, network.name, 
+                            network.stack_size, 
+                            &app, 
+                            network.priority, 
+                            nullptr,
+                            network.core);
     
     ESP_LOGI(TAG, "System started");
     ESP_LOGI(TAG, "");
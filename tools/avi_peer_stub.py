@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+Local stand-in for the AVI server, for exercising the transport path on a
+Linux host (tools/transport_bench.cpp) or against a device on the LAN. It
+only moves datagrams; the peer measures its own round trips.
+
+  echo   Reflect every datagram back to its sender.
+  burst  Wait for the first datagram from a peer, then blast N datagrams
+         of a given size back at it (drain/throughput behaviour).
+
+Prints a packet/byte/rate summary every few seconds.
+"""
+
+import argparse
+import socket
+import time
+
+
+def report(label, packets, octets, started):
+    elapsed = max(time.monotonic() - started, 1e-6)
+    print(f"[{label}] {packets} pkts, {octets} bytes, "
+          f"{packets / elapsed:.1f} pkt/s, {octets * 8 / elapsed / 1000:.1f} kbit/s")
+
+
+def run_echo(sock, interval):
+    packets = octets = 0
+    started = last = time.monotonic()
+    while True:
+        try:
+            data, peer = sock.recvfrom(65535)
+        except socket.timeout:
+            data = None
+        if data is not None:
+            sock.sendto(data, peer)
+            packets += 1
+            octets += len(data)
+        if time.monotonic() - last >= interval:
+            last = time.monotonic()
+            report("echo", packets, octets, started)
+
+
+def run_burst(sock, count, size, gap_us):
+    print("Waiting for a peer datagram...")
+    while True:
+        try:
+            _, peer = sock.recvfrom(65535)
+            break
+        except socket.timeout:
+            continue
+    print(f"Bursting {count} x {size} bytes to {peer[0]}:{peer[1]}")
+    payload = bytearray(size)
+    started = time.monotonic()
+    for seq in range(count):
+        payload[0:4] = seq.to_bytes(4, "little")
+        sock.sendto(payload, peer)
+        if gap_us:
+            time.sleep(gap_us / 1e6)
+    report("burst", count, count * size, started)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("mode", choices=["echo", "burst"])
+    parser.add_argument("--bind", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8888)
+    parser.add_argument("--count", type=int, default=500, help="burst: datagrams to send")
+    parser.add_argument("--size", type=int, default=512, help="burst: datagram size")
+    parser.add_argument("--gap-us", type=int, default=0, help="burst: delay between datagrams")
+    parser.add_argument("--interval", type=float, default=5.0, help="echo: report period (s)")
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((args.bind, args.port))
+    sock.settimeout(0.5)
+    print(f"AVI peer stub listening on {args.bind}:{args.port} ({args.mode})")
+
+    try:
+        if args.mode == "echo":
+            run_echo(sock, args.interval)
+        else:
+            run_burst(sock, args.count, args.size, args.gap_us)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,206 @@
+/**
+ * @file codec_bench.cpp
+ * @brief Host-side benchmark for the IMA-ADPCM decoder
+ * 
+ * Encodes a few seconds of synthetic audio in 20 ms packets, checks the
+ * table-driven decoder against the textbook per-sample implementation, and
+ * reports decode cost per frame, round-trip SNR and wire bitrate against
+ * raw PCM. Host cycle counts only rank kernels against each other; the
+ * device logs its own cycles/frame with the audio stats.
+ * 
+ * Build and run from the repository root:
+ * 
+ *   g++ -std=gnu++17 -O2 -Icomponents/audio/include \
+ *       tools/codec_bench.cpp components/audio/ima_adpcm.cpp -o codec_bench
+ *   ./codec_bench
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "audio_packet.h"
+#include "ima_adpcm.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+using namespace Audio;
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 44100;
+constexpr uint32_t PACKET_FRAMES = SAMPLE_RATE / 50;   // 20 ms, even for mono
+constexpr uint32_t SECONDS = 10;
+constexpr int ROUNDS = 20;
+
+struct Packet {
+    std::vector<uint8_t> payload;
+};
+
+uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+const char* unit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
+
+// Textbook IMA-ADPCM decoder (one step at a time), the reference for the
+// table-driven kernel
+int16_t referenceExpand(uint8_t nibble, int32_t& predictor, int32_t& index) {
+    static const int16_t steps[89] = {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+        50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+        253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+        1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+        3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+        12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+    };
+    static const int8_t index_step[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+    
+    int32_t step = steps[index];
+    int32_t diff = step >> 3;
+    if (nibble & 4) diff += step;
+    if (nibble & 2) diff += step >> 1;
+    if (nibble & 1) diff += step >> 2;
+    predictor += (nibble & 8) ? -diff : diff;
+    if (predictor > 32767) predictor = 32767;
+    if (predictor < -32768) predictor = -32768;
+    index += index_step[nibble & 7];
+    if (index < 0) index = 0;
+    if (index > 88) index = 88;
+    return (int16_t)predictor;
+}
+
+size_t referenceDecode(const uint8_t* in, size_t length, uint8_t channels, int16_t* out) {
+    int32_t predictor[2];
+    int32_t index[2];
+    for (uint8_t c = 0; c < channels; c++) {
+        const uint8_t* header = in + ImaAdpcm::HEADER_BYTES_PER_CHANNEL * c;
+        predictor[c] = (int16_t)(header[0] | (header[1] << 8));
+        index[c] = header[2] > 88 ? 88 : header[2];
+    }
+    size_t offset = ImaAdpcm::HEADER_BYTES_PER_CHANNEL * channels;
+    for (size_t i = offset; i < length; i++) {
+        *out++ = referenceExpand(in[i] & 0x0F, predictor[0], index[0]);
+        *out++ = referenceExpand(in[i] >> 4, predictor[channels - 1], index[channels - 1]);
+    }
+    return ImaAdpcm::frames(length, channels);
+}
+
+// Speech-like test signal: a gliding tone with harmonics, amplitude
+// envelope and a little noise, slightly different per channel
+std::vector<int16_t> makeSignal(uint8_t channels) {
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 300.0);
+    size_t frames = (size_t)SAMPLE_RATE * SECONDS;
+    std::vector<int16_t> pcm(frames * channels);
+    double phase = 0.0;
+    for (size_t i = 0; i < frames; i++) {
+        double t = (double)i / SAMPLE_RATE;
+        double freq = 150.0 + 250.0 * (0.5 + 0.5 * std::sin(2 * M_PI * 0.3 * t));
+        phase += 2 * M_PI * freq / SAMPLE_RATE;
+        double envelope = 0.3 + 0.7 * std::fabs(std::sin(2 * M_PI * 2.0 * t));
+        double value = envelope * (9000 * std::sin(phase) + 3000 * std::sin(3 * phase) +
+                                   1500 * std::sin(7 * phase));
+        for (uint8_t c = 0; c < channels; c++) {
+            double sample = value * (c == 0 ? 1.0 : 0.8) + noise(rng);
+            pcm[i * channels + c] = (int16_t)std::max(-32768.0, std::min(32767.0, sample));
+        }
+    }
+    return pcm;
+}
+
+void run(uint8_t channels) {
+    std::vector<int16_t> pcm = makeSignal(channels);
+    size_t total_frames = pcm.size() / channels;
+    
+    ImaAdpcm::State state[2] = {};
+    std::vector<Packet> packets;
+    size_t wire_bytes = 0;
+    for (size_t frame = 0; frame + PACKET_FRAMES <= total_frames; frame += PACKET_FRAMES) {
+        Packet packet;
+        packet.payload.resize(ImaAdpcm::encodedSize(PACKET_FRAMES, channels));
+        ImaAdpcm::encode(&pcm[frame * channels], PACKET_FRAMES, channels, state, packet.payload.data());
+        wire_bytes += packet.payload.size() + PACKET_HEADER_SIZE;
+        packets.push_back(std::move(packet));
+    }
+    size_t coded_frames = packets.size() * PACKET_FRAMES;
+    
+    // Correctness: bit-exact against the reference, and round-trip quality
+    std::vector<int16_t> out(PACKET_FRAMES * channels);
+    std::vector<int16_t> ref(PACKET_FRAMES * channels);
+    bool exact = true;
+    double signal = 0.0;
+    double error = 0.0;
+    for (size_t p = 0; p < packets.size(); p++) {
+        const auto& payload = packets[p].payload;
+        size_t frames = ImaAdpcm::decode(payload.data(), payload.size(), channels, out.data());
+        referenceDecode(payload.data(), payload.size(), channels, ref.data());
+        exact = exact && frames == PACKET_FRAMES && out == ref;
+        for (size_t i = 0; i < out.size(); i++) {
+            double original = pcm[p * PACKET_FRAMES * channels + i];
+            signal += original * original;
+            error += (original - out[i]) * (original - out[i]);
+        }
+    }
+    
+    // Timing: best of several rounds over the whole stream
+    uint64_t best_table = UINT64_MAX;
+    uint64_t best_reference = UINT64_MAX;
+    volatile int16_t sink = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        uint64_t start = now();
+        for (const auto& packet : packets) {
+            ImaAdpcm::decode(packet.payload.data(), packet.payload.size(), channels, out.data());
+            sink = sink + out[PACKET_FRAMES - 1];
+        }
+        best_table = std::min(best_table, now() - start);
+        
+        start = now();
+        for (const auto& packet : packets) {
+            referenceDecode(packet.payload.data(), packet.payload.size(), channels, ref.data());
+            sink = sink + ref[PACKET_FRAMES - 1];
+        }
+        best_reference = std::min(best_reference, now() - start);
+    }
+    
+    double seconds = (double)coded_frames / SAMPLE_RATE;
+    double pcm_kbps = (double)coded_frames * channels * sizeof(int16_t) * 8 / seconds / 1000;
+    double adpcm_kbps = (double)wire_bytes * 8 / seconds / 1000;
+    
+    printf("%s, %u Hz, %zu packets of %u frames\n",
+           channels == 1 ? "mono" : "stereo", SAMPLE_RATE, packets.size(), PACKET_FRAMES);
+    printf("  bitrate        pcm16 %.0f kbit/s, ima-adpcm %.0f kbit/s with headers (%.2f:1)\n",
+           pcm_kbps, adpcm_kbps, pcm_kbps / adpcm_kbps);
+    printf("  round trip     SNR %.1f dB, decoder %s the reference\n",
+           10.0 * std::log10(signal / (error > 0 ? error : 1.0)),
+           exact ? "bit-exact with" : "DIFFERS from");
+    printf("  decode         table %.2f %s/frame, reference %.2f %s/frame (%.2fx)\n",
+           (double)best_table / coded_frames, unit(),
+           (double)best_reference / coded_frames, unit(),
+           (double)best_reference / best_table);
+}
+
+} // namespace
+
+int main() {
+    run(1);
+    printf("\n");
+    run(2);
+    return 0;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file earcon_check.cpp
+ * @brief Host-side check of an earcon image (tools/pack_earcons.py)
+ * 
+ * Attaches the image through Audio::EarconIndex exactly as the device does
+ * and then goes further than attach(): every clip must be found by its id,
+ * every IMA-ADPCM block must carry sane headers and decode to the frame
+ * count the index promises, and the image must fit the partition. Prints
+ * one line per clip and exits non-zero on the first problem.
+ * 
+ * Build and run from the repository root:
+ * 
+ *   g++ -std=gnu++17 -O2 -Icomponents/audio/include tools/earcon_check.cpp \
+ *       components/audio/ima_adpcm.cpp -o earcon_check
+ *   ./earcon_check earcons.bin
+ *   ./earcon_check earcons.bin --rate 44100   # also require the output rate
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "earcon_index.h"
+#include "ima_adpcm.h"
+
+using Audio::EarconClip;
+using Audio::EarconIndex;
+
+namespace {
+
+// Mirrors the earcons entry in partitions.csv
+constexpr size_t PARTITION_SIZE = 0x40000;
+
+/**
+ * @brief Walk every block of an ADPCM clip as AudioPlayer::mixClip() does
+ * 
+ * @return Frames decoded, or -1 with a message on a malformed block
+ */
+long decodeClip(const EarconClip& clip, int16_t& peak) {
+    std::vector<int16_t> pcm(Audio::EARCON_MAX_BLOCK_FRAMES * clip.channels);
+    const uint8_t* block = clip.data;
+    long total = 0;
+    for (uint32_t index = 0; (uint64_t)index * clip.block_frames < clip.frames; index++) {
+        size_t bytes = EarconIndex::blockBytes(clip, index);
+        for (uint8_t c = 0; c < clip.channels; c++) {
+            const uint8_t* header = block + Audio::ImaAdpcm::HEADER_BYTES_PER_CHANNEL * c;
+            if (header[2] > Audio::ImaAdpcm::MAX_STEP_INDEX || header[3] != 0) {
+                fprintf(stderr, "clip %u block %u channel %u: bad header\n", clip.id, index, c);
+                return -1;
+            }
+        }
+        size_t frames = Audio::ImaAdpcm::decode(block, bytes, clip.channels, pcm.data());
+        size_t expected = clip.frames - index * clip.block_frames < clip.block_frames
+            ? clip.frames - index * clip.block_frames
+            : clip.block_frames;
+        if (frames != expected) {
+            fprintf(stderr, "clip %u block %u: %zu frames, index says %zu\n", clip.id, index, frames, expected);
+            return -1;
+        }
+        for (size_t i = 0; i < frames * clip.channels; i++) {
+            int16_t magnitude = pcm[i] == -32768 ? 32767 : (int16_t)abs(pcm[i]);
+            peak = magnitude > peak ? magnitude : peak;
+        }
+        block += bytes;
+        total += (long)frames;
+    }
+    return total;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    uint32_t rate = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--rate") && i + 1 < argc) {
+            rate = (uint32_t)atoi(argv[++i]);
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            path = nullptr;
+            break;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "usage: %s earcons.bin [--rate HZ]\n", argv[0]);
+        return 1;
+    }
+    
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot read %s\n", path);
+        return 1;
+    }
+    // Padded to the partition size, as the mapping would be
+    std::vector<uint8_t> image(PARTITION_SIZE + 1, 0xFF);
+    size_t size = fread(image.data(), 1, image.size(), f);
+    fclose(f);
+    if (size > PARTITION_SIZE) {
+        fprintf(stderr, "%s does not fit the %zu byte partition\n", path, PARTITION_SIZE);
+        return 1;
+    }
+    
+    EarconIndex index;
+    if (!index.attach(image.data(), PARTITION_SIZE)) {
+        fprintf(stderr, "%s: index rejected\n", path);
+        return 1;
+    }
+    printf("%s: %zu clips, %zu bytes\n", path, index.count(), size);
+    
+    for (size_t i = 0; i < index.count(); i++) {
+        EarconClip clip = {};
+        EarconClip found = {};
+        if (!index.at(i, clip) || !index.find(clip.id, found) || found.data != clip.data) {
+            fprintf(stderr, "entry %zu: lookup by id %u failed\n", i, clip.id);
+            return 1;
+        }
+        if (rate && clip.sample_rate != rate) {
+            fprintf(stderr, "clip %u: %u Hz, the player runs at %u Hz\n", clip.id, clip.sample_rate, rate);
+            return 1;
+        }
+        if ((size_t)(clip.data - image.data()) + clip.length > size) {
+            fprintf(stderr, "clip %u: data runs past the end of the file\n", clip.id);
+            return 1;
+        }
+        
+        int16_t peak = 0;
+        if (clip.codec == Audio::Codec::IMA_ADPCM) {
+            long frames = decodeClip(clip, peak);
+            if (frames < 0) {
+                return 1;
+            }
+            if ((uint32_t)frames != clip.frames) {
+                fprintf(stderr, "clip %u: %ld frames decoded, index says %u\n", clip.id, frames, clip.frames);
+                return 1;
+            }
+        } else {
+            const int16_t* pcm = reinterpret_cast<const int16_t*>(clip.data);
+            for (size_t s = 0; s < (size_t)clip.frames * clip.channels; s++) {
+                int16_t magnitude = pcm[s] == -32768 ? 32767 : (int16_t)abs(pcm[s]);
+                peak = magnitude > peak ? magnitude : peak;
+            }
+        }
+        
+        printf("  %5u  %-9s %u ch %6u Hz %7.1f ms %7u bytes  peak %6u\n",
+               clip.id, Audio::codecName(clip.codec), clip.channels, clip.sample_rate,
+               clip.frames * 1000.0 / clip.sample_rate, clip.length, (unsigned)peak);
+    }
+    
+    // A missing id must not match a neighbour
+    EarconClip clip;
+    uint16_t probe = 0;
+    while (probe < 0xFFFF && index.find(probe, clip)) {
+        probe++;
+    }
+    if (index.find(probe, clip)) {
+        fprintf(stderr, "lookup of absent id %u succeeded\n", probe);
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
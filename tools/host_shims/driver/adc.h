@@ -0,0 +1,3 @@
+#pragma once
+
+// Only named by device_config.h macros, which host tools never expand
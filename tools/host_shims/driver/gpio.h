@@ -0,0 +1,8 @@
+#pragma once
+
+typedef enum {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_5 = 5,
+    GPIO_NUM_22 = 22,
+    GPIO_NUM_33 = 33,
+} gpio_num_t;
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// No event loop on the host: registering fails
+
+typedef const char* esp_event_base_t;
+typedef void* esp_event_handler_instance_t;
+typedef void (*esp_event_handler_t)(void* arg, esp_event_base_t base, int32_t id, void* data);
+
+#define ESP_EVENT_ANY_ID    -1
+static const esp_event_base_t WIFI_EVENT = "WIFI_EVENT";
+static const esp_event_base_t IP_EVENT = "IP_EVENT";
+
+static inline esp_err_t esp_event_handler_instance_register(esp_event_base_t, int32_t, esp_event_handler_t,
+                                                            void*, esp_event_handler_instance_t*) {
+    return ESP_FAIL;
+}
+
+static inline esp_err_t esp_event_handler_instance_unregister(esp_event_base_t, int32_t,
+                                                              esp_event_handler_instance_t) {
+    return ESP_FAIL;
+}
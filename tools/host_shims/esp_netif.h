@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// No network interfaces on the host: every call fails
+
+typedef struct esp_netif_obj esp_netif_t;
+typedef struct { uint32_t addr; } esp_ip4_addr_t;
+typedef struct { esp_ip4_addr_t ip, netmask, gw; } esp_netif_ip_info_t;
+typedef struct { esp_netif_t* esp_netif; esp_netif_ip_info_t ip_info; bool ip_changed; } ip_event_got_ip_t;
+
+enum { IP_EVENT_STA_GOT_IP };
+
+static inline esp_netif_t* esp_netif_create_default_wifi_sta(void) { return nullptr; }
+static inline esp_err_t esp_netif_dhcpc_stop(esp_netif_t*) { return ESP_FAIL; }
+static inline esp_err_t esp_netif_dhcpc_start(esp_netif_t*) { return ESP_FAIL; }
+static inline esp_err_t esp_netif_set_ip_info(esp_netif_t*, const esp_netif_ip_info_t*) { return ESP_FAIL; }
@@ -0,0 +1,4 @@
+#pragma once
+
+// The host's own eventfd, nothing to register
+#include <sys/eventfd.h>
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+
+// No Wi-Fi on the host: every call fails, so WiFiManager never comes up
+
+typedef struct { int unused; } wifi_init_config_t;
+#define WIFI_INIT_CONFIG_DEFAULT() wifi_init_config_t{}
+
+typedef enum { WIFI_AUTH_OPEN, WIFI_AUTH_WPA2_PSK } wifi_auth_mode_t;
+typedef enum { WIFI_FAST_SCAN, WIFI_ALL_CHANNEL_SCAN } wifi_scan_method_t;
+typedef enum { WIFI_CONNECT_AP_BY_SIGNAL } wifi_sort_method_t;
+typedef enum { WIFI_MODE_STA } wifi_mode_t;
+typedef enum { WIFI_IF_STA } wifi_interface_t;
+typedef enum { WIFI_STORAGE_RAM } wifi_storage_t;
+
+enum { WIFI_EVENT_STA_START, WIFI_EVENT_STA_DISCONNECTED };
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t password[64];
+    wifi_scan_method_t scan_method;
+    bool bssid_set;
+    uint8_t bssid[6];
+    uint8_t channel;
+    wifi_sort_method_t sort_method;
+    struct { wifi_auth_mode_t authmode; } threshold;
+} wifi_sta_config_t;
+
+typedef union { wifi_sta_config_t sta; } wifi_config_t;
+
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t primary;
+} wifi_ap_record_t;
+
+static inline esp_err_t esp_wifi_init(const wifi_init_config_t*) { return ESP_FAIL; }
+static inline esp_err_t esp_wifi_set_storage(wifi_storage_t) { return ESP_FAIL; }
+static inline esp_err_t esp_wifi_set_mode(wifi_mode_t) { return ESP_FAIL; }
+static inline esp_err_t esp_wifi_set_config(wifi_interface_t, wifi_config_t*) { return ESP_FAIL; }
+static inline esp_err_t esp_wifi_start(void) { return ESP_FAIL; }
+static inline esp_err_t esp_wifi_connect(void) { return ESP_FAIL; }
+static inline esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t*) { return ESP_FAIL; }
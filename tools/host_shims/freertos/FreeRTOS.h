@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef struct HostTask* TaskHandle_t;
+typedef struct HostQueue* QueueHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdFALSE             0
+#define pdTRUE              1
+#define pdPASS              1
+#define portMAX_DELAY       0xFFFFFFFFu
+#define tskNO_AFFINITY      0x7FFFFFFF
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))     // 1 kHz tick
@@ -0,0 +1,24 @@
+#pragma once
+
+// BSD sockets from the host; sends go through lwip_sendto() (as they do in
+// lwIP), which the host program provides, e.g. to model a slower link
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+ssize_t lwip_sendto(int s, const void* data, size_t size, int flags,
+                    const struct sockaddr* to, socklen_t tolen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define sendto(s, data, size, flags, to, tolen) lwip_sendto(s, data, size, flags, to, tolen)
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// No flash on the host: opening fails
+
+typedef uint32_t nvs_handle_t;
+typedef enum { NVS_READONLY, NVS_READWRITE } nvs_open_mode_t;
+
+static inline esp_err_t nvs_open(const char*, nvs_open_mode_t, nvs_handle_t*) { return ESP_FAIL; }
+static inline void nvs_close(nvs_handle_t) {}
+static inline esp_err_t nvs_get_blob(nvs_handle_t, const char*, void*, size_t*) { return ESP_FAIL; }
+static inline esp_err_t nvs_set_blob(nvs_handle_t, const char*, const void*, size_t) { return ESP_FAIL; }
+static inline esp_err_t nvs_erase_key(nvs_handle_t, const char*) { return ESP_FAIL; }
+static inline esp_err_t nvs_commit(nvs_handle_t) { return ESP_FAIL; }
@@ -0,0 +1,3 @@
+#pragma once
+
+// As on the ESP32: no SOC_RMT_SUPPORT_DMA
@@ -0,0 +1,395 @@
+/**
+ * @file jitter_sim.cpp
+ * @brief Host-side simulator for Audio::JitterBuffer
+ * 
+ * Feeds synthetic (or recorded) loss/jitter traces through the jitter
+ * buffer with a playout clock pulling one packet per packet duration, and
+ * reports the latency the buffer adds against the glitch rate it leaves,
+ * for a few fixed depths and for the adaptive configuration.
+ * 
+ * A few rebuffers decide where playout settles, so one seed can flatter
+ * any configuration by tens of milliseconds; --seeds averages the
+ * built-in scenarios over several. wifi-varying alternates calm and
+ * bursty stretches, which no single fixed depth suits.
+ * 
+ * Build and run from the repository root:
+ * 
+ *   g++ -std=gnu++17 -O2 -Icomponents/audio/include \
+ *       tools/jitter_sim.cpp components/audio/jitter_buffer.cpp -o jitter_sim
+ *   ./jitter_sim                       # built-in scenarios
+ *   ./jitter_sim --seeds 8             # the same, averaged over seeds 1-8
+ *   ./jitter_sim --trace capture.txt   # one "send_us arrival_us" per line,
+ *                                      # arrival_us < 0 for a lost packet
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "jitter_buffer.h"
+
+using Audio::JitterBuffer;
+using Audio::PacketInfo;
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 16000;
+constexpr uint32_t PACKET_MS = 20;
+constexpr uint32_t PACKET_FRAMES = SAMPLE_RATE * PACKET_MS / 1000;
+constexpr uint32_t FLUSH_TIMEOUT_MS = 100;
+
+struct TracePacket {
+    int64_t send_us;
+    int64_t arrival_us;     // < 0 = lost in the network
+};
+
+struct Scenario {
+    const char* name;
+    uint32_t packets;
+    double base_ms;         // Fixed one-way delay
+    double jitter_ms;       // Mean of the exponential queueing delay
+    double spike_prob;      // Chance of a delay spike per packet
+    double spike_ms;        // Upper bound of a spike (uniform from half of it)
+    double loss_prob;       // Chance of entering a loss burst
+    double burst_len;       // Mean loss burst length in packets
+};
+
+struct Result {
+    uint32_t sent;
+    uint32_t network_lost;
+    uint32_t played;
+    uint32_t concealed;     // Lost or late, filled by concealment
+    uint32_t underruns;
+    uint32_t trimmed;       // Crossfaded away to shrink the backlog
+    uint32_t late;
+    double mean_delay_ms;   // Send to playout
+    double p95_delay_ms;
+    double added_ms;        // Mean delay above the base network delay
+};
+
+std::vector<TracePacket> generate(const Scenario& s, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::exponential_distribution<double> queueing(s.jitter_ms > 0 ? 1.0 / s.jitter_ms : 1.0);
+    
+    std::vector<TracePacket> trace;
+    trace.reserve(s.packets);
+    uint32_t burst_left = 0;
+    
+    for (uint32_t i = 0; i < s.packets; i++) {
+        int64_t send_us = (int64_t)i * PACKET_MS * 1000;
+        
+        // Gilbert-style loss: bursts with a geometric length
+        if (burst_left == 0 && uniform(rng) < s.loss_prob) {
+            burst_left = 1 + (uint32_t)(-std::log(1.0 - uniform(rng)) * (s.burst_len - 1.0));
+        }
+        if (burst_left > 0) {
+            burst_left--;
+            trace.push_back({send_us, -1});
+            continue;
+        }
+        
+        double delay_ms = s.base_ms + (s.jitter_ms > 0 ? queueing(rng) : 0.0);
+        if (uniform(rng) < s.spike_prob) {
+            delay_ms += s.spike_ms * (0.5 + 0.5 * uniform(rng));
+        }
+        trace.push_back({send_us, send_us + (int64_t)(delay_ms * 1000)});
+    }
+    return trace;
+}
+
+bool loadTrace(const char* path, std::vector<TracePacket>& trace) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    long long send_us, arrival_us;
+    while (fscanf(file, "%lld %lld", &send_us, &arrival_us) == 2) {
+        trace.push_back({send_us, arrival_us});
+    }
+    fclose(file);
+    return !trace.empty();
+}
+
+Result simulate(const std::vector<TracePacket>& trace, const JitterBuffer::Config& config,
+                double base_ms) {
+    std::vector<uint8_t> storage(JitterBuffer::storageSize() + 4);
+    void* aligned = reinterpret_cast<void*>((reinterpret_cast<uintptr_t>(storage.data()) + 3) & ~(uintptr_t)3);
+    JitterBuffer jitter;
+    jitter.attach(aligned, config);
+    
+    // Arrivals in time order; the payload carries the send time so the
+    // playout side can measure delay
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < trace.size(); i++) {
+        if (trace[i].arrival_us >= 0) {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return trace[a].arrival_us < trace[b].arrival_us;
+    });
+    
+    Result result = {};
+    result.sent = (uint32_t)trace.size();
+    result.network_lost = result.sent - (uint32_t)order.size();
+    
+    uint8_t payload[PACKET_FRAMES * sizeof(int16_t)] = {};
+    uint8_t out[JitterBuffer::MAX_PAYLOAD];
+    std::vector<double> delays;
+    
+    const int64_t packet_us = PACKET_MS * 1000;
+    int64_t end_us = trace.back().send_us + 2000000;
+    size_t arrival = 0;
+    int64_t last_arrival_us = -1000000;
+    int64_t next_play_us = 0;
+    bool playing = false;
+    
+    for (int64_t now = 0; now < end_us; now += 1000) {
+        while (arrival < order.size() && trace[order[arrival]].arrival_us <= now) {
+            uint32_t index = order[arrival++];
+            int64_t send_us = trace[index].send_us;
+            memcpy(payload, &send_us, sizeof(send_us));
+            
+            PacketInfo packet = {};
+            packet.seq = (uint16_t)index;
+            packet.timestamp = index * PACKET_FRAMES;
+            packet.codec = Audio::Codec::PCM16;
+            packet.channels = 1;
+            packet.sample_rate = SAMPLE_RATE;
+            packet.payload = payload;
+            packet.payload_len = sizeof(payload);
+            jitter.push(packet, trace[index].arrival_us);
+            last_arrival_us = trace[index].arrival_us;
+        }
+        
+        // Playing: one pop per packet duration. Idle: try every tick, like
+        // the player task woken by each arrival.
+        if (playing && now < next_play_us) {
+            continue;
+        }
+        
+        // A surplus packet is crossfaded into the next one, which plays in
+        // its place
+        PacketInfo popped;
+        bool flush = now - last_arrival_us >= FLUSH_TIMEOUT_MS * 1000;
+        JitterBuffer::PopResult popped_result;
+        do {
+            popped_result = jitter.pop(out, popped, flush);
+        } while (popped_result == JitterBuffer::PopResult::TRIM);
+        switch (popped_result) {
+            case JitterBuffer::PopResult::PACKET: {
+                int64_t send_us;
+                memcpy(&send_us, out, sizeof(send_us));
+                delays.push_back((now - send_us) / 1000.0);
+                result.played++;
+                break;
+            }
+            case JitterBuffer::PopResult::LOST:
+                result.concealed++;
+                break;
+            case JitterBuffer::PopResult::UNDERRUN:
+                result.underruns++;
+                playing = false;
+                continue;
+            case JitterBuffer::PopResult::BUFFERING:
+            default:
+                playing = false;
+                continue;
+        }
+        
+        if (!playing) {
+            playing = true;
+            next_play_us = now;
+        }
+        next_play_us += packet_us;
+    }
+    
+    JitterBuffer::Stats stats = jitter.getStats();
+    result.late = stats.late;
+    result.trimmed = stats.trimmed;
+    if (!delays.empty()) {
+        double sum = 0;
+        for (double d : delays) {
+            sum += d;
+        }
+        result.mean_delay_ms = sum / delays.size();
+        std::sort(delays.begin(), delays.end());
+        result.p95_delay_ms = delays[(size_t)(delays.size() * 0.95)];
+        result.added_ms = result.mean_delay_ms - base_ms;
+    }
+    return result;
+}
+
+/**
+ * @brief Sum of several runs: counts add up, delays are averaged
+ */
+Result combine(const std::vector<Result>& runs) {
+    Result total = {};
+    for (const Result& r : runs) {
+        total.sent += r.sent;
+        total.network_lost += r.network_lost;
+        total.played += r.played;
+        total.concealed += r.concealed;
+        total.underruns += r.underruns;
+        total.trimmed += r.trimmed;
+        total.late += r.late;
+        total.mean_delay_ms += r.mean_delay_ms / runs.size();
+        total.p95_delay_ms += r.p95_delay_ms / runs.size();
+        total.added_ms += r.added_ms / runs.size();
+    }
+    return total;
+}
+
+void printHeader() {
+    printf("  %-16s %8s %8s %8s %9s %9s %9s %9s %9s\n",
+           "config", "added", "mean", "p95", "glitch%", "conceal", "underrun", "trimmed", "late");
+}
+
+void printRow(const char* label, const Result& r) {
+    // Glitches the listener hears: concealed packets and underrun gaps,
+    // over packets sent. Concealment includes network loss; trimmed
+    // packets are crossfaded into their successor and listed apart.
+    double glitch = r.sent ? 100.0 * (r.concealed + r.underruns) / r.sent : 0.0;
+    printf("  %-16s %6.1fms %6.1fms %6.1fms %8.2f%% %9u %9u %9u %9u\n",
+           label, r.added_ms, r.mean_delay_ms, r.p95_delay_ms, glitch,
+           r.concealed, r.underruns, r.trimmed, r.late);
+}
+
+void runAll(const std::vector<std::vector<TracePacket>>& traces, double base_ms) {
+    uint32_t sent = 0;
+    uint32_t lost = 0;
+    for (const auto& trace : traces) {
+        sent += (uint32_t)trace.size();
+        for (const auto& p : trace) {
+            lost += p.arrival_us < 0;
+        }
+    }
+    if (traces.size() > 1) {
+        printf("  %zu seeds of %zu packets of %u ms, network loss %.2f%%\n",
+               traces.size(), traces[0].size(), PACKET_MS, sent ? 100.0 * lost / sent : 0.0);
+    } else {
+        printf("  %u packets of %u ms, network loss %.2f%%\n",
+               sent, PACKET_MS, sent ? 100.0 * lost / sent : 0.0);
+    }
+    printHeader();
+    
+    auto run = [&](const JitterBuffer::Config& config) {
+        std::vector<Result> runs;
+        for (const auto& trace : traces) {
+            runs.push_back(simulate(trace, config, base_ms));
+        }
+        return combine(runs);
+    };
+    
+    static const uint32_t fixed_depths_ms[] = {20, 40, 80, 160};
+    for (uint32_t depth_ms : fixed_depths_ms) {
+        JitterBuffer::Config config = {depth_ms, depth_ms, 1, 2};
+        char label[32];
+        snprintf(label, sizeof(label), "fixed %ums", depth_ms);
+        printRow(label, run(config));
+    }
+    
+    // As AudioPlayer runs it with the device_config.h defaults
+    JitterBuffer::Config adaptive = {40, 200, 4, 2};
+    printRow("adaptive 40-200", run(adaptive));
+}
+
+/**
+ * @brief Two scenarios taking turns, phase_packets each
+ */
+std::vector<TracePacket> alternate(const Scenario& a, const Scenario& b, uint32_t phase_packets,
+                                   uint32_t phases, uint32_t seed) {
+    std::vector<TracePacket> trace;
+    for (uint32_t phase = 0; phase < phases; phase++) {
+        Scenario part = phase % 2 == 0 ? a : b;
+        part.packets = phase_packets;
+        int64_t offset_us = (int64_t)phase * phase_packets * PACKET_MS * 1000;
+        for (TracePacket p : generate(part, seed * phases + phase)) {
+            p.send_us += offset_us;
+            if (p.arrival_us >= 0) {
+                p.arrival_us += offset_us;
+            }
+            trace.push_back(p);
+        }
+    }
+    return trace;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t seed = 1;
+    uint32_t seeds = 1;
+    const char* trace_path = nullptr;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--seeds") == 0 && i + 1 < argc) {
+            seeds = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--seed N] [--seeds COUNT] [--trace FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (seeds == 0) {
+        seeds = 1;
+    }
+    
+    if (trace_path) {
+        std::vector<TracePacket> trace;
+        if (!loadTrace(trace_path, trace)) {
+            fprintf(stderr, "Cannot read trace %s\n", trace_path);
+            return 1;
+        }
+        // Without a known base delay, report added latency above the
+        // fastest observed transit
+        double base_ms = 1e9;
+        for (const auto& p : trace) {
+            if (p.arrival_us >= 0) {
+                base_ms = std::min(base_ms, (p.arrival_us - p.send_us) / 1000.0);
+            }
+        }
+        printf("%s\n", trace_path);
+        runAll({trace}, base_ms);
+        return 0;
+    }
+    
+    static const Scenario scenarios[] = {
+        // name          packets base  jitter spike  spike_ms loss   burst
+        {"lan",          3000,   2.0,  0.5,   0.0,   0.0,     0.0,   1.0},
+        {"wifi-calm",    3000,   5.0,  3.0,   0.005, 40.0,    0.005, 1.0},
+        {"wifi-busy",    3000,   8.0,  12.0,  0.02,  120.0,   0.01,  2.0},
+        {"wifi-bursty",  3000,   8.0,  25.0,  0.05,  200.0,   0.02,  4.0},
+    };
+    
+    for (const auto& scenario : scenarios) {
+        printf("%s (base %.0f ms, jitter %.0f ms, spikes %.1f%% up to %.0f ms)\n",
+               scenario.name, scenario.base_ms, scenario.jitter_ms,
+               scenario.spike_prob * 100.0, scenario.spike_ms);
+        std::vector<std::vector<TracePacket>> traces;
+        for (uint32_t i = 0; i < seeds; i++) {
+            traces.push_back(generate(scenario, seed + i));
+        }
+        runAll(traces, scenario.base_ms);
+        printf("\n");
+    }
+    
+    // A link that keeps changing: 20 s calm, 20 s bursty, three times over
+    const Scenario& calm = scenarios[1];
+    const Scenario& bursty = scenarios[3];
+    printf("wifi-varying (%s and %s taking turns every 20 s)\n", calm.name, bursty.name);
+    std::vector<std::vector<TracePacket>> traces;
+    for (uint32_t i = 0; i < seeds; i++) {
+        traces.push_back(alternate(calm, bursty, 1000, 6, seed + i));
+    }
+    runAll(traces, (calm.base_ms + bursty.base_ms) / 2);
+    return 0;
+}
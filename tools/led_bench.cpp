@@ -0,0 +1,445 @@
+/**
+ * @file led_bench.cpp
+ * @brief Host-side benchmark for the LED animation engine
+ * 
+ * Checks the led_math.h tables against double precision, times them
+ * against the per-pixel sin() the animations used before, then renders
+ * every AnimationType through the real LedController on a fake clock and
+ * reports the time and heap allocations per frame (animation plus
+ * show()), how many frames reached the strip, and what setAnimation()
+ * costs to parse a config. Last, it checks that animations keep their pace
+ * at a lower frame rate and that the frame rate backs off under load.
+ * 
+ * LedController is not platform independent, so it builds against the
+ * declarations in tools/host_shims/; this file provides the clock, the
+ * random source and a counting RMT channel that reports each transmit done
+ * one wire time later on the fake clock, as the RMT ISR would. Add
+ * -DNUM_LEDS=300 (say) to the build line for a longer strip. To compare two revisions, build
+ * the benchmark against each one's led_controller.cpp (e.g. from a git
+ * worktree). Host timings only rank the work: the ESP32 has no double
+ * precision FPU, so every sin() there is far dearer than here.
+ * 
+ * Build and run from the repository root:
+ * 
+ *   g++ -std=gnu++17 -O2 -Itools/host_shims -Icomponents/led/include \
+ *       tools/led_bench.cpp components/led/led_controller.cpp -o led_bench
+ *   ./led_bench
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+#include "led_controller.h"
+#include "led_math.h"
+#include "ws2812_encoder.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+constexpr int FRAMES = 2000;
+constexpr int64_t FRAME_US = 16000;         // LED_UPDATE_PERIOD_MS
+constexpr int ROUNDS = 50;
+constexpr int64_t WIRE_US = NUM_LEDS * 24 * 125 / 100 + 50;   // 1.25us per bit, 50us reset
+
+int64_t g_now_us = 1000000;
+uint32_t g_random = 2463534242u;
+uint64_t g_refreshes = 0;
+int64_t g_render_cost_us = 0;   // Added to the clock per transmit, as CPU pressure
+
+struct FakeChannel {
+    rmt_tx_done_callback_t done = nullptr;
+    void* ctx = nullptr;
+    int64_t done_us = -1;       // When the transmit on the wire ends, < 0 idle
+    uint8_t frame[NUM_LEDS * 3] = {};
+};
+
+FakeChannel g_channels[64];
+size_t g_channel_count = 0;
+
+FakeChannel* fake(rmt_channel_handle_t channel) {
+    return reinterpret_cast<FakeChannel*>(channel);
+}
+uint64_t g_allocations = 0;
+
+uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+const char* unit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
+
+// What LedController::beatsin8() and the plasma/aurora pixels computed before
+uint8_t referenceBeatsin8(uint32_t ms, uint8_t bpm, uint8_t lowest, uint8_t highest, uint8_t phase_offset) {
+    uint16_t beat16 = (ms * bpm * 280) / 60000;
+    uint8_t wave = (sin((beat16 + phase_offset) * 3.14159 / 128.0) + 1.0) * 127.5;
+    return lowest + (((highest - lowest) * wave) >> 8);
+}
+
+bool correctness() {
+    int sin_worst = 0;
+    int cos_worst = 0;
+    int gamma_worst = 0;
+    for (int i = 0; i < 256; i++) {
+        double angle = 2.0 * M_PI * i / 256.0;
+        sin_worst = std::max(sin_worst, std::abs(LedMath::sin8(i) - (int)std::lround(127.5 + 127.5 * std::sin(angle))));
+        cos_worst = std::max(cos_worst, std::abs(LedMath::cos8(i) - (int)std::lround(127.5 + 127.5 * std::cos(angle))));
+        int gamma = (int)std::lround(255.0 * std::pow(i / 255.0, 2.2));
+        gamma_worst = std::max(gamma_worst, std::abs(LedMath::gamma8(i) - gamma));
+    }
+    
+    // One beat per 60000 / bpm ms, to within the 280 / 256 approximation
+    uint32_t period_ms = 0;
+    for (uint32_t ms = 1; ms < 10000 && period_ms == 0; ms++) {
+        if (LedMath::beat16(60, ms) < LedMath::beat16(60, ms - 1)) {
+            period_ms = ms;
+        }
+    }
+    
+    bool ok = sin_worst <= 1 && cos_worst <= 1 && gamma_worst <= 1 && period_ms >= 995 && period_ms <= 1000;
+    printf("tables against double precision (max error in LSB):\n");
+    printf("  %-24s %d\n", "sin8", sin_worst);
+    printf("  %-24s %d\n", "cos8", cos_worst);
+    printf("  %-24s %d\n", "gamma8 (2.2)", gamma_worst);
+    printf("  %-24s %u ms\n", "beat16 period at 60 bpm", period_ms);
+    printf("  %s\n\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+template <typename Kernel>
+double timePerCall(size_t calls, Kernel kernel) {
+    uint64_t best = UINT64_MAX;
+    for (int round = 0; round < ROUNDS; round++) {
+        uint64_t start = now();
+        kernel();
+        best = std::min(best, now() - start);
+    }
+    return (double)best / calls;
+}
+
+void kernels() {
+    constexpr size_t CALLS = 4096;
+    volatile uint32_t sink = 0;
+    
+    printf("cost per call (best of %d):\n", ROUNDS);
+    printf("  %-24s %7.1f %s\n", "beatsin8, sin()", timePerCall(CALLS, [&] {
+        uint32_t sum = 0;
+        for (size_t i = 0; i < CALLS; i++) {
+            sum += referenceBeatsin8(1000 + (uint32_t)i * 16, 30, 50, 255, (uint8_t)i);
+        }
+        sink = sink + sum;
+    }), unit());
+    printf("  %-24s %7.1f %s\n", "beatsin8, tables", timePerCall(CALLS, [&] {
+        uint32_t sum = 0;
+        for (size_t i = 0; i < CALLS; i++) {
+            sum += LedMath::beatsin8(30, 1000 + (uint32_t)i * 16, 50, 255, 0, (uint8_t)i);
+        }
+        sink = sink + sum;
+    }), unit());
+    printf("  %-24s %7.1f %s\n", "aurora pixel, sin()", timePerCall(CALLS, [&] {
+        uint32_t sum = 0;
+        for (size_t i = 0; i < CALLS; i++) {
+            sum += (uint8_t)((sin((i % 12 * 50 + i) * 0.01) + 1.0) * 127.5);
+        }
+        sink = sink + sum;
+    }), unit());
+    printf("  %-24s %7.1f %s\n\n", "aurora pixel, sin8", timePerCall(CALLS, [&] {
+        uint32_t sum = 0;
+        for (size_t i = 0; i < CALLS; i++) {
+            sum += LedMath::sin8((uint8_t)(((uint32_t)(i % 12 * 50 + i) * 26) >> 6));
+        }
+        sink = sink + sum;
+    }), unit());
+}
+
+struct Animation {
+    AnimationType type;
+    const char* name;
+    const char* config;
+};
+
+const Animation ANIMATIONS[] = {
+    {OFF,               "OFF",               ""},
+    {PROCESSING,        "PROCESSING",        ""},
+    {SUCCESS,           "SUCCESS",           ""},
+    {WAITING,           "WAITING",           ""},
+    {STARTUP,           "STARTUP",           ""},
+    {SHUTDOWN,          "SHUTDOWN",          ""},
+    {RAINBOW_PULSE,     "RAINBOW_PULSE",     ""},
+    {FIREWORK,          "FIREWORK",          ""},
+    {POLICE,            "POLICE",            ""},
+    {HEARTBEAT,         "HEARTBEAT",         ""},
+    {FIRE,              "FIRE",              ""},
+    {CANDY_CANE,        "CANDY_CANE",        ""},
+    {STROBE,            "STROBE",            ""},
+    {HEARTBEAT_FLASH,   "HEARTBEAT_FLASH",   ""},
+    {DEVICE_SHUTDOWN,   "DEVICE_SHUTDOWN",   ""},
+    {BLINKING_WARNING,  "BLINKING_WARNING",  ""},
+    {WAKE_WORD,         "WAKE_WORD",         ""},
+    {SPEECH_PROCESSING, "SPEECH_PROCESSING", ""},
+    {NOTIFICATION,      "NOTIFICATION",      ""},
+    {ERROR_BLINK,       "ERROR_BLINK",       ""},
+    {PAIRING,           "PAIRING",           ""},
+    {VOICE_RESPONSE,    "VOICE_RESPONSE",    ""},
+    {ACTION_CONFIRM,    "ACTION_CONFIRM",    ""},
+    {CONF_PULSE,        "CONF_PULSE",        "SPEED:15,COLOR:#0040FF"},
+    {CONF_CHASE,        "CONF_CHASE",        "SPEED:80,COLOR:#FF2000,FADE:40"},
+    {CONF_SPARKLE,      "CONF_SPARKLE",      "SPEED:20,COLOR:#FFFFFF"},
+    {CONF_GRADIENT,     "CONF_GRADIENT",     "COLOR:#FF0000,COLOR2:#0000FF"},
+    {CONF_WAVE,         "CONF_WAVE",         "SPEED:20,COLOR:#00FF80"},
+    {CONF_AURORA,       "CONF_AURORA",       "SPEED:20"},
+    {CONF_PLASMA,       "CONF_PLASMA",       "SPEED:20"},
+    {SOLID_COLOR,       "SOLID_COLOR",       ""},
+};
+
+void rmtIsr() {
+    for (size_t i = 0; i < g_channel_count; i++) {
+        FakeChannel& channel = g_channels[i];
+        if (channel.done_us >= 0 && g_now_us >= channel.done_us) {
+            channel.done_us = -1;
+            rmt_tx_done_event_data_t event = {};
+            channel.done(nullptr, &event, channel.ctx);
+        }
+    }
+}
+
+void frames() {
+    LedController leds;
+    leds.init(GPIO_NUM_33);
+    
+    printf("frame time per AnimationType in %s (%d frames of %lld ms, %d LEDs, animation + show()),\n"
+           "frames sent, skipped unchanged and dropped busy, and the mean time show() blocks in us:\n",
+           unit(), FRAMES, (long long)(FRAME_US / 1000), NUM_LEDS);
+    printf("  %-20s %8s %8s %10s %8s %8s %8s %8s\n", "animation", "mean", "p99", "refreshes", "skipped", "busy", "show us", "allocs");
+    std::vector<uint64_t> times(FRAMES);
+    for (const Animation& anim : ANIMATIONS) {
+        leds.setAnimation(anim.type, 0, anim.config);
+        uint64_t total = 0;
+        uint64_t refreshes = g_refreshes;
+        uint64_t allocations = g_allocations;
+        LedStats before = leds.getStats();
+        for (int frame = 0; frame < FRAMES; frame++) {
+            g_now_us += FRAME_US;
+            rmtIsr();
+            uint64_t start = now();
+            leds.update(true);
+            times[frame] = now() - start;
+            total += times[frame];
+        }
+        std::sort(times.begin(), times.end());
+        const LedStats& after = leds.getStats();
+        printf("  %-20s %8.0f %8llu %10llu %8lu %8lu %8.0f %8llu\n", anim.name, (double)total / FRAMES,
+               (unsigned long long)times[FRAMES * 99 / 100],
+               (unsigned long long)(g_refreshes - refreshes),
+               (unsigned long)(after.skipped - before.skipped),
+               (unsigned long)(after.busy - before.busy),
+               (double)(after.show_us - before.show_us) / FRAMES,
+               (unsigned long long)(g_allocations - allocations));
+    }
+    
+    // Parsing happens once per setAnimation(), not per frame
+    const char* config = "SPEED:80,COLOR:#FF2000,FADE:40";
+    uint64_t allocations = g_allocations;
+    uint64_t best = UINT64_MAX;
+    for (int round = 0; round < ROUNDS; round++) {
+        uint64_t start = now();
+        leds.setAnimation(CONF_CHASE, 0, config);
+        best = std::min(best, now() - start);
+    }
+    printf("\nsetAnimation(CONF_CHASE, \"%s\"): %llu %s, %.1f allocs\n", config,
+           (unsigned long long)best, unit(), (double)(g_allocations - allocations) / ROUNDS);
+}
+
+// The same animation at 60 and 20 FPS, compared whenever both render
+void pacing() {
+    const AnimationType types[] = {PROCESSING, WAITING, RAINBOW_PULSE, FIREWORK, POLICE, HEARTBEAT, FIRE,
+                                   DEVICE_SHUTDOWN, WAKE_WORD, CONF_CHASE, CONF_AURORA, CONF_PLASMA};
+    printf("\n60 against 20 FPS, difference per channel when both render (LSB):\n");
+    printf("  %-20s %8s %8s\n", "animation", "mean", "max");
+    for (AnimationType type : types) {
+        const Animation* anim = nullptr;
+        for (const Animation& a : ANIMATIONS) {
+            if (a.type == type) anim = &a;
+        }
+        LedController fast, slow;
+        fast.init(GPIO_NUM_33);
+        slow.init(GPIO_NUM_33);
+        slow.setFrameRate(20);
+        fast.setAnimation(type, 0, anim->config);
+        slow.setAnimation(type, 0, anim->config);
+        
+        uint64_t total = 0;
+        uint64_t compared = 0;
+        int worst = 0;
+        for (int frame = 0; frame < FRAMES; frame++) {
+            g_now_us += FRAME_US;
+            rmtIsr();
+            uint32_t slow_frames = slow.getStats().frames;
+            fast.update(true);
+            slow.update(true);
+            if (slow.getStats().frames == slow_frames) {
+                continue;
+            }
+            const uint8_t* a = g_channels[g_channel_count - 2].frame;
+            const uint8_t* b = g_channels[g_channel_count - 1].frame;
+            for (int i = 0; i < NUM_LEDS * 3; i++) {
+                int diff = std::abs(a[i] - b[i]);
+                total += diff;
+                worst = std::max(worst, diff);
+                compared++;
+            }
+        }
+        printf("  %-20s %8.2f %8d\n", anim->name, compared ? (double)total / compared : 0.0, worst);
+    }
+}
+
+// Render time inflated per frame sent, as if the CPU were busy elsewhere;
+// update() is called every 16 ms or, if rendering overran, straight after
+void adaptive() {
+    printf("\nframe rate under load (60 FPS target, %d calls, RAINBOW_PULSE):\n", FRAMES);
+    printf("  %-20s %8s %8s %10s\n", "render time", "FPS", "CPU", "slowdowns");
+    const int64_t costs_us[] = {0, 4000, 8000, 12000};
+    for (int64_t cost_us : costs_us) {
+        LedController leds;
+        leds.init(GPIO_NUM_33);
+        leds.setAnimation(RAINBOW_PULSE, 0, "");
+        g_render_cost_us = cost_us;
+        int64_t start_us = g_now_us;
+        uint32_t start_frames = leds.getStats().frames;
+        uint64_t refreshes = g_refreshes;
+        for (int frame = 1; frame <= FRAMES; frame++) {
+            g_now_us = std::max(g_now_us, start_us + frame * FRAME_US);
+            rmtIsr();
+            leds.update(true);
+        }
+        g_render_cost_us = 0;
+        const LedStats& stats = leds.getStats();
+        char label[24];
+        snprintf(label, sizeof(label), "%lld ms", (long long)(cost_us / 1000));
+        double elapsed_us = (double)(g_now_us - start_us);
+        printf("  %-20s %8.1f %7.0f%% %10lu\n", label,
+               (stats.frames - start_frames) * 1e6 / elapsed_us,
+               100.0 * (g_refreshes - refreshes) * cost_us / elapsed_us,
+               (unsigned long)stats.slowdowns);
+    }
+}
+
+} // namespace
+
+// Every heap allocation the controller makes is counted
+
+void* operator new(size_t size) {
+    g_allocations++;
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+// The platform LedController expects, faked for the host
+
+extern "C" int64_t esp_timer_get_time(void) {
+    return g_now_us;
+}
+
+extern "C" uint32_t esp_random(void) {
+    g_random ^= g_random << 13;
+    g_random ^= g_random >> 17;
+    g_random ^= g_random << 5;
+    return g_random;
+}
+
+extern "C" esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t*, rmt_channel_handle_t* ret_chan) {
+    if (g_channel_count == sizeof(g_channels) / sizeof(g_channels[0])) {
+        return ESP_ERR_NO_MEM;
+    }
+    *ret_chan = reinterpret_cast<rmt_channel_handle_t>(&g_channels[g_channel_count++]);
+    return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_del_channel(rmt_channel_handle_t channel) {
+    *fake(channel) = FakeChannel();
+    return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_disable(rmt_channel_handle_t) {
+    return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t channel, int) {
+    FakeChannel* tx = fake(channel);
+    if (tx->done_us >= 0) {
+        g_now_us = std::max(g_now_us, tx->done_us);
+        rmtIsr();
+    }
+    return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_del_encoder(rmt_encoder_handle_t) {
+    return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t channel, const rmt_tx_event_callbacks_t* cbs,
+                                                     void* user_data) {
+    fake(channel)->done = cbs->on_trans_done;
+    fake(channel)->ctx = user_data;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_enable(rmt_channel_handle_t) {
+    return ESP_OK;
+}
+
+extern "C" esp_err_t rmt_transmit(rmt_channel_handle_t channel, rmt_encoder_handle_t, const void* payload,
+                                  size_t payload_bytes, const rmt_transmit_config_t*) {
+    FakeChannel* tx = fake(channel);
+    if (tx->done_us >= 0) {
+        return ESP_ERR_INVALID_STATE;   // The controller must not queue behind itself
+    }
+    g_refreshes++;
+    g_now_us += g_render_cost_us;
+    memcpy(tx->frame, payload, std::min(payload_bytes, sizeof(tx->frame)));
+    tx->done_us = g_now_us + WIRE_US;
+    return ESP_OK;
+}
+
+esp_err_t ws2812_new_encoder(uint32_t, rmt_encoder_handle_t* ret_encoder) {
+    static rmt_encoder_t encoder;
+    *ret_encoder = &encoder;
+    return ESP_OK;
+}
+
+int main() {
+    bool ok = correctness();
+    kernels();
+    frames();
+    pacing();
+    adaptive();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,393 @@
+/**
+ * @file mic_sim.cpp
+ * @brief Host-side run of the microphone uplink
+ * 
+ * Captures a WAV file through Audio::WavCaptureSource and Audio::MicFramer
+ * into the device's Features::StreamSender, on a virtual clock: the
+ * capture task commits a frame each time its last sample is in, and the
+ * network task runs service() on every wakeup, unless it is stalled by a
+ * simulated outage. Pacing, queueing and the max-age drop are the
+ * sender's own; the AVI core is replaced by a stub that records what it
+ * was handed and passes each message on to a counting transport behind a
+ * stand-in header. Reports capture-to-send latency and lost frames per
+ * scenario, and checks that every packet that made it out reassembles
+ * bit-exactly into the input and left as bulk traffic.
+ * 
+ * Build and run from the repository root:
+ * 
+ *   g++ -std=gnu++17 -O2 -Itools/host_shims -Icomponents/audio/include \
+ *       -Icomponents/avi_embedded/include -Icomponents/avi_transport/include \
+ *       -Icomponents/lockfree/include \
+ *       -Icomponents/device_features/include tools/mic_sim.cpp \
+ *       components/device_features/stream_sender.cpp \
+ *       components/audio/mic_framer.cpp components/audio/wav_capture_source.cpp \
+ *       components/audio/vad.cpp -o mic_sim
+ *   ./mic_sim                          # synthetic 10 s tone, 16 kHz mono
+ *   ./mic_sim --wav speech.wav         # any 16-bit PCM WAV
+ *   ./mic_sim --publish                # pub/sub instead of an AVI stream
+ *   ./mic_sim --wav speech.wav --out sent.wav   # what the server would hear
+ *                                               # in the "outages" scenario
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "avi_embedded.h"
+#include "mic_framer.h"
+#include "stream_sender.h"
+#include "transport.h"
+#include "wav_capture_source.h"
+
+using Audio::MicFramer;
+using Audio::PacketInfo;
+using Features::StreamSender;
+
+namespace {
+
+int64_t g_now_us = 0;
+
+struct Scenario {
+    const char* name;
+    uint32_t max_kbps;          // Sender pacing rate, 0 = unpaced
+    uint32_t outage_every_ms;   // Network task stalled periodically, 0 = never
+    uint32_t outage_ms;
+    uint32_t max_age_ms;
+};
+
+/**
+ * @brief Transport that only counts what it is given, per traffic class
+ */
+class SimTransport : public AVI::Transport {
+public:
+    bool connect() override { return true; }
+    void disconnect() override {}
+    bool isConnected() const override { return true; }
+    
+    int32_t send(const uint8_t* data, size_t length) override {
+        AVI::TrafficClassMetrics& metrics = m_class[static_cast<size_t>(m_tx_class)];
+        metrics.accepted++;
+        metrics.accepted_bytes += length;
+        metrics.sent++;
+        if (length > 0 && data[0] == MEDIA && m_tx_class != AVI::TrafficClass::BULK) {
+            media_not_bulk++;
+        }
+        return (int32_t)length;
+    }
+    
+    int32_t receive(uint8_t*, size_t) override { return 0; }
+    bool hasPendingData() const override { return false; }
+    bool waitForActivity(uint32_t) override { return false; }
+    void wakeup() override {}
+    uint32_t getRxPacketCount() const override { return 0; }
+    size_t getRxBacklog() const override { return 0; }
+    AVI::TransportMetrics getMetrics() const override { return {}; }
+    AVI::TrafficClassMetrics getClassMetrics(AVI::TrafficClass tc) const override {
+        return m_class[static_cast<size_t>(tc)];
+    }
+    
+    static constexpr uint8_t MEDIA = 1;     // First byte of a stub media message
+    uint32_t media_not_bulk = 0;
+    
+private:
+    AVI::TrafficClassMetrics m_class[static_cast<size_t>(AVI::TrafficClass::COUNT)] = {};
+};
+
+// Stand-in for the AVI core's own message header; the real size depends
+// on the core's serialization
+constexpr size_t STUB_HEADER_BYTES = 8;
+
+} // namespace
+
+// What StreamSender expects from the platform and the AVI core, faked for
+// the host
+
+extern "C" int64_t esp_timer_get_time(void) {
+    return g_now_us;
+}
+
+struct AVI_AviEmbedded {
+    SimTransport* transport;
+    uint8_t open_stream;                        // 0 = none
+    std::vector<std::vector<uint8_t>> sent;
+    std::vector<int64_t> sent_at_us;
+};
+
+static int32_t stubSend(AVI_AviEmbedded* avi, uint8_t type, const char* topic, size_t topic_len,
+                        const uint8_t* data, size_t data_len) {
+    uint8_t datagram[STUB_HEADER_BYTES + 256 + StreamSender::MAX_PACKET] = {type};
+    size_t length = STUB_HEADER_BYTES;
+    memcpy(datagram + length, topic, topic_len);
+    length += topic_len;
+    memcpy(datagram + length, data, data_len);
+    length += data_len;
+    if (avi->transport->send(datagram, length) < 0) {
+        return -1;
+    }
+    if (type == SimTransport::MEDIA) {
+        avi->sent.emplace_back(data, data + data_len);
+        avi->sent_at_us.push_back(g_now_us);
+    }
+    return 0;
+}
+
+extern "C" int32_t avi_embedded_start_stream(AVI_AviEmbedded* avi, uint8_t local_stream_id,
+                                             const char*, uintptr_t, const char*, uintptr_t) {
+    avi->open_stream = local_stream_id;
+    return stubSend(avi, 0, nullptr, 0, nullptr, 0);
+}
+
+extern "C" int32_t avi_embedded_send_stream_data(AVI_AviEmbedded* avi, uint8_t local_stream_id,
+                                                 const uint8_t* data, uintptr_t data_len) {
+    if (local_stream_id == 0 || local_stream_id != avi->open_stream) {
+        return -1;
+    }
+    return stubSend(avi, SimTransport::MEDIA, nullptr, 0, data, data_len);
+}
+
+extern "C" int32_t avi_embedded_close_stream(AVI_AviEmbedded* avi, uint8_t local_stream_id) {
+    if (local_stream_id == avi->open_stream) {
+        avi->open_stream = 0;
+    }
+    return stubSend(avi, 0, nullptr, 0, nullptr, 0);
+}
+
+extern "C" int32_t avi_embedded_publish(AVI_AviEmbedded* avi, const char* topic, uintptr_t topic_len,
+                                        const uint8_t* data, uintptr_t data_len) {
+    if (topic_len > 256) {
+        return -1;
+    }
+    return stubSend(avi, SimTransport::MEDIA, topic, topic_len, data, data_len);
+}
+
+namespace {
+
+void writeLe(FILE* f, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        fputc((int)((value >> (8 * i)) & 0xFF), f);
+    }
+}
+
+bool writeWav(const char* path, const std::vector<int16_t>& samples, uint32_t rate, uint8_t channels) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    uint32_t data_bytes = (uint32_t)(samples.size() * sizeof(int16_t));
+    fwrite("RIFF", 1, 4, f);
+    writeLe(f, 36 + data_bytes, 4);
+    fwrite("WAVEfmt ", 1, 8, f);
+    writeLe(f, 16, 4);
+    writeLe(f, 1, 2);
+    writeLe(f, channels, 2);
+    writeLe(f, rate, 4);
+    writeLe(f, rate * channels * 2, 4);
+    writeLe(f, channels * 2, 2);
+    writeLe(f, 16, 2);
+    fwrite("data", 1, 4, f);
+    writeLe(f, data_bytes, 4);
+    fwrite(samples.data(), sizeof(int16_t), samples.size(), f);
+    fclose(f);
+    return true;
+}
+
+std::vector<int16_t> readAll(const char* path, uint32_t& rate, uint8_t& channels) {
+    Audio::WavCaptureSource source;
+    std::vector<int16_t> samples;
+    if (!source.open(path, false) || !source.start()) {
+        return samples;
+    }
+    rate = source.getSampleRate();
+    channels = source.getChannels();
+    int16_t block[256];
+    int64_t at;
+    while (source.read(block, 256 / channels, at)) {
+        samples.insert(samples.end(), block, block + (256 / channels) * channels);
+    }
+    return samples;
+}
+
+bool inOutage(const Scenario& scenario, int64_t t) {
+    if (scenario.outage_every_ms == 0) {
+        return false;
+    }
+    int64_t period = (int64_t)scenario.outage_every_ms * 1000;
+    return t % period >= period - (int64_t)scenario.outage_ms * 1000;
+}
+
+void run(const Scenario& scenario, const char* wav, uint32_t frame_ms, StreamSender::Mode mode,
+         const char* out_path) {
+    Audio::WavCaptureSource source;
+    if (!source.open(wav, false) || !source.start()) {
+        fprintf(stderr, "Cannot read %s as 16-bit PCM WAV\n", wav);
+        exit(1);
+    }
+
+    // Device defaults (device_config.h) but for the scenario's rate and age
+    SimTransport transport;
+    AVI_AviEmbedded avi = {};
+    avi.transport = &transport;
+    StreamSender sender(&avi, transport);
+    StreamSender::Config sender_config = {
+        .mode = mode,
+        .target = "server",
+        .reason = "microphone",
+        .topic = "device/audio/uplink",
+        .max_kbps = scenario.max_kbps,
+        .burst_bytes = 4096,
+        .max_age_ms = scenario.max_age_ms
+    };
+    sender.configure(sender_config);
+
+    MicFramer framer;
+    MicFramer::Config config = {source.getSampleRate(), source.getChannels(), frame_ms, 0};
+    if (!framer.init(config, &source, &sender)) {
+        fprintf(stderr, "%u ms frames do not fit a %zu byte packet\n", frame_ms, StreamSender::MAX_PACKET);
+        exit(1);
+    }
+
+    g_now_us = 0;
+    sender.onConnected();
+    sender.begin();
+
+    // A frame is committed once its last sample is in, and wakes the
+    // network task; a stalled network task catches up when the outage ends
+    int64_t frame_us = (int64_t)framer.getFrameFrames() * 1000000 / config.sample_rate;
+    int64_t period_us = (int64_t)scenario.outage_every_ms * 1000;
+    bool stalled = false;
+    while (true) {
+        int64_t next = g_now_us + frame_us;
+        if (stalled && !inOutage(scenario, next)) {
+            g_now_us = (g_now_us / period_us + 1) * period_us;
+            sender.service();
+        }
+        g_now_us = next;
+        bool captured = framer.captureFrame();
+        stalled = inOutage(scenario, g_now_us);
+        if (!stalled) {
+            sender.service();
+        }
+        if (!captured) {
+            break;
+        }
+    }
+    // Then give the network task time to empty the queue
+    auto pending = [&]() {
+        StreamSender::Stats s = sender.getStats();
+        return s.queued - s.sent - s.stale - s.send_errors;
+    };
+    for (int i = 0; i < 100 && (stalled || pending() > 0); i++) {
+        g_now_us += frame_us;
+        stalled = inOutage(scenario, g_now_us);
+        if (!stalled) {
+            sender.service();
+        }
+    }
+    MicFramer::Stats stats = framer.getStats();
+    StreamSender::Stats sent_stats = sender.getStats();
+
+    // Reassemble by timestamp; frames that never arrived stay silent
+    uint32_t input_rate = 0;
+    uint8_t channels = 0;
+    std::vector<int16_t> input = readAll(wav, input_rate, channels);
+    std::vector<int16_t> output(input.size(), 0);
+    size_t mismatches = 0;
+    std::vector<int64_t> latency;
+    for (size_t i = 0; i < avi.sent.size(); i++) {
+        const std::vector<uint8_t>& packet = avi.sent[i];
+        PacketInfo info;
+        if (!Audio::parsePacket(packet.data(), packet.size(), info)) {
+            mismatches++;
+            continue;
+        }
+        // The source's clock starts at 0, so the timestamp gives the capture time
+        latency.push_back(avi.sent_at_us[i] - (int64_t)info.timestamp * 1000000 / config.sample_rate);
+        size_t offset = (size_t)info.timestamp * channels;
+        size_t count = info.payload_len / sizeof(int16_t);
+        if (offset + count > input.size() ||
+            memcmp(info.payload, &input[offset], info.payload_len) != 0) {
+            mismatches++;
+            continue;
+        }
+        memcpy(&output[offset], info.payload, info.payload_len);
+    }
+
+    std::sort(latency.begin(), latency.end());
+    auto pct = [&](double p) {
+        return latency.empty() ? 0.0 : latency[(size_t)(p * (latency.size() - 1))] / 1000.0;
+    };
+    uint32_t total = stats.frames + stats.dropped;
+    printf("%-10s %6u %6u %6u %6zu %7.1f%% %8.1f %8.1f %8.1f %6llu %6zu\n",
+           scenario.name, total, stats.dropped, sent_stats.stale, avi.sent.size(),
+           total ? 100.0 * (total - avi.sent.size()) / total : 0.0,
+           pct(0.5), pct(0.99), pct(1.0),
+           (unsigned long long)(sent_stats.sent ? (sent_stats.wire_bytes - sent_stats.payload_bytes) / sent_stats.sent : 0),
+           mismatches);
+
+    if (transport.media_not_bulk > 0) {
+        printf("  %u media datagrams were not sent as BULK\n", transport.media_not_bulk);
+    }
+    if (sent_stats.wire_bytes != transport.getClassMetrics(AVI::TrafficClass::BULK).accepted_bytes) {
+        printf("  wire bytes %llu do not match what the transport took\n",
+               (unsigned long long)sent_stats.wire_bytes);
+    }
+
+    if (out_path && !writeWav(out_path, output, config.sample_rate, channels)) {
+        fprintf(stderr, "Cannot write %s\n", out_path);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string wav;
+    const char* out_path = nullptr;
+    uint32_t frame_ms = 20;
+    StreamSender::Mode mode = StreamSender::Mode::STREAM;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--wav") && i + 1 < argc) {
+            wav = argv[++i];
+        } else if (!strcmp(argv[i], "--out") && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (!strcmp(argv[i], "--frame-ms") && i + 1 < argc) {
+            frame_ms = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--publish")) {
+            mode = StreamSender::Mode::PUBLISH;
+        } else {
+            fprintf(stderr, "usage: %s [--wav in.wav] [--out sent.wav] [--frame-ms N] [--publish]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (wav.empty()) {
+        // 10 s of a 440 Hz tone at the device's capture format
+        std::vector<int16_t> tone(16000 * 10);
+        for (size_t i = 0; i < tone.size(); i++) {
+            tone[i] = (int16_t)(8000 * sin(2 * M_PI * 440 * i / 16000.0));
+        }
+        wav = "/tmp/mic_sim_tone.wav";
+        if (!writeWav(wav.c_str(), tone, 16000, 1)) {
+            fprintf(stderr, "Cannot write %s\n", wav.c_str());
+            return 1;
+        }
+    }
+
+    static const Scenario scenarios[] = {
+        {"clean",    512, 0,    0,   200},
+        {"slow",     256, 0,    0,   200},  // Below the stream's own rate
+        {"outages",  512, 2000, 150, 200},
+        {"long-out", 512, 5000, 400, 200},
+    };
+
+    printf("%-10s %6s %6s %6s %6s %8s %8s %8s %8s %6s %6s\n",
+           "scenario", "frames", "nobuf", "stale", "sent", "lost", "p50 ms", "p99 ms", "max ms",
+           "ovh B", "bad");
+    for (const auto& scenario : scenarios) {
+        bool write = out_path && !strcmp(scenario.name, "outages");
+        run(scenario, wav.c_str(), frame_ms, mode, write ? out_path : nullptr);
+    }
+    return 0;
+}
@@ -0,0 +1,252 @@
+/**
+ * @file mix_bench.cpp
+ * @brief Host-side benchmark for the output mixer kernels
+ * 
+ * Checks the fixed-point gain and mix kernels against a double-precision
+ * reference (within one LSB, saturating instead of wrapping), then reports
+ * their cost per sample for flat and ramped gains, mono and stereo. Last,
+ * runs Audio::Mixer chunk by chunk over a stream with an earcon-length
+ * prompt on top and reports how long ducking takes to settle each way.
+ * Host cycle counts only rank kernels against each other; the device logs
+ * its own mixer cycles/frame with the audio stats.
+ * 
+ * Build and run from the repository root:
+ * 
+ *   g++ -std=gnu++17 -O2 -Icomponents/audio/include tools/mix_bench.cpp \
+ *       components/audio/mixer.cpp components/audio/tone_generator.cpp -o mix_bench
+ *   ./mix_bench
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "mixer.h"
+#include "tone_generator.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+using namespace Audio;
+
+namespace {
+
+// Mirrors AUDIO_* in device_config.h
+constexpr uint32_t SAMPLE_RATE = 44100;
+constexpr size_t CHUNK_FRAMES = 256;        // AudioPlayer::CHUNK_BYTES of stereo
+constexpr int ROUNDS = 200;
+
+uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+const char* unit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
+
+std::vector<int16_t> noise(size_t samples, double amplitude, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(-amplitude, amplitude);
+    std::vector<int16_t> out(samples);
+    for (auto& sample : out) {
+        sample = (int16_t)uniform(rng);
+    }
+    return out;
+}
+
+double referenceGain(int32_t from, int32_t to, size_t frame, size_t frames) {
+    return (from + (double)(to - from) * frame / frames) / Mix::UNITY;
+}
+
+int16_t clamp(double value) {
+    return (int16_t)std::max(-32768.0, std::min(32767.0, std::round(value)));
+}
+
+/**
+ * @brief Largest deviation from the reference, in LSB
+ */
+int checkScale(uint8_t channels, int32_t from, int32_t to, double amplitude) {
+    std::vector<int16_t> in = noise(CHUNK_FRAMES * channels, amplitude, 1);
+    std::vector<int16_t> out = in;
+    Mix::scale(out.data(), CHUNK_FRAMES, channels, from, to);
+    int worst = 0;
+    for (size_t i = 0; i < out.size(); i++) {
+        double expected = in[i] * referenceGain(from, to, i / channels, CHUNK_FRAMES);
+        worst = std::max(worst, std::abs(out[i] - clamp(expected)));
+    }
+    return worst;
+}
+
+int checkMix(uint8_t dst_channels, uint8_t src_channels, int32_t from, int32_t to, double amplitude) {
+    std::vector<int16_t> dst = noise(CHUNK_FRAMES * dst_channels, amplitude, 2);
+    std::vector<int16_t> src = noise(CHUNK_FRAMES * src_channels, amplitude, 3);
+    std::vector<int16_t> out = dst;
+    Mix::mixInto(out.data(), dst_channels, src.data(), src_channels, CHUNK_FRAMES, from, to);
+    int worst = 0;
+    for (size_t i = 0; i < out.size(); i++) {
+        size_t frame = i / dst_channels;
+        size_t c = i % dst_channels;
+        double added = src[frame * src_channels + (c < src_channels ? c : 0)] *
+                       referenceGain(from, to, frame, CHUNK_FRAMES);
+        worst = std::max(worst, std::abs(out[i] - clamp(dst[i] + added)));
+    }
+    return worst;
+}
+
+void correctness() {
+    const int32_t half = Mix::dbToGain(-6);
+    bool ok = true;
+    struct Case {
+        const char* name;
+        int worst;
+    } cases[] = {
+        {"scale flat -6 dB stereo",     checkScale(2, half, half, 32767)},
+        {"scale ramp 0..-6 dB stereo",  checkScale(2, Mix::UNITY, half, 32767)},
+        {"scale ramp mute..0 dB mono",  checkScale(1, 0, Mix::UNITY, 32767)},
+        {"mix unity stereo (clipping)", checkMix(2, 2, Mix::UNITY, Mix::UNITY, 32767)},
+        {"mix ramp mono into stereo",   checkMix(2, 1, half, Mix::UNITY, 32767)},
+        {"mix flat stereo into mono",   checkMix(1, 2, half, half, 20000)},
+    };
+    printf("correctness against double precision (max error in LSB):\n");
+    for (const auto& c : cases) {
+        printf("  %-30s %d\n", c.name, c.worst);
+        ok = ok && c.worst <= 1;
+    }
+    printf("  %s\n\n", ok ? "ok" : "FAILED");
+    if (!ok) {
+        exit(1);
+    }
+}
+
+template <typename Kernel>
+double timePerSample(size_t samples, Kernel kernel) {
+    uint64_t best = UINT64_MAX;
+    for (int round = 0; round < ROUNDS; round++) {
+        uint64_t start = now();
+        kernel();
+        best = std::min(best, now() - start);
+    }
+    return (double)best / samples;
+}
+
+void speed() {
+    const int32_t half = Mix::dbToGain(-6);
+    std::vector<int16_t> chunk = noise(CHUNK_FRAMES * 2, 12000, 4);
+    std::vector<int16_t> mono = noise(CHUNK_FRAMES, 12000, 5);
+    std::vector<int16_t> stereo = noise(CHUNK_FRAMES * 2, 12000, 6);
+    volatile int16_t sink = 0;
+    size_t samples = CHUNK_FRAMES * 2;
+
+    printf("cost per output sample (%zu-frame stereo chunks, best of %d):\n", CHUNK_FRAMES, ROUNDS);
+    printf("  %-30s %6.2f %s\n", "scale flat", timePerSample(samples, [&] {
+        Mix::scale(chunk.data(), CHUNK_FRAMES, 2, half, half);
+        sink = sink + chunk[0];
+    }), unit());
+    printf("  %-30s %6.2f %s\n", "scale ramp", timePerSample(samples, [&] {
+        Mix::scale(chunk.data(), CHUNK_FRAMES, 2, half, Mix::UNITY);
+        sink = sink + chunk[0];
+    }), unit());
+    printf("  %-30s %6.2f %s\n", "mix stereo, unity", timePerSample(samples, [&] {
+        Mix::mixInto(chunk.data(), 2, stereo.data(), 2, CHUNK_FRAMES, Mix::UNITY, Mix::UNITY);
+        sink = sink + chunk[0];
+    }), unit());
+    printf("  %-30s %6.2f %s\n", "mix stereo, ramp", timePerSample(samples, [&] {
+        Mix::mixInto(chunk.data(), 2, stereo.data(), 2, CHUNK_FRAMES, half, Mix::UNITY);
+        sink = sink + chunk[0];
+    }), unit());
+    printf("  %-30s %6.2f %s\n", "mix mono into stereo, ramp", timePerSample(samples, [&] {
+        Mix::mixInto(chunk.data(), 2, mono.data(), 1, CHUNK_FRAMES, half, Mix::UNITY);
+        sink = sink + chunk[0];
+    }), unit());
+
+    ToneGenerator tone;
+    std::vector<int16_t> rendered(CHUNK_FRAMES);
+    printf("  %-30s %6.2f %s per frame\n\n", "tone render", timePerSample(CHUNK_FRAMES, [&] {
+        if (!tone.isActive()) {
+            tone.start(1000, 60000, SAMPLE_RATE);
+        }
+        tone.render(rendered.data(), CHUNK_FRAMES);
+        sink = sink + rendered[0];
+    }), unit());
+}
+
+/**
+ * @brief Stream level per chunk around a prompt, as the player drives it
+ */
+void ducking() {
+    Mixer mixer;
+    Mixer::Config config = {
+        .sample_rate = SAMPLE_RATE,
+        .channels = 2,
+        .gain_db = {0, 0, -6},
+        .duck_db = -14,
+        .duck_attack_ms = 30,
+        .duck_release_ms = 300,
+        .volume_steps = 16,
+        .volume_step_db = 3,
+        .volume = 16
+    };
+    if (!mixer.configure(config)) {
+        fprintf(stderr, "mixer configuration rejected\n");
+        exit(1);
+    }
+
+    // A DC stream makes the applied gain readable from the output
+    const double chunk_ms = 1000.0 * CHUNK_FRAMES / SAMPLE_RATE;
+    const size_t prompt_start = 20;
+    const size_t prompt_end = prompt_start + (size_t)(500 / chunk_ms);
+    const int32_t floor = Mix::dbToGain(config.duck_db);
+    double ducked_ms = -1;
+    double released_ms = -1;
+    std::vector<int16_t> chunk(CHUNK_FRAMES * 2);
+    for (size_t n = 0; n < prompt_end + 100; n++) {
+        std::fill(chunk.begin(), chunk.end(), (int16_t)16384);
+        bool prompt = n >= prompt_start && n < prompt_end;
+        mixer.beginChunk(CHUNK_FRAMES, prompt);
+        mixer.scale(Mixer::Source::STREAM, chunk.data());
+        int32_t gain = chunk.back() * 2;
+        if (prompt && ducked_ms < 0 && std::abs(gain - floor) <= 2) {
+            ducked_ms = (n + 1 - prompt_start) * chunk_ms;
+        }
+        if (n >= prompt_end && released_ms < 0 && gain >= Mix::UNITY - 2) {
+            released_ms = (n + 1 - prompt_end) * chunk_ms;
+        }
+    }
+    printf("ducking to %d dB: down in %.1f ms (attack %u ms), back in %.1f ms (release %u ms)\n",
+           config.duck_db, ducked_ms, config.duck_attack_ms, released_ms, config.duck_release_ms);
+
+    // The volume table: each step config.volume_step_db apart
+    printf("volume steps:");
+    for (int step = 0; step <= config.volume_steps; step += 4) {
+        mixer.setVolume(step);
+        mixer.beginChunk(CHUNK_FRAMES, false);
+        mixer.beginChunk(CHUNK_FRAMES, false);
+        std::fill(chunk.begin(), chunk.end(), (int16_t)16384);
+        mixer.scale(Mixer::Source::STREAM, chunk.data());
+        double db = chunk.back() > 0 ? 20.0 * std::log10(chunk.back() / 16384.0) : -INFINITY;
+        printf("  %d: %.1f dB", step, db);
+    }
+    printf("\n");
+}
+
+} // namespace
+
+int main() {
+    correctness();
+    speed();
+    ducking();
+    return 0;
+}
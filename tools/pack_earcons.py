@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+"""
+Pack short WAV clips into an earcon image for the earcons flash partition.
+
+Each clip is mixed to mono (unless --stereo), resampled to the output rate
+and stored as IMA-ADPCM (default) or PCM16; the layout is described in
+components/audio/include/earcon_index.h. Clip ids are given on the command
+line as id=path.
+
+  ./tools/pack_earcons.py -o earcons.bin 1=beep.wav 2=confirm.wav 10=error.wav
+  parttool.py write_partition --partition-name earcons --input earcons.bin
+
+Check an image with tools/earcon_check.cpp, or list it with --list.
+"""
+
+import argparse
+import struct
+import sys
+import wave
+
+MAGIC = b"ERCN"
+VERSION = 1
+HEADER_SIZE = 16
+ENTRY_SIZE = 24
+MAX_BLOCK_FRAMES = 512
+PARTITION_SIZE = 0x40000
+
+CODEC_PCM16 = 0
+CODEC_IMA_ADPCM = 1
+CODEC_NAMES = {CODEC_PCM16: "pcm16", CODEC_IMA_ADPCM: "ima-adpcm"}
+
+STEP_TABLE = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+]
+INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8] * 2
+
+
+def clamp16(value):
+    return max(-32768, min(32767, value))
+
+
+class AdpcmState:
+    """Encoder state of one channel, mirrors Audio::ImaAdpcm::State."""
+
+    def __init__(self, predictor=0):
+        self.predictor = predictor
+        self.step_index = 0
+
+    def quantize(self, sample):
+        diff = sample - self.predictor
+        nibble = 0
+        if diff < 0:
+            nibble = 8
+            diff = -diff
+        step = STEP_TABLE[self.step_index]
+        if diff >= step:
+            nibble |= 4
+            diff -= step
+        step >>= 1
+        if diff >= step:
+            nibble |= 2
+            diff -= step
+        step >>= 1
+        if diff >= step:
+            nibble |= 1
+
+        # Reconstruct exactly as the decoder will
+        step = STEP_TABLE[self.step_index]
+        delta = step >> 3
+        if nibble & 4:
+            delta += step
+        if nibble & 2:
+            delta += step >> 1
+        if nibble & 1:
+            delta += step >> 2
+        self.predictor = clamp16(self.predictor - delta if nibble & 8 else self.predictor + delta)
+        self.step_index = max(0, min(len(STEP_TABLE) - 1, self.step_index + INDEX_TABLE[nibble]))
+        return nibble
+
+
+def encode_block(frames, states):
+    """One audio_packet.h IMA-ADPCM payload from a list of per-frame tuples."""
+    channels = len(states)
+    out = bytearray()
+    for state in states:
+        out += struct.pack("<hBB", state.predictor, state.step_index, 0)
+    samples = [s for frame in frames for s in frame]
+    for i in range(0, len(samples), 2):
+        low = states[0].quantize(samples[i])
+        high = states[channels - 1].quantize(samples[i + 1])
+        out.append(low | (high << 4))
+    return bytes(out)
+
+
+def read_wav(path, rate, stereo):
+    with wave.open(path, "rb") as wav:
+        if wav.getsampwidth() != 2:
+            raise ValueError(f"{path}: only 16-bit PCM is supported")
+        source_channels = wav.getnchannels()
+        source_rate = wav.getframerate()
+        raw = wav.readframes(wav.getnframes())
+
+    count = len(raw) // (2 * source_channels)
+    samples = struct.unpack(f"<{count * source_channels}h", raw[:count * 2 * source_channels])
+    frames = [samples[i * source_channels:(i + 1) * source_channels] for i in range(count)]
+
+    channels = 2 if stereo else 1
+    if channels == 1:
+        frames = [(sum(f) // len(f),) for f in frames]
+    elif source_channels == 1:
+        frames = [(f[0], f[0]) for f in frames]
+    else:
+        frames = [(f[0], f[1]) for f in frames]
+
+    if source_rate != rate and frames:
+        # Linear interpolation is plenty for beeps and chimes
+        out_count = max(1, count * rate // source_rate)
+        resampled = []
+        for i in range(out_count):
+            position = i * source_rate / rate
+            j = int(position)
+            t = position - j
+            a = frames[min(j, count - 1)]
+            b = frames[min(j + 1, count - 1)]
+            resampled.append(tuple(clamp16(round(x + (y - x) * t)) for x, y in zip(a, b)))
+        frames = resampled
+    return frames, channels
+
+
+def encode_clip(frames, channels, codec, block_frames):
+    """Returns (data, frame count, block frames)."""
+    if codec == CODEC_PCM16:
+        data = struct.pack(f"<{len(frames) * channels}h", *[s for f in frames for s in f])
+        return data, len(frames), 0
+
+    if channels == 1 and len(frames) % 2:
+        frames = frames + [frames[-1]]
+    states = [AdpcmState(frames[0][c] if frames else 0) for c in range(channels)]
+    data = bytearray()
+    for start in range(0, len(frames), block_frames):
+        data += encode_block(frames[start:start + block_frames], states)
+    return bytes(data), len(frames), block_frames
+
+
+def pack(clips, codec, block_frames):
+    """clips: list of (id, frames, channels, rate), returns the image bytes."""
+    clips = sorted(clips, key=lambda clip: clip[0])
+    offset = HEADER_SIZE + ENTRY_SIZE * len(clips)
+    entries = bytearray()
+    blobs = bytearray()
+    for clip_id, frames, channels, rate in clips:
+        data, frame_count, blocks = encode_clip(frames, channels, codec, block_frames)
+        pad = (-(offset + len(blobs))) % 4
+        blobs += b"\0" * pad
+        entries += struct.pack("<HBBIIIIHH", clip_id, codec, channels, rate,
+                               offset + len(blobs), len(data), frame_count, blocks, 0)
+        blobs += data
+    size = offset + len(blobs)
+    header = MAGIC + struct.pack("<HHII", VERSION, len(clips), size, 0)
+    return header + bytes(entries) + bytes(blobs)
+
+
+def list_image(path):
+    with open(path, "rb") as f:
+        image = f.read()
+    if image[:4] != MAGIC:
+        sys.exit(f"{path}: not an earcon image")
+    version, count, size, _ = struct.unpack_from("<HHII", image, 4)
+    print(f"{path}: version {version}, {count} clips, {size} bytes")
+    for i in range(count):
+        clip_id, codec, channels, rate, offset, length, frames, blocks, _ = \
+            struct.unpack_from("<HBBIIIIHH", image, HEADER_SIZE + i * ENTRY_SIZE)
+        print(f"  {clip_id:5d}  {CODEC_NAMES.get(codec, codec):9s} {channels} ch {rate:6d} Hz "
+              f"{frames / rate * 1000:7.1f} ms  {length:6d} bytes at 0x{offset:05x}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("clips", nargs="*", help="id=path.wav")
+    parser.add_argument("-o", "--output", help="image to write")
+    parser.add_argument("--rate", type=int, default=44100, help="output rate (AUDIO_SAMPLE_RATE)")
+    parser.add_argument("--stereo", action="store_true", help="keep two channels")
+    parser.add_argument("--codec", choices=["ima-adpcm", "pcm16"], default="ima-adpcm")
+    parser.add_argument("--block-frames", type=int, default=256)
+    parser.add_argument("--list", metavar="IMAGE", help="describe an existing image")
+    args = parser.parse_args()
+
+    if args.list:
+        list_image(args.list)
+        return
+    if not args.output or not args.clips:
+        parser.error("need -o and at least one id=path.wav")
+    if not 0 < args.block_frames <= MAX_BLOCK_FRAMES or args.block_frames % 2:
+        parser.error(f"--block-frames must be even and at most {MAX_BLOCK_FRAMES}")
+
+    clips = []
+    seen = set()
+    for spec in args.clips:
+        clip_id, _, path = spec.partition("=")
+        if not path or not clip_id.isdigit() or int(clip_id) > 0xFFFF:
+            parser.error(f"bad clip '{spec}', expected id=path.wav")
+        if int(clip_id) in seen:
+            parser.error(f"duplicate clip id {clip_id}")
+        seen.add(int(clip_id))
+        frames, channels = read_wav(path, args.rate, args.stereo)
+        if not frames:
+            parser.error(f"{path} is empty")
+        clips.append((int(clip_id), frames, channels, args.rate))
+
+    codec = CODEC_IMA_ADPCM if args.codec == "ima-adpcm" else CODEC_PCM16
+    image = pack(clips, codec, args.block_frames)
+    if len(image) > PARTITION_SIZE:
+        sys.exit(f"image is {len(image)} bytes, the partition holds {PARTITION_SIZE}")
+    with open(args.output, "wb") as f:
+        f.write(image)
+    list_image(args.output)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,470 @@
+/**
+ * @file resample_bench.cpp
+ * @brief Host-side accuracy, cost and drift benchmark for Audio::Resampler
+ * 
+ * Accuracy: converts sine references between the rates a stream may use
+ * and the output rate, in uneven blocks as the player feeds it, and
+ * compares the result with the ideal sine at the output rate (SNR, which
+ * counts images and aliases as error). Tones above the lower Nyquist rate
+ * show the alias rejection. Untrimmed equal rates must copy bit-exact.
+ * 
+ * Cost: time per output frame for each conversion. Host cycle counts only
+ * rank configurations; the device logs its own resampler cycles/frame.
+ * 
+ * Drift: plays a jittery network stream whose sender clock is off by a
+ * few hundred ppm through the real JitterBuffer, with the resampler
+ * trimmed by a DriftController as the player does, and reports the trim
+ * it settles on, how long that takes, and the underruns and trims the
+ * jitter buffer needed with and without the controller.
+ * 
+ * Build and run from the repository root:
+ * 
+ *   g++ -std=gnu++17 -O2 -Icomponents/audio/include tools/resample_bench.cpp \
+ *       components/audio/resampler.cpp components/audio/drift_controller.cpp \
+ *       components/audio/jitter_buffer.cpp -o resample_bench
+ *   ./resample_bench
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "drift_controller.h"
+#include "jitter_buffer.h"
+#include "resampler.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+using namespace Audio;
+
+namespace {
+
+// Mirrors AUDIO_* in device_config.h
+constexpr uint32_t OUT_RATE = 44100;
+constexpr size_t CHUNK_FRAMES = 256;        // AudioPlayer::CHUNK_BYTES of stereo
+constexpr int ROUNDS = 50;
+constexpr double AMPLITUDE = 16384.0;       // -6 dBFS
+
+uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+const char* unit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
+
+std::vector<int16_t> sine(double hz, uint32_t rate, size_t frames, uint8_t channels) {
+    std::vector<int16_t> out(frames * channels);
+    for (size_t i = 0; i < frames; i++) {
+        int16_t sample = (int16_t)std::lround(AMPLITUDE * std::sin(2.0 * M_PI * hz * i / rate));
+        for (uint8_t c = 0; c < channels; c++) {
+            out[i * channels + c] = sample;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Run a whole signal through, offered in uneven packets and taken
+ *        in output chunks, the way the player's fill loop does
+ */
+std::vector<int16_t> convert(Resampler& resampler, const std::vector<int16_t>& in, uint8_t in_channels,
+                             uint8_t out_channels, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> packet_frames(1, 700);
+    size_t in_frames = in.size() / in_channels;
+    std::vector<int16_t> out;
+    std::vector<int16_t> chunk(CHUNK_FRAMES * out_channels);
+    
+    size_t pos = 0;
+    size_t packet_end = 0;
+    size_t used = 0;
+    while (true) {
+        if (pos == packet_end) {
+            if (pos == in_frames) {
+                break;
+            }
+            packet_end = std::min(in_frames, pos + packet_frames(rng));
+        }
+        size_t consumed = 0;
+        size_t produced = resampler.process(in.data() + pos * in_channels, packet_end - pos, consumed,
+                                            chunk.data() + used * out_channels, CHUNK_FRAMES - used);
+        pos += consumed;
+        used += produced;
+        if (used == CHUNK_FRAMES) {
+            out.insert(out.end(), chunk.begin(), chunk.end());
+            used = 0;
+        }
+    }
+    out.insert(out.end(), chunk.begin(), chunk.begin() + used * out_channels);
+    return out;
+}
+
+/**
+ * @brief Output against the ideal sine at the output rate, in dB
+ * 
+ * Output frame n is input time n * step, so the reference needs no delay.
+ * The first and last filter lengths are skipped.
+ */
+double snr(const std::vector<int16_t>& out, uint8_t channels, double hz, uint32_t in_rate, int32_t trim_ppm) {
+    double step = (double)in_rate / OUT_RATE * (1.0 + trim_ppm * 1e-6);
+    size_t frames = out.size() / channels;
+    double signal = 0.0;
+    double error = 0.0;
+    size_t skip = Resampler::TAPS * 4;
+    for (size_t n = skip; n + skip < frames; n++) {
+        double expected = AMPLITUDE * std::sin(2.0 * M_PI * hz * n * step / in_rate);
+        for (uint8_t c = 0; c < channels; c++) {
+            double diff = out[n * channels + c] - expected;
+            signal += expected * expected;
+            error += diff * diff;
+        }
+    }
+    return error > 0.0 ? 10.0 * std::log10(signal / error) : INFINITY;
+}
+
+/**
+ * @brief Output level of a tone relative to its input level, in dB
+ */
+double gain(const std::vector<int16_t>& out, uint8_t channels) {
+    size_t frames = out.size() / channels;
+    size_t skip = Resampler::TAPS * 4;
+    double power = 0.0;
+    size_t count = 0;
+    for (size_t n = skip; n + skip < frames; n++) {
+        power += (double)out[n * channels] * out[n * channels];
+        count++;
+    }
+    double rms = count > 0 ? std::sqrt(power / count) : 0.0;
+    return rms > 0.0 ? 20.0 * std::log10(rms / (AMPLITUDE / std::sqrt(2.0))) : -INFINITY;
+}
+
+struct Conversion {
+    const char* name;
+    uint32_t in_rate;
+    uint8_t in_channels;
+    uint8_t out_channels;
+    int32_t trim_ppm;
+};
+
+const Conversion CONVERSIONS[] = {
+    {"8000 mono -> 44100 stereo",   8000,  1, 2, 0},
+    {"16000 mono -> 44100 stereo",  16000, 1, 2, 0},
+    {"22050 stereo -> 44100",       22050, 2, 2, 0},
+    {"32000 stereo -> 44100",       32000, 2, 2, 0},
+    {"44100 stereo, +300 ppm",      44100, 2, 2, 300},
+    {"44100 stereo, -300 ppm",      44100, 2, 2, -300},
+    {"48000 stereo -> 44100",       48000, 2, 2, 0},
+    {"88200 stereo -> 44100",       88200, 2, 2, 0},
+};
+
+bool accuracy() {
+    bool ok = true;
+    
+    // Untrimmed equal rates go through untouched
+    {
+        Resampler resampler;
+        resampler.configure(OUT_RATE, OUT_RATE, 2, 2);
+        std::vector<int16_t> in(OUT_RATE * 2);
+        std::mt19937 rng(7);
+        for (auto& sample : in) {
+            sample = (int16_t)(rng() & 0xFFFF);
+        }
+        std::vector<int16_t> out = convert(resampler, in, 2, 2, 1);
+        size_t delay = (Resampler::TAPS / 2) * 2;
+        bool exact = out.size() + delay == in.size() &&
+                     std::equal(out.begin(), out.end(), in.begin());
+        printf("44100 -> 44100 untrimmed: %s (%zu frames held back)\n\n",
+               exact ? "bit-exact" : "NOT bit-exact", delay / 2);
+        ok = ok && exact;
+    }
+    
+    printf("SNR against the ideal sine (dB, images and aliases count as error):\n");
+    printf("  %-28s %8s %8s %8s %8s\n", "conversion", "100 Hz", "1 kHz", "0.2 fs", "0.35 fs");
+    for (const Conversion& conv : CONVERSIONS) {
+        // fs is the lower of the two rates
+        uint32_t low = std::min(conv.in_rate, OUT_RATE);
+        const double tones[] = {100.0, 1000.0, 0.2 * low, 0.35 * low};
+        printf("  %-28s", conv.name);
+        for (double hz : tones) {
+            Resampler resampler;
+            resampler.configure(conv.in_rate, OUT_RATE, conv.in_channels, conv.out_channels);
+            resampler.setTrimPpm(conv.trim_ppm);
+            std::vector<int16_t> in = sine(hz, conv.in_rate, conv.in_rate, conv.in_channels);
+            std::vector<int16_t> out = convert(resampler, in, conv.in_channels, conv.out_channels, 2);
+            double db = snr(out, conv.out_channels, hz, conv.in_rate, conv.trim_ppm);
+            printf(" %8.1f", db);
+            
+            // Speech and music live well inside 0.2 fs
+            if (hz <= 0.2 * low && db < 60.0) {
+                ok = false;
+            }
+        }
+        printf("\n");
+    }
+    
+    printf("\nresponse of a tone by fraction of the lower Nyquist rate (dB, downsampling):\n");
+    printf("  %-28s %8s %8s %8s %8s %8s\n", "conversion", "0.5", "0.8", "0.9", "1.2", "1.5");
+    const uint32_t down[] = {48000, 88200};
+    for (uint32_t in_rate : down) {
+        printf("  %-5lu -> %-19lu", (unsigned long)in_rate, (unsigned long)OUT_RATE);
+        const double fractions[] = {0.5, 0.8, 0.9, 1.2, 1.5};
+        for (double fraction : fractions) {
+            double hz = fraction * OUT_RATE / 2;
+            if (hz >= in_rate / 2.0) {
+                printf(" %8s", "-");
+                continue;
+            }
+            Resampler resampler;
+            resampler.configure(in_rate, OUT_RATE, 1, 1);
+            std::vector<int16_t> in = sine(hz, in_rate, in_rate, 1);
+            std::vector<int16_t> out = convert(resampler, in, 1, 1, 3);
+            printf(" %8.1f", gain(out, 1));
+        }
+        printf("\n");
+    }
+    
+    printf("  %s\n\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+void speed() {
+    printf("cost per output frame (%zu-frame chunks, best of %d):\n", CHUNK_FRAMES, ROUNDS);
+    for (const Conversion& conv : CONVERSIONS) {
+        Resampler resampler;
+        resampler.configure(conv.in_rate, OUT_RATE, conv.in_channels, conv.out_channels);
+        resampler.setTrimPpm(conv.trim_ppm);
+        std::vector<int16_t> in = sine(1000.0, conv.in_rate, conv.in_rate / 10, conv.in_channels);
+        std::vector<int16_t> out(CHUNK_FRAMES * conv.out_channels);
+        
+        uint64_t best = UINT64_MAX;
+        size_t pos = 0;
+        size_t in_frames = in.size() / conv.in_channels;
+        for (int round = 0; round < ROUNDS; round++) {
+            size_t produced = 0;
+            uint64_t start = now();
+            while (produced < CHUNK_FRAMES) {
+                if (pos == in_frames) {
+                    pos = 0;
+                }
+                size_t consumed = 0;
+                produced += resampler.process(in.data() + pos * conv.in_channels, in_frames - pos, consumed,
+                                              out.data() + produced * conv.out_channels, CHUNK_FRAMES - produced);
+                pos += consumed;
+            }
+            best = std::min(best, now() - start);
+        }
+        printf("  %-28s %7.1f %s\n", conv.name, (double)best / CHUNK_FRAMES, unit());
+    }
+    
+    Resampler copy;
+    copy.configure(OUT_RATE, OUT_RATE, 2, 2);
+    std::vector<int16_t> in = sine(1000.0, OUT_RATE, CHUNK_FRAMES * 8, 2);
+    std::vector<int16_t> out(CHUNK_FRAMES * 2);
+    uint64_t best = UINT64_MAX;
+    for (int round = 0; round < ROUNDS; round++) {
+        size_t consumed = 0;
+        uint64_t start = now();
+        copy.process(in.data(), CHUNK_FRAMES * 8, consumed, out.data(), CHUNK_FRAMES);
+        best = std::min(best, now() - start);
+        copy.reset();
+    }
+    printf("  %-28s %7.1f %s\n\n", "44100 stereo, untrimmed", (double)best / CHUNK_FRAMES, unit());
+}
+
+// Network stream for the drift simulation, as the server sends it
+constexpr uint32_t STREAM_RATE = 44100;
+constexpr uint32_t PACKET_MS = 10;
+constexpr uint32_t PACKET_FRAMES = STREAM_RATE * PACKET_MS / 1000;
+static_assert(PACKET_FRAMES * sizeof(int16_t) <= JitterBuffer::MAX_PAYLOAD, "packet too large");
+
+struct DriftResult {
+    double settled_ppm;         // Mean trim over the last minute
+    double settle_s;            // Until the trim stays within 10% of the offset
+    double excess_ms;           // Mean buffered audio over the target, last minute
+    uint32_t underruns;
+    uint32_t trimmed;
+    uint32_t lost;
+};
+
+/**
+ * @brief Play duration_s of a stream whose sender runs offset_ppm fast
+ * 
+ * Mirrors AudioPlayer: the output pulls CHUNK_FRAMES at a time on the
+ * I2S clock, the resampler pulls packets from the jitter buffer, and each
+ * packet taken feeds the drift controller.
+ */
+DriftResult simulateDrift(double offset_ppm, const DriftController::Config& drift_config,
+                          double jitter_ms, uint32_t duration_s, uint32_t seed) {
+    std::vector<uint8_t> storage(JitterBuffer::storageSize() + 4);
+    void* aligned = reinterpret_cast<void*>((reinterpret_cast<uintptr_t>(storage.data()) + 3) & ~(uintptr_t)3);
+    JitterBuffer jitter;
+    JitterBuffer::Config jitter_config = {40, 200, 3, 2};   // AUDIO_PREBUFFER_MS etc.
+    jitter.attach(aligned, jitter_config);
+    
+    Resampler resampler;
+    resampler.configure(STREAM_RATE, OUT_RATE, 1, 1);
+    DriftController drift;
+    drift.configure(drift_config);
+    
+    std::mt19937 rng(seed);
+    std::exponential_distribution<double> queueing(1.0 / jitter_ms);
+    
+    // Sender: packet k leaves at k packet durations of its own clock,
+    // which runs offset_ppm fast against the output's
+    const double send_period_us = PACKET_MS * 1000.0 / (1.0 + offset_ppm * 1e-6);
+    const double chunk_us = CHUNK_FRAMES * 1e6 / OUT_RATE;
+    const uint32_t chunks = (uint32_t)(duration_s * 1e6 / chunk_us);
+    
+    std::vector<int16_t> payload(PACKET_FRAMES, 1000);
+    std::vector<int16_t> chunk(CHUNK_FRAMES);
+    uint8_t packet_data[JitterBuffer::MAX_PAYLOAD];
+    size_t packet_len = 0;
+    size_t packet_pos = 0;
+    
+    uint32_t next_send = 0;
+    double next_arrival_us = 5000.0 + queueing(rng);
+    int64_t last_pop_us = 0;
+    int32_t excess_us = 0;
+    double ppm_sum = 0.0;
+    double excess_sum = 0.0;
+    uint32_t tail_samples = 0;
+    double settle_s = -1.0;
+    DriftResult result = {};
+    
+    for (uint32_t n = 0; n < chunks; n++) {
+        int64_t chunk_time_us = (int64_t)(n * chunk_us);
+        
+        // Arrivals up to now, in order (jitter reorders nothing here)
+        while (next_arrival_us <= chunk_time_us) {
+            PacketInfo packet = {};
+            packet.seq = (uint16_t)next_send;
+            packet.timestamp = next_send * PACKET_FRAMES;
+            packet.codec = Codec::PCM16;
+            packet.channels = 1;
+            packet.sample_rate = STREAM_RATE;
+            packet.payload = reinterpret_cast<const uint8_t*>(payload.data());
+            packet.payload_len = PACKET_FRAMES * sizeof(int16_t);
+            jitter.push(packet, (int64_t)next_arrival_us);
+            next_send++;
+            double send_us = next_send * send_period_us;
+            next_arrival_us = std::max(next_arrival_us, send_us + 5000.0 + queueing(rng));
+        }
+        
+        size_t used = 0;
+        while (used < CHUNK_FRAMES) {
+            if (packet_pos < packet_len) {
+                size_t consumed = 0;
+                used += resampler.process(reinterpret_cast<const int16_t*>(packet_data) + packet_pos,
+                                          packet_len - packet_pos, consumed, chunk.data() + used,
+                                          CHUNK_FRAMES - used);
+                packet_pos += consumed;
+                continue;
+            }
+            
+            PacketInfo popped;
+            JitterBuffer::PopResult result_code = jitter.pop(packet_data, popped, false);
+            if (result_code == JitterBuffer::PopResult::PACKET) {
+                int64_t pop_us = chunk_time_us + (int64_t)(used * 1e6 / OUT_RATE);
+                uint32_t interval_us = last_pop_us != 0 ? (uint32_t)(pop_us - last_pop_us) : jitter.packetUs();
+                last_pop_us = pop_us;
+                int32_t excess = (int32_t)jitter.depth() + 1 - (int32_t)jitter.target();
+                excess_us = excess * (int32_t)jitter.packetUs();
+                resampler.setTrimPpm(drift.update(excess_us, interval_us));
+                packet_len = popped.payload_len / sizeof(int16_t);
+                packet_pos = 0;
+                continue;
+            }
+            if (result_code == JitterBuffer::PopResult::TRIM) {
+                // The player keeps only a crossfade's worth of a surplus packet
+                continue;
+            }
+            if (result_code == JitterBuffer::PopResult::LOST) {
+                packet_len = PACKET_FRAMES;
+                packet_pos = 0;
+                memset(packet_data, 0, packet_len * sizeof(int16_t));
+                continue;
+            }
+            if (result_code == JitterBuffer::PopResult::UNDERRUN) {
+                resampler.reset();
+                drift.restart();
+                last_pop_us = 0;
+            }
+            break;
+        }
+        
+        double t = n * chunk_us / 1e6;
+        double ppm = resampler.getTrimPpm();
+        if (std::fabs(ppm - offset_ppm) > 0.1 * std::fabs(offset_ppm) + 5.0) {
+            settle_s = -1.0;
+        } else if (settle_s < 0.0) {
+            settle_s = t;
+        }
+        if (t >= duration_s - 60.0) {
+            ppm_sum += ppm;
+            excess_sum += excess_us / 1000.0;
+            tail_samples++;
+        }
+    }
+    
+    JitterBuffer::Stats stats = jitter.getStats();
+    result.settled_ppm = tail_samples ? ppm_sum / tail_samples : 0.0;
+    result.settle_s = settle_s;
+    result.excess_ms = tail_samples ? excess_sum / tail_samples : 0.0;
+    result.underruns = stats.underruns;
+    result.trimmed = stats.trimmed;
+    result.lost = stats.lost;
+    return result;
+}
+
+void driftScenarios() {
+    // Mirrors AUDIO_DRIFT_* in device_config.h
+    const DriftController::Config enabled = {500, 30, 2000};
+    const DriftController::Config disabled = {0, 30, 2000};
+    const uint32_t duration_s = 600;
+    
+    printf("clock drift, %u s of %u ms packets, 2 ms mean jitter:\n", duration_s, PACKET_MS);
+    printf("  %-10s %-9s %10s %10s %10s %9s %8s %6s\n",
+           "offset", "trim", "settled", "settle", "excess", "underrun", "trimmed", "lost");
+    const double offsets[] = {-300.0, -100.0, 0.0, 100.0, 300.0};
+    for (double offset : offsets) {
+        for (const DriftController::Config* config : {&disabled, &enabled}) {
+            DriftResult r = simulateDrift(offset, *config, 2.0, duration_s, 11);
+            char settle[16];
+            if (config->max_ppm == 0) {
+                snprintf(settle, sizeof(settle), "-");
+            } else if (r.settle_s < 0.0) {
+                snprintf(settle, sizeof(settle), "never");
+            } else {
+                snprintf(settle, sizeof(settle), "%.0f s", r.settle_s);
+            }
+            printf("  %+6.0f ppm %-9s %6.0f ppm %10s %7.1f ms %9u %8u %6u\n",
+                   offset, config->max_ppm == 0 ? "off" : "on",
+                   r.settled_ppm, settle, r.excess_ms, r.underruns, r.trimmed, r.lost);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    bool ok = accuracy();
+    speed();
+    driftScenarios();
+    return ok ? 0 : 1;
+}
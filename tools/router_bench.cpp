@@ -0,0 +1,267 @@
+/**
+ * @file router_bench.cpp
+ * @brief Host-side benchmark for inbound topic routing
+ *
+ * Checks TopicRouter::intern() against TOPIC_TABLE: every listed topic
+ * maps to its TopicId, including from a copy of the string as the AVI core
+ * hands it over. Near misses (prefixes, one character off, a trailing
+ * byte) map to UNKNOWN. It then times a mix of inbound messages through:
+ * - intern() alone;
+ * - TopicRouter::dispatch() to the registered features;
+ * - the routing it replaced, where each feature copied the topic and
+ *   payload into std::strings and compared them against its own topics.
+ * It reports the time and heap allocations per message for each.
+ *
+ * The router only needs feature.h, device_config.h and esp_log.h, all of
+ * which build against tools/host_shims/. The device logs the lookup's
+ * cycles per message with the router stats; host timings only rank the
+ * paths against each other.
+ *
+ * Build and run from the repository root:
+ *
+ *   g++ -std=gnu++17 -O2 -Itools/host_shims -Imain -Icomponents/device_features/include \
+ *       tools/router_bench.cpp components/device_features/topic_router.cpp -o router_bench
+ *   ./router_bench
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include "feature.h"
+#include "topic_router.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+using namespace Features;
+
+namespace {
+
+constexpr int ROUNDS = 20000;
+
+uint64_t g_allocations = 0;
+
+uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+const char* unit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
+
+/**
+ * @brief Registers for a set of topics and counts what reaches it
+ */
+class BenchFeature : public Feature {
+public:
+    BenchFeature(const char* name, std::vector<TopicId> topics)
+        : m_name(name)
+        , m_topics(std::move(topics)) {
+    }
+
+    bool init() override { return true; }
+    bool start() override { return true; }
+    void update() override {}
+    void stop() override {}
+    const char* getName() const override { return m_name; }
+
+    void registerTopics(TopicRouter& router) override {
+        for (TopicId topic : m_topics) {
+            router.registerHandler(topic, this);
+        }
+    }
+
+    void handleMessage(TopicId topic, const uint8_t* data, size_t data_len) override {
+        m_messages++;
+        m_checksum += static_cast<uint32_t>(topic) + data[0] + data_len;
+    }
+
+    /**
+     * @brief The routing TopicRouter replaced: copy, then compare strings
+     */
+    void handleStrings(const char* topic, size_t topic_len, const uint8_t* data, size_t data_len) {
+        if (data_len == 0) {
+            return;
+        }
+        std::string topic_str(topic, topic_len);
+        std::string payload(reinterpret_cast<const char*>(data), data_len);
+        for (TopicId id : m_topics) {
+            if (topic_str == TopicRouter::name(id)) {
+                m_messages++;
+                m_checksum += static_cast<uint32_t>(id) + static_cast<uint8_t>(payload[0]) + payload.size();
+                return;
+            }
+        }
+    }
+
+    uint64_t m_messages = 0;
+    uint64_t m_checksum = 0;
+
+private:
+    const char* m_name;
+    std::vector<TopicId> m_topics;
+};
+
+/**
+ * @brief One inbound message, its topic in a buffer of its own
+ */
+struct Message {
+    std::vector<char> topic;
+    std::vector<uint8_t> payload;
+};
+
+Message message(const char* topic, size_t payload_len) {
+    Message msg;
+    msg.topic.assign(topic, topic + strlen(topic));
+    msg.payload.assign(payload_len, 0x5A);
+    return msg;
+}
+
+bool correctness() {
+    bool ok = true;
+    for (const TopicEntry& entry : TOPIC_TABLE) {
+        std::string copy(entry.name);
+        TopicId id = TopicRouter::intern(copy.data(), copy.size());
+        if (id != entry.id) {
+            printf("FAIL: %s interned as %u\n", entry.name, (unsigned)id);
+            ok = false;
+        }
+
+        std::vector<std::string> misses = {
+            copy.substr(0, copy.size() - 1),
+            copy + "/",
+            copy + std::string(1, '\0'),
+        };
+        std::string changed = copy;
+        changed.back() ^= 0x01;
+        misses.push_back(changed);
+        for (const std::string& miss : misses) {
+            if (TopicRouter::intern(miss.data(), miss.size()) != TopicId::UNKNOWN) {
+                printf("FAIL: near miss of %s was interned\n", entry.name);
+                ok = false;
+            }
+        }
+    }
+    if (TopicRouter::intern("", 0) != TopicId::UNKNOWN) {
+        printf("FAIL: empty topic was interned\n");
+        ok = false;
+    }
+    printf("intern(): %zu topics and their near misses %s\n\n",
+           sizeof(TOPIC_TABLE) / sizeof(TOPIC_TABLE[0]), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+template <typename Fn>
+void time(const char* name, size_t messages, Fn&& fn) {
+    uint64_t best = UINT64_MAX;
+    uint64_t allocations = g_allocations;
+    for (int round = 0; round < ROUNDS; round++) {
+        uint64_t start = now();
+        fn();
+        uint64_t elapsed = now() - start;
+        if (elapsed < best) {
+            best = elapsed;
+        }
+    }
+    printf("%-26s %8.1f %s/msg %8.2f allocs/msg\n", name, (double)best / messages, unit(),
+           (double)(g_allocations - allocations) / ((double)ROUNDS * messages));
+}
+
+void routing() {
+    BenchFeature led("LED", {TopicId::LED_CONTROL, TopicId::LED_ANIMATION, TopicId::LED_CLEAR});
+    BenchFeature audio("Audio", {TopicId::AUDIO_DATA, TopicId::AUDIO_EARCON, TopicId::AUDIO_TONE});
+    BenchFeature* features[] = {&led, &audio};
+
+    TopicRouter router;
+    for (BenchFeature* feature : features) {
+        feature->registerTopics(router);
+    }
+
+    // Mostly audio, as while a stream plays, then LED updates, prompts and
+    // topics the device has no handler for
+    std::vector<Message> mix;
+    for (int i = 0; i < 10; i++) {
+        mix.push_back(message(TOPIC_AUDIO_DATA, 16 + 256));
+    }
+    for (int i = 0; i < 4; i++) {
+        mix.push_back(message(TOPIC_LED_CONTROL, 12));
+    }
+    mix.push_back(message(TOPIC_LED_ANIMATION, 24));
+    mix.push_back(message(TOPIC_AUDIO_EARCON, 1));
+    mix.push_back(message(TOPIC_AUDIO_TONE, 8));
+    mix.push_back(message(TOPIC_COMMAND, 16));
+    mix.push_back(message(TOPIC_HEARTBEAT, 8));
+    mix.push_back(message("device/led/controls", 12));
+
+    printf("%zu messages per round: 10 audio data, 7 LED and prompt, 1 unhandled, 2 unknown\n",
+           mix.size());
+
+    volatile uint32_t sink = 0;
+    time("intern()", mix.size(), [&]() {
+        for (const Message& msg : mix) {
+            sink = sink + static_cast<uint32_t>(TopicRouter::intern(msg.topic.data(), msg.topic.size()));
+        }
+    });
+    time("TopicRouter::dispatch()", mix.size(), [&]() {
+        for (const Message& msg : mix) {
+            router.dispatch(msg.topic.data(), msg.topic.size(), msg.payload.data(), msg.payload.size());
+        }
+    });
+    uint64_t routed = led.m_messages + audio.m_messages;
+    time("string compare per feature", mix.size(), [&]() {
+        for (const Message& msg : mix) {
+            for (BenchFeature* feature : features) {
+                feature->handleStrings(msg.topic.data(), msg.topic.size(),
+                                       msg.payload.data(), msg.payload.size());
+            }
+        }
+    });
+
+    // Both paths must deliver the same messages
+    uint64_t compared = led.m_messages + audio.m_messages - routed;
+    const TopicRouter::Stats& stats = router.getStats();
+    printf("\nrouter: %u dispatched, %u unhandled, %u unknown; string path delivered %s\n",
+           stats.dispatched, stats.unhandled, stats.unknown,
+           compared == routed ? "the same" : "a different count");
+}
+
+} // namespace
+
+// Every heap allocation on the routing paths is counted
+
+void* operator new(size_t size) {
+    g_allocations++;
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+int main() {
+    bool ok = correctness();
+    routing();
+    return ok ? 0 : 1;
+}
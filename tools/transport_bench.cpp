@@ -0,0 +1,525 @@
+/**
+ * @file transport_bench.cpp
+ * @brief Host-side run of AviClient and the transport against tools/avi_peer_stub.py
+ *
+ * Runs main/avi_client.cpp over either transport the firmware has:
+ * - UdpTransport (avi_transport.cpp, the default), built against the
+ *   declarations in tools/host_shims/. This file provides the FreeRTOS
+ *   tasks (threads), queues and task notifications, the clock, and a link
+ *   of --link-kbps behind lwip_sendto(). The link blocks the send task for
+ *   each datagram's time on the air, as a busy Wi-Fi driver would. Wi-Fi,
+ *   NVS and the event loop are never brought up.
+ * - PosixUdpTransport (--posix), the plain-socket build. Its sends are
+ *   synchronous and go straight to the socket, so --link-kbps does not
+ *   apply.
+ *
+ * The AVI core library only exists for the Xtensa target, so the core is
+ * stubbed here as a pass-through: avi_embedded_publish() sends the payload
+ * as one datagram and avi_embedded_poll() hands one received datagram to
+ * the message callback. There is no protocol framing or session.
+ *
+ * The network task (the calling thread) publishes a small CONTROL ping
+ * every --ping-ms and drains echoes with AviClient::poll(). On the device
+ * everything goes out from that one task. The run repeats while the same
+ * task also publishes BULK datagrams at --bulk-kbps. The stub echoes both.
+ * Reported per run:
+ * - the pings' round-trip time;
+ * - their queue-to-wire time in the transport;
+ * - what each class lost to a full TX pool;
+ * - the bulk throughput that made it back.
+ *
+ * With --burst N the bench instead sends one datagram to
+ * `avi_peer_stub.py burst`, which answers with N datagrams at once, and
+ * drains them the way the network task does: wait for activity, then
+ * AviClient::poll(). Each datagram costs the core --cost-us of CPU. It
+ * reports how many arrived, the poll counters (drained per poll, receive
+ * backlog at poll entry, budget hits) and how long the drain took.
+ *
+ * Build and run from the repository root:
+ *
+ *   g++ -std=gnu++17 -O2 -pthread -Itools/host_shims -Imain -Icomponents/avi_embedded/include \
+ *       -Icomponents/avi_transport/include -Icomponents/lockfree/include \
+ *       tools/transport_bench.cpp main/avi_client.cpp components/avi_transport/avi_transport.cpp \
+ *       components/avi_transport/posix_udp_transport.cpp -o transport_bench
+ *   ./tools/avi_peer_stub.py echo &
+ *   ./transport_bench                          # 2 Mbit/s link, 3 Mbit/s of bulk offered
+ *   ./transport_bench --link-kbps 1000 --bulk-kbps 800
+ *   ./transport_bench --posix
+ *
+ *   ./tools/avi_peer_stub.py burst --count 500 --size 512 --gap-us 100 &
+ *   ./transport_bench --burst 500 --cost-us 300
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "avi_client.h"
+#include "avi_embedded.h"
+#include "avi_transport.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "posix_udp_transport.h"
+
+namespace {
+
+struct Options {
+    const char* server = "127.0.0.1";
+    uint16_t port = 8888;
+    uint32_t link_kbps = 2000;
+    uint32_t bulk_kbps = 3000;
+    uint32_t bulk_size = 1024;
+    uint32_t ping_ms = 20;
+    uint32_t ping_size = 64;
+    uint32_t seconds = 5;
+    bool posix = false;
+    uint32_t burst = 0;         // Datagrams the stub replays, 0 = ping runs
+    uint32_t cost_us = 0;       // Core time per inbound datagram
+};
+
+std::atomic<uint32_t> g_link_kbps{0};
+uint32_t g_cost_us = 0;         // Network task only
+int64_t g_link_free_us = 0;     // Send task only
+
+int64_t monotonicUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+// The platform UdpTransport expects, on threads for the host
+
+extern "C" int64_t esp_timer_get_time(void) {
+    return monotonicUs();
+}
+
+extern "C" const char* esp_err_to_name(esp_err_t code) {
+    return code == ESP_OK ? "ESP_OK" : "ESP_FAIL";
+}
+
+extern "C" uint32_t esp_get_free_heap_size(void) {
+    return 0;
+}
+
+struct HostTask {
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    uint32_t notifications = 0;
+};
+
+struct HostQueue {
+    std::mutex mutex;
+    std::deque<std::vector<uint8_t>> items;
+    size_t length;
+    size_t item_size;
+};
+
+static thread_local HostTask* t_task = nullptr;
+
+// Tasks run until the process exits; every call the transport makes is
+// non-blocking (ticks 0) or waits on a notification
+extern "C" BaseType_t xTaskCreatePinnedToCore(TaskFunction_t entry, const char*, uint32_t,
+                                              void* arg, UBaseType_t, TaskHandle_t* handle,
+                                              BaseType_t) {
+    HostTask* task = new HostTask();
+    *handle = task;
+    task->thread = std::thread([task, entry, arg]() {
+        t_task = task;
+        entry(arg);
+    });
+    task->thread.detach();
+    return pdPASS;
+}
+
+extern "C" void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+extern "C" BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->notifications++;
+    }
+    task->wake.notify_one();
+    return pdPASS;
+}
+
+extern "C" uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    HostTask* task = t_task;
+    std::unique_lock<std::mutex> lock(task->mutex);
+    auto ready = [task]() { return task->notifications > 0; };
+    if (ticks == portMAX_DELAY) {
+        task->wake.wait(lock, ready);
+    } else {
+        task->wake.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+    }
+    uint32_t count = task->notifications;
+    task->notifications = clear ? 0 : (count > 0 ? count - 1 : 0);
+    return count;
+}
+
+extern "C" QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    HostQueue* queue = new HostQueue();
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+extern "C" BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (queue->items.size() >= queue->length) {
+        return pdFALSE;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    queue->items.emplace_back(bytes, bytes + queue->item_size);
+    return pdTRUE;
+}
+
+extern "C" BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (queue->items.empty()) {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->item_size);
+    queue->items.pop_front();
+    return pdTRUE;
+}
+
+extern "C" UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return (UBaseType_t)queue->items.size();
+}
+
+// The link: each datagram holds the send task for its time on the air
+extern "C" ssize_t lwip_sendto(int s, const void* data, size_t size, int flags,
+                               const struct sockaddr* to, socklen_t tolen) {
+    uint32_t kbps = g_link_kbps.load();
+    if (kbps > 0) {
+        int64_t now = monotonicUs();
+        g_link_free_us = std::max(now, g_link_free_us) + (int64_t)size * 8000 / kbps;
+        std::this_thread::sleep_for(std::chrono::microseconds(g_link_free_us - now));
+    }
+    return (sendto)(s, data, size, flags, to, tolen);
+}
+
+// Pass-through stand-in for the AVI core
+
+struct AVI_AviEmbedded {
+    uint8_t* buffer;
+    size_t buffer_len;
+    void* udp;
+    AVI_CUdpSendCallback send;
+    AVI_CUdpReceiveCallback receive;
+    void* msg_user_data;
+    AVI_CMessageCallback on_message;
+};
+
+extern "C" AVI_AviEmbedded* avi_embedded_new(AVI_AviEmbeddedConfig, uint8_t* buffer, uintptr_t buffer_len,
+                                             void* udp_user_data, AVI_CUdpSendCallback udp_send_fn,
+                                             AVI_CUdpReceiveCallback udp_recv_fn, void* msg_user_data,
+                                             AVI_CMessageCallback msg_callback) {
+    return new AVI_AviEmbedded{buffer, buffer_len, udp_user_data, udp_send_fn, udp_recv_fn,
+                               msg_user_data, msg_callback};
+}
+
+extern "C" void avi_embedded_free(AVI_AviEmbedded* avi) {
+    delete avi;
+}
+
+extern "C" int32_t avi_embedded_connect(AVI_AviEmbedded*) {
+    return 0;
+}
+
+extern "C" bool avi_embedded_is_connected(const AVI_AviEmbedded*) {
+    return true;
+}
+
+extern "C" int32_t avi_embedded_poll(AVI_AviEmbedded* avi) {
+    int32_t len = avi->receive(avi->udp, avi->buffer, avi->buffer_len);
+    if (len > 0 && avi->on_message) {
+        avi->on_message(avi->msg_user_data, "echo", 4, avi->buffer, (uintptr_t)len);
+    }
+    return 0;
+}
+
+extern "C" int32_t avi_embedded_publish(AVI_AviEmbedded* avi, const char*, uintptr_t,
+                                        const uint8_t* data, uintptr_t data_len) {
+    return avi->send(avi->udp, data, data_len) < 0 ? -1 : 0;
+}
+
+namespace {
+
+constexpr uint8_t PING = 'C';
+constexpr uint8_t BULK = 'B';
+
+struct Ping {
+    uint8_t kind;
+    uint32_t seq;
+    int64_t sent_us;
+} __attribute__((packed));
+
+struct Result {
+    uint32_t pings;
+    uint32_t ping_drops;            // Refused by the transport
+    std::vector<int64_t> rtt_us;
+    uint32_t bulk_sent;
+    uint32_t bulk_drops;
+    uint64_t bulk_echoed_bytes;
+    int64_t elapsed_us;             // From the first send to the last echo waited for
+    AVI::TrafficClassMetrics control;
+    AVI::UdpTransport::TxStats contended;   // UdpTransport only
+};
+
+// Stands in for the work the core and the features do per message
+void spend(uint32_t us) {
+    int64_t until = monotonicUs() + us;
+    while (monotonicUs() < until) {
+    }
+}
+
+void onEcho(void* user_data, const char*, uintptr_t, const uint8_t* data, uintptr_t len) {
+    spend(g_cost_us);
+    Result& result = *static_cast<Result*>(user_data);
+    if (data[0] == PING && len >= sizeof(Ping)) {
+        Ping echoed;
+        memcpy(&echoed, data, sizeof(echoed));
+        result.rtt_us.push_back(monotonicUs() - echoed.sent_us);
+    } else if (data[0] == BULK) {
+        result.bulk_echoed_bytes += len;
+    }
+}
+
+// A fresh transport per run, so its counters cover only this one. A
+// UdpTransport's tasks idle on its closed socket until the process exits,
+// so neither is ever freed.
+AVI::Transport* openTransport(const Options& options, AVI::UdpTransport** udp) {
+    AVI::Transport* transport;
+    *udp = nullptr;
+    if (options.posix) {
+        transport = new AVI::PosixUdpTransport(options.server, options.port);
+    } else {
+        *udp = new AVI::UdpTransport(options.server, options.port);
+        transport = *udp;
+    }
+    if (!transport->connect()) {
+        fprintf(stderr, "Cannot open a UDP socket to %s:%u\n", options.server, options.port);
+        exit(1);
+    }
+    return transport;
+}
+
+AviClient* startClient(AVI::Transport& transport, AVI_CMessageCallback callback, void* user_data) {
+    AviClient* client = new AviClient(transport);
+    client->onMessage(callback, user_data);
+    if (!client->init() || !client->connect()) {
+        fprintf(stderr, "AVI client failed to start\n");
+        exit(1);
+    }
+    return client;
+}
+
+Result run(const Options& options, bool streaming) {
+    AVI::UdpTransport* udp;
+    AVI::Transport* transport = openTransport(options, &udp);
+    Result result = {};
+    AviClient* client = startClient(*transport, &onEcho, &result);
+    AVI_AviEmbedded* avi = client->getHandle();
+
+    std::vector<uint8_t> ping(std::max<size_t>(options.ping_size, sizeof(Ping)), 0);
+    std::vector<uint8_t> bulk(options.bulk_size, 0);
+    bulk[0] = BULK;
+
+    int64_t start = monotonicUs();
+    int64_t end = start + (int64_t)options.seconds * 1000000;
+    int64_t next_ping = start;
+    uint64_t bulk_offered = 0;
+
+    while (true) {
+        int64_t now = monotonicUs();
+        if (now >= end) {
+            break;
+        }
+
+        if (streaming) {
+            AVI::TrafficClassScope scope(*transport, AVI::TrafficClass::BULK);
+            uint64_t due = (uint64_t)(now - start) * options.bulk_kbps / 8000;
+            while (bulk_offered + bulk.size() <= due) {
+                bulk_offered += bulk.size();
+                if (avi_embedded_publish(avi, "bulk", 4, bulk.data(), bulk.size()) < 0) {
+                    result.bulk_drops++;
+                } else {
+                    result.bulk_sent++;
+                }
+            }
+        }
+
+        if (now >= next_ping) {
+            next_ping += (int64_t)options.ping_ms * 1000;
+            Ping header = {PING, result.pings++, monotonicUs()};
+            memcpy(ping.data(), &header, sizeof(header));
+            if (avi_embedded_publish(avi, "ping", 4, ping.data(), ping.size()) < 0) {
+                result.ping_drops++;
+            }
+        }
+
+        client->poll();
+        transport->waitForActivity(1);
+    }
+
+    // Late echoes still count
+    int64_t grace_end = monotonicUs() + 1000000;
+    while (monotonicUs() < grace_end && result.rtt_us.size() + result.ping_drops < result.pings) {
+        transport->waitForActivity(10);
+        client->poll();
+    }
+    result.elapsed_us = monotonicUs() - start;
+
+    result.control = transport->getClassMetrics(AVI::TrafficClass::CONTROL);
+    if (udp) {
+        result.contended = udp->getTxStats(AVI::TrafficClass::CONTROL);
+    }
+    transport->disconnect();
+    return result;
+}
+
+void report(const char* name, Result& result) {
+    std::sort(result.rtt_us.begin(), result.rtt_us.end());
+    auto pct = [&](double p) {
+        return result.rtt_us.empty() ? 0.0 : result.rtt_us[(size_t)(p * (result.rtt_us.size() - 1))] / 1000.0;
+    };
+    const AVI::TrafficClassMetrics& control = result.control;
+    printf("%-10s %6u %6u %6zu %8.2f %8.2f %8.2f %8lu %8lu %6u %6u %9.0f\n",
+           name, result.pings, result.ping_drops,
+           (size_t)(result.pings - result.rtt_us.size()),
+           pct(0.5), pct(0.99), pct(1.0),
+           (unsigned long)(control.sent ? control.latency_total_us / control.sent : 0),
+           (unsigned long)control.latency_max_us,
+           result.bulk_sent, result.bulk_drops,
+           result.elapsed_us > 0 ? result.bulk_echoed_bytes * 8000.0 / result.elapsed_us : 0.0);
+}
+
+void onBurst(void* user_data, const char*, uintptr_t, const uint8_t*, uintptr_t) {
+    spend(g_cost_us);
+    int64_t* last_us = static_cast<int64_t*>(user_data);
+    *last_us = monotonicUs();
+}
+
+int runBurst(const Options& options) {
+    AVI::UdpTransport* udp;
+    AVI::Transport* transport = openTransport(options, &udp);
+    int64_t last_us = 0;
+    AviClient* client = startClient(*transport, &onBurst, &last_us);
+
+    // Any datagram tells the stub where to send the burst
+    uint8_t hello = 0;
+    int64_t start = monotonicUs();
+    avi_embedded_publish(client->getHandle(), "hello", 5, &hello, sizeof(hello));
+
+    // Until the burst is in or the link has been quiet for a second
+    uint32_t received = 0;
+    while (received < options.burst && monotonicUs() - std::max(start, last_us) < 1000000) {
+        transport->waitForActivity(10);
+        received += client->poll();
+    }
+
+    const AviClient::PollStats& stats = client->getPollStats();
+    AVI::TransportMetrics metrics = transport->getMetrics();
+    printf("%s, %u us per datagram in the core, at most %u per poll or %u us\n",
+           options.posix ? "PosixUdpTransport" : "UdpTransport", options.cost_us,
+           (unsigned)AVI_POLL_MAX_PACKETS, (unsigned)AVI_POLL_BUDGET_US);
+    printf("received %u of %u (%u dropped by the transport), drained in %.1f ms\n",
+           received, options.burst, metrics.rx_dropped,
+           last_us > start ? (last_us - start) / 1000.0 : 0.0);
+    printf("polls %u, drained max %u, backlog at entry max %u, budget hit %u\n",
+           stats.iterations, stats.drained_max, stats.backlog_max, stats.budget_exhausted);
+
+    fflush(stdout);
+    _exit(received == options.burst ? 0 : 1);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        auto value = [&]() { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* arg = argv[i];
+        const char* v = nullptr;
+        if (!strcmp(arg, "--server") && (v = value())) {
+            options.server = v;
+        } else if (!strcmp(arg, "--port") && (v = value())) {
+            options.port = (uint16_t)atoi(v);
+        } else if (!strcmp(arg, "--link-kbps") && (v = value())) {
+            options.link_kbps = (uint32_t)atoi(v);
+        } else if (!strcmp(arg, "--bulk-kbps") && (v = value())) {
+            options.bulk_kbps = (uint32_t)atoi(v);
+        } else if (!strcmp(arg, "--bulk-size") && (v = value())) {
+            options.bulk_size = (uint32_t)atoi(v);
+        } else if (!strcmp(arg, "--ping-ms") && (v = value())) {
+            options.ping_ms = (uint32_t)atoi(v);
+        } else if (!strcmp(arg, "--seconds") && (v = value())) {
+            options.seconds = (uint32_t)atoi(v);
+        } else if (!strcmp(arg, "--posix")) {
+            options.posix = true;
+        } else if (!strcmp(arg, "--burst") && (v = value())) {
+            options.burst = (uint32_t)atoi(v);
+        } else if (!strcmp(arg, "--cost-us") && (v = value())) {
+            options.cost_us = (uint32_t)atoi(v);
+        } else {
+            fprintf(stderr, "usage: %s [--server IP] [--port N] [--posix] [--link-kbps N] [--bulk-kbps N]\n"
+                    "          [--bulk-size N] [--ping-ms N] [--seconds N] [--burst N] [--cost-us N]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (options.bulk_size == 0 || options.bulk_size > AVI::UdpTransport::TX_SLOT_SIZE ||
+        options.ping_ms == 0) {
+        fprintf(stderr, "Bulk datagrams must be 1..%zu bytes, pings at least 1 ms apart\n",
+                AVI::UdpTransport::TX_SLOT_SIZE);
+        return 1;
+    }
+    g_link_kbps = options.link_kbps;
+    g_cost_us = options.cost_us;
+    if (options.burst > 0) {
+        return runBurst(options);
+    }
+
+    if (options.posix) {
+        printf("PosixUdpTransport, ");
+    } else {
+        printf("UdpTransport on a %u kbit/s link, ", options.link_kbps);
+    }
+    printf("a %u byte ping every %u ms, %u kbit/s of %u byte bulk datagrams\n",
+           options.ping_size, options.ping_ms, options.bulk_kbps, options.bulk_size);
+    printf("%-10s %6s %6s %6s %8s %8s %8s %8s %8s %6s %6s %9s\n",
+           "run", "pings", "drop", "lost", "p50 ms", "p99 ms", "max ms", "q2w us", "q2w max",
+           "bulk", "b.drop", "echo kb/s");
+
+    Result idle = run(options, false);
+    report("idle", idle);
+    Result streaming = run(options, true);
+    report("streaming", streaming);
+
+    const AVI::UdpTransport::TxStats& contended = streaming.contended;
+    if (contended.contended > 0) {
+        printf("pings queued behind bulk: %u, queue-to-wire avg %lu us max %lu us\n",
+               contended.contended,
+               (unsigned long)(contended.contended_latency_total_us / contended.contended),
+               (unsigned long)contended.contended_latency_max_us);
+    }
+
+    // The transport's tasks never return
+    fflush(stdout);
+    _exit(streaming.ping_drops == 0 ? 0 : 1);
+}